@@ -0,0 +1,420 @@
+// benchmarks for the lexer, parser, printer, accessors and destructor over a generated corpus
+//
+// `make bench` builds this with optimizations and runs it, `make bench ARGS=parse` only runs
+// the benchmarks whose name contains "parse". progress goes to stderr, results go to stdout as
+// json, so `make -s bench > results.json` gives a file that can be compared between versions.
+//
+// the corpus is generated from a fixed seed, so every run measures the same input
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <time.h>
+
+#define JEST_IMPL 1
+#include "../jest.h"
+
+// rough size of every generated file
+#ifndef BENCH_CORPUS_SIZE
+#   define BENCH_CORPUS_SIZE (4u << 20)
+#endif // !BENCH_CORPUS_SIZE
+
+// every benchmark repeats until it spent at least this many seconds of cpu time
+#ifndef BENCH_MIN_TIME
+#   define BENCH_MIN_TIME 0.5
+#endif // !BENCH_MIN_TIME
+
+// nesting of every element in the deep corpus, well below JEST_MAX_DEPTH
+#define BENCH_DEPTH 256
+
+#ifdef _WIN32
+#   define BENCH_NULL_DEVICE "NUL"
+#else
+#   define BENCH_NULL_DEVICE "/dev/null"
+#endif
+
+struct Buf {
+    char *data;
+    size_t len, cap;
+};
+
+struct Corpus {
+    const char *name;
+    struct Buf text;
+    size_t nelems; // elements of the top-level array
+    char accessor[BENCH_DEPTH * 8 + 64]; // a path into the middle of the corpus for Jest_jsonIdx
+
+    FILE *file; // text written to a temporary file for Jest_parseJsonFile
+    Jest_JsonVal val; // parsed once up front for the printing and indexing benchmarks
+};
+
+struct Bench {
+    const char *name;
+    // runs n iterations over the corpus, returns the cpu seconds spent in the measured part
+    double (*run)(struct Corpus *corpus, size_t n);
+    bool per_byte; // throughput is measured against the corpus size
+};
+
+static uint64_t rng_state = UINT64_C(0x9e3779b97f4a7c15);
+static FILE *null_device;
+
+static double now(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static uint32_t rng(uint32_t bound)
+{
+    // xorshift64*, plenty for picking shapes of fake data
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * UINT64_C(0x2545f4914f6cdd1d)) >> 32) % bound;
+}
+
+static void buf_put(struct Buf *buf, const char *str, size_t len)
+{
+    if (buf->len + len + 1 > buf->cap) {
+        size_t cap = (buf->cap)? buf->cap : 4096;
+        while (buf->len + len + 1 > cap) cap *= 2;
+
+        char *data = (char *)realloc(buf->data, cap);
+        if (!data) {
+            fprintf(stderr, "out of memory generating the corpus\n");
+            exit(1);
+        }
+
+        buf->data = data;
+        buf->cap = cap;
+    }
+
+    memcpy(&buf->data[buf->len], str, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+static void buf_puts(struct Buf *buf, const char *str)
+{
+    buf_put(buf, str, strlen(str));
+}
+
+static void buf_printf(struct Buf *buf, const char *fmt, ...)
+{
+    char tmp[256];
+    va_list args;
+    va_start(args, fmt);
+    const int len = vsnprintf(tmp, sizeof(tmp), fmt, args);
+    va_end(args);
+
+    if (len > 0) buf_put(buf, tmp, ((size_t)len < sizeof(tmp))? (size_t)len : sizeof(tmp) - 1);
+}
+
+static void gen_numbers(struct Corpus *c)
+{
+    // integers, decimals and exponents of every sign, 16 to a line
+    buf_puts(&c->text, "[");
+    while (c->text.len < BENCH_CORPUS_SIZE) {
+        if (c->nelems) buf_puts(&c->text, (c->nelems % 16)? ", " : ",\n");
+
+        switch (rng(4)) {
+            case 0: buf_printf(&c->text, "%u", rng(1000000)); break;
+            case 1: buf_printf(&c->text, "-%u.%u", rng(1000), rng(100000)); break;
+            case 2: buf_printf(&c->text, "%u.%ue%d", rng(10), rng(1000000), (int)rng(600) - 300); break;
+            default: buf_printf(&c->text, "%.17g", (double)rng(UINT32_MAX) / (double)(rng(1000) + 1)); break;
+        }
+
+        ++c->nelems;
+    }
+
+    buf_puts(&c->text, "]");
+    snprintf(c->accessor, sizeof(c->accessor), "[%zu]", c->nelems / 2);
+}
+
+static void gen_deep(struct Corpus *c)
+{
+    // objects and arrays alternating all the way down
+    buf_puts(&c->text, "[");
+    while (c->text.len < BENCH_CORPUS_SIZE) {
+        if (c->nelems++) buf_puts(&c->text, ",\n");
+
+        for (size_t i = 0; i < BENCH_DEPTH / 2; ++i) buf_puts(&c->text, "{\"d\": [");
+        buf_printf(&c->text, "%u", rng(1000));
+        for (size_t i = 0; i < BENCH_DEPTH / 2; ++i) buf_puts(&c->text, "]}");
+    }
+
+    buf_puts(&c->text, "]");
+
+    size_t len = (size_t)snprintf(c->accessor, sizeof(c->accessor), "[%zu]", c->nelems / 2);
+    for (size_t i = 0; i < BENCH_DEPTH / 2; ++i) {
+        len += (size_t)snprintf(&c->accessor[len], sizeof(c->accessor) - len, "[d][0]");
+    }
+}
+
+static void gen_wide(struct Corpus *c)
+{
+    // objects with a thousand fields, big enough for the hash index
+    buf_puts(&c->text, "[");
+    while (c->text.len < BENCH_CORPUS_SIZE) {
+        if (c->nelems++) buf_puts(&c->text, ",\n");
+
+        buf_puts(&c->text, "{");
+        for (unsigned i = 0; i < 1000; ++i) {
+            buf_printf(&c->text, (i)? ", \"field_%04u\": " : "\"field_%04u\": ", i);
+            switch (rng(3)) {
+                case 0: buf_printf(&c->text, "%u", rng(100000)); break;
+                case 1: buf_puts(&c->text, (rng(2))? "true" : "null"); break;
+                default: buf_printf(&c->text, "\"value %u\"", rng(100000)); break;
+            }
+        }
+
+        buf_puts(&c->text, "}");
+    }
+
+    buf_puts(&c->text, "]");
+    snprintf(c->accessor, sizeof(c->accessor), "[%zu]['field_0999']", c->nelems / 2);
+}
+
+static void gen_strings(struct Corpus *c)
+{
+    // mostly plain ascii text with the occasional escape
+    static const char *const words[] = {
+        "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit",
+        "sed", "do", "eiusmod", "tempor", "\\\"quoted\\\"", "tab\\there", "line\\nbreak", "back\\\\slash"
+    };
+
+    buf_puts(&c->text, "[");
+    while (c->text.len < BENCH_CORPUS_SIZE) {
+        if (c->nelems++) buf_puts(&c->text, ",\n");
+
+        buf_puts(&c->text, "\"");
+        const uint32_t nwords = rng(40) + 1;
+        for (uint32_t i = 0; i < nwords; ++i) {
+            if (i) buf_puts(&c->text, " ");
+            buf_puts(&c->text, words[(rng(4))? rng(12) : rng(16)]);
+        }
+
+        buf_puts(&c->text, "\"");
+    }
+
+    buf_puts(&c->text, "]");
+    snprintf(c->accessor, sizeof(c->accessor), "[%zu]", c->nelems / 2);
+}
+
+static void gen_unicode(struct Corpus *c)
+{
+    // raw utf-8 of every length mixed with \u escapes, surrogate pairs included
+    static const char *const pieces[] = {
+        "caf\xc3\xa9", "\xce\xb1\xce\xb2\xce\xb3", "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", "\xf0\x9f\x8c\xbf",
+        "\\u00e9", "\\u65e5\\u672c", "\\ud83c\\udf3f", "ascii"
+    };
+
+    buf_puts(&c->text, "[");
+    while (c->text.len < BENCH_CORPUS_SIZE) {
+        if (c->nelems++) buf_puts(&c->text, ",\n");
+
+        buf_puts(&c->text, "\"");
+        const uint32_t npieces = rng(30) + 1;
+        for (uint32_t i = 0; i < npieces; ++i) {
+            if (i) buf_puts(&c->text, " ");
+            buf_puts(&c->text, pieces[rng(8)]);
+        }
+
+        buf_puts(&c->text, "\"");
+    }
+
+    buf_puts(&c->text, "]");
+    snprintf(c->accessor, sizeof(c->accessor), "[%zu]", c->nelems / 2);
+}
+
+static double bench_lex(struct Corpus *c, size_t n)
+{
+    const double start = now();
+    for (size_t i = 0; i < n; ++i) {
+        Jest_Lexer l;
+        if (Jest_initLexer(&l, NULL, 0, c->text.data, c->text.len)) {
+            while (Jest_lexerStep(&l));
+        }
+
+        Jest_destroyLexer(&l);
+    }
+
+    return now() - start;
+}
+
+static double bench_parse_file(struct Corpus *c, size_t n)
+{
+    // the destruction of every result isn't part of the measurement
+    double spent = 0;
+    for (size_t i = 0; i < n; ++i) {
+        rewind(c->file);
+
+        Jest_JsonVal val;
+        const double start = now();
+        const Jest_Error err = Jest_parseJsonFile(&val, c->file);
+        spent += now() - start;
+
+        if (!err) Jest_destroyJsonVal(&val);
+    }
+
+    return spent;
+}
+
+static double bench_destroy(struct Corpus *c, size_t n)
+{
+    double spent = 0;
+    for (size_t i = 0; i < n; ++i) {
+        rewind(c->file);
+
+        Jest_JsonVal val;
+        if (Jest_parseJsonFile(&val, c->file)) continue;
+
+        const double start = now();
+        Jest_destroyJsonVal(&val);
+        spent += now() - start;
+    }
+
+    return spent;
+}
+
+static double bench_print(struct Corpus *c, size_t n)
+{
+    const double start = now();
+    for (size_t i = 0; i < n; ++i) {
+        Jest_printJsonVal(null_device, &c->val, false);
+    }
+
+    fflush(null_device);
+    return now() - start;
+}
+
+static double bench_idx(struct Corpus *c, size_t n)
+{
+    const double start = now();
+    for (size_t i = 0; i < n; ++i) {
+        if (!Jest_jsonIdx(&c->val, c->accessor, NULL)) {
+            fprintf(stderr, "%s doesn't resolve in the %s corpus\n", c->accessor, c->name);
+            exit(1);
+        }
+    }
+
+    return now() - start;
+}
+
+static bool run_bench(Jest_JsonVal *results, const struct Bench *b, struct Corpus *c, const char *filter)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s/%s", b->name, c->name);
+    if (filter && !strstr(name, filter)) return true;
+
+    // grow the iteration count until a run takes long enough to be trusted, like google benchmark does
+    size_t n = 1;
+    double spent;
+    for (;;) {
+        spent = b->run(c, n);
+        if (spent >= BENCH_MIN_TIME || n >= ((size_t)1 << 30)) break;
+
+        const double want = (spent > 0)? BENCH_MIN_TIME * 1.4 / spent * (double)n : (double)n * 10;
+        const size_t next = (want > (double)n * 10)? n * 10 : (size_t)want;
+        n = (next > n)? next : n + 1;
+    }
+
+    const double ns_per_op = spent * 1e9 / (double)n;
+    const double mb_per_s = (b->per_byte)? (double)c->text.len * (double)n / spent / 1e6 : 0;
+
+    fprintf(stderr, "%-24s %12zu iterations %16.1f ns/op", name, n, ns_per_op);
+    if (b->per_byte) fprintf(stderr, " %10.2f MB/s", mb_per_s);
+    fprintf(stderr, "\n");
+
+    Jest_JsonVal row = Jest_jsonObj();
+    Jest_Error err = Jest_jsonObjAdd(&row, "name", Jest_jsonString(name));
+    if (!err) err = Jest_jsonObjAdd(&row, "iterations", Jest_jsonNumber((double)n));
+    if (!err) err = Jest_jsonObjAdd(&row, "bytes", Jest_jsonNumber((b->per_byte)? (double)c->text.len : 0));
+    if (!err) err = Jest_jsonObjAdd(&row, "ns_per_op", Jest_jsonNumber(ns_per_op));
+    if (!err) err = Jest_jsonObjAdd(&row, "mb_per_s", (b->per_byte)? Jest_jsonNumber(mb_per_s) : Jest_jsonNull());
+    if (!err) err = Jest_jsonArrayAppend(results, &row);
+
+    if (err) Jest_destroyJsonVal(&row);
+    return !err;
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = (argc > 1)? argv[1] : NULL;
+
+    struct Corpus corpora[] = {
+        {.name = "numbers"}, {.name = "deep"}, {.name = "wide"}, {.name = "strings"}, {.name = "unicode"}
+    };
+    void (*const generators[])(struct Corpus *c) = {
+        gen_numbers, gen_deep, gen_wide, gen_strings, gen_unicode
+    };
+
+    static const struct Bench benches[] = {
+        {"lex", bench_lex, true},
+        {"parse_file", bench_parse_file, true},
+        {"print", bench_print, true},
+        {"idx", bench_idx, false},
+        {"destroy", bench_destroy, true}
+    };
+
+    const size_t ncorpora = sizeof(corpora) / sizeof(*corpora);
+    const size_t nbenches = sizeof(benches) / sizeof(*benches);
+
+    null_device = fopen(BENCH_NULL_DEVICE, "w");
+    if (!null_device) {
+        fprintf(stderr, "can't open %s\n", BENCH_NULL_DEVICE);
+        return 1;
+    }
+
+    Jest_JsonVal report = Jest_jsonObj();
+    Jest_JsonVal corpus_sizes = Jest_jsonObj();
+    Jest_JsonVal results = Jest_jsonArray();
+    int ret = 0;
+
+    for (size_t i = 0; i < ncorpora && !ret; ++i) {
+        struct Corpus *c = &corpora[i];
+        generators[i](c);
+
+        c->file = tmpfile();
+        if (!c->file || fwrite(c->text.data, 1, c->text.len, c->file) != c->text.len || fflush(c->file)) {
+            fprintf(stderr, "can't write the %s corpus to a temporary file\n", c->name);
+            ret = 1;
+            break;
+        }
+
+        const Jest_Error err = Jest_parseJsonFromBuf(&c->val, c->text.data, c->text.len);
+        if (err) {
+            fprintf(stderr, "the %s corpus doesn't parse: %d\n", c->name, (int)err);
+            ret = 1;
+            break;
+        }
+
+        fprintf(stderr, "%s: %zu bytes, %zu elements\n", c->name, c->text.len, c->nelems);
+        if (Jest_jsonObjAdd(&corpus_sizes, c->name, Jest_jsonNumber((double)c->text.len))) ret = 1;
+    }
+
+    for (size_t b = 0; b < nbenches && !ret; ++b) {
+        for (size_t i = 0; i < ncorpora && !ret; ++i) {
+            if (!run_bench(&results, &benches[b], &corpora[i], filter)) ret = 1;
+        }
+    }
+
+    // the report owns the other two from here on
+    Jest_jsonObjAdd(&report, "min_time", Jest_jsonNumber(BENCH_MIN_TIME));
+    Jest_jsonObjAdd(&report, "corpus_bytes", corpus_sizes);
+    Jest_jsonObjAdd(&report, "benchmarks", results);
+
+    if (!ret) {
+        Jest_printJsonVal(stdout, &report, false);
+        printf("\n");
+    }
+
+    Jest_destroyJsonVal(&report);
+    for (size_t i = 0; i < ncorpora; ++i) {
+        if (corpora[i].file) fclose(corpora[i].file);
+        Jest_destroyJsonVal(&corpora[i].val);
+        free(corpora[i].text.data);
+    }
+
+    fclose(null_device);
+    return ret;
+}
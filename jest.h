@@ -1,1073 +1,5674 @@
-/*
-This is free and unencumbered software released into the public domain.
-
-Anyone is free to copy, modify, publish, use, compile, sell, or
-distribute this software, either in source code form or as a compiled
-binary, for any purpose, commercial or non-commercial, and by any
-means.
-
-In jurisdictions that recognize copyright laws, the author or authors
-of this software dedicate any and all copyright interest in the
-software to the public domain. We make this dedication for the benefit
-of the public at large and to the detriment of our heirs and
-successors. We intend this dedication to be an overt act of
-relinquishment in perpetuity of all present and future rights to this
-software under copyright law.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
-MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
-IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
-OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
-ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
-OTHER DEALINGS IN THE SOFTWARE.
-*/
-
-#include <ctype.h>
-#include <inttypes.h>
-#include <malloc.h>
-#include <stdbool.h>
-#include <stddef.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-#define JEST_TODO(str) do {fprintf(stderr, "[%s:%d: %s] TODO: %s\n", __FILE__, __LINE__, __func__, str); exit(-1);} while (0)
-
-#ifndef JEST_H_
-#define JEST_H_ 1
-
-#ifndef JEST_NAN
-#   ifdef NAN
-#       define JEST_NAN NAN
-#   elif defined(__GNUC__)
-#       define JEST_NAN __builtin_nanf("")
-#   else
-#       define JEST_NAN (0.0/0.0)
-#   endif
-#endif // !JEST_NAN
-
-#ifndef JEST_INF
-#   ifdef INF
-#       define JEST_INF INF
-#   elif defined(__GNUC__)
-#       define JEST_INF __builtin_inff()
-#   else
-#       define JEST_INF (1.0/0.0)
-#   endif
-#endif // !JEST_INF
-
-typedef int Jest_LexemeType;
-enum Jest__LexemeType {
-    JEST_LEXEME_ERR = 256,
-    JEST_LEXEME_IDENT,
-    JEST_LEXEME_NULL,
-    JEST_LEXEME_BOOL,
-    JEST_LEXEME_NUM,
-    JEST_LEXEME_STR,
-    JEST_LEXEME_EOF
-};
-
-typedef struct Jest_Lexer {
-    bool boolval;
-    Jest_LexemeType type;
-
-    char *strbuf;
-    size_t strbuf_sz;
-    size_t strval_len;
-
-    size_t filebuf_offset;
-    size_t filebuf_sz;
-    const char *filebuf;
-
-    size_t ident_start;
-    size_t ident_len;
-    double numval;
-} Jest_Lexer;
-
-typedef enum Jest_JsonType {
-    JEST_JSONTYPE_NULL,
-    JEST_JSONTYPE_BOOL,
-    JEST_JSONTYPE_NUM,
-    JEST_JSONTYPE_STR,
-    JEST_JSONTYPE_ARR,
-    JEST_JSONTYPE_OBJ,
-    JEST_JSONTYPE_ERR
-} Jest_JsonType;
-
-typedef enum Jest_Error {
-    JEST_ERROR_NONE, // no error, everything is fine :)
-    JEST_ERROR_NOMEM, // malloc/calloc/realloc failed
-    JEST_ERROR_BADPARAM, // invalid parameter
-    JEST_ERROR_SYNTAX, // syntax error
-    JEST_ERROR_BADLEXER, // lexer creation failed at some point
-    JEST_ERROR_BADCHAR, // malformed unicode/hex char
-    JEST_ERROR_IO // i/o error
-} Jest_Error;
-
-typedef struct Jest_JsonVal {
-    Jest_JsonType type;
-
-    union {
-        bool as_bool;
-        double as_num;
-        struct { size_t len; char *data; } as_str;
-        struct { size_t len, cap; struct Jest_JsonVal *elems; } as_arr;
-
-        struct {
-            size_t nfields, nalloced;
-            size_t *fn_lens; // field name lengths
-            char **field_names; // field names
-            struct Jest_JsonVal *field_values; // field values
-        } as_obj;
-
-        Jest_Error as_err;
-    } v;
-} Jest_JsonVal;
-
-bool Jest_signbit(double x);
-bool Jest_isnan(double x);
-bool Jest_isinf(double x);
-
-char *Jest_strndup(const char *str, size_t len);
-char *Jest_dblToStr(char *buffer, size_t bufsz, double x);
-char *Jest_boolToStr(char *buffer, size_t bufsz, bool b);
-size_t Jest_readEntireFileFromPath(char **out, const char *path);
-size_t Jest_readEntireFile(char **out, FILE *file);
-bool Jest_initLexer(Jest_Lexer *l, char *strbuf, size_t strbuf_sz, const char *filebuf, size_t filebuf_sz);
-bool Jest_lexerStep(Jest_Lexer *l);
-
-Jest_Error Jest_jsonArrayAppend(Jest_JsonVal *arr, const Jest_JsonVal *elem);
-Jest_Error Jest_jsonObjAdd(Jest_JsonVal *obj, const char *field_name, Jest_JsonVal value);
-Jest_Error Jest_parseJsonLexer(Jest_JsonVal *out, Jest_Lexer *lexer);
-Jest_Error Jest_parseJsonFile(Jest_JsonVal *out, FILE *file);
-Jest_Error Jest_parseJsonFileFromPath(Jest_JsonVal *out, const char *path);
-Jest_Error Jest_parseJsonFromStr(Jest_JsonVal *out, const char *str);
-
-void Jest_printJsonVal(FILE *file, const Jest_JsonVal *val, bool escape_unicode);
-void Jest_destroyJsonVal(Jest_JsonVal *val);
-
-Jest_JsonVal *Jest_jsonIdx(Jest_JsonVal *parent, const char *accessor, Jest_Error *opt_err_out);
-
-static inline Jest_JsonVal Jest_jsonNull(void)
-{
-    Jest_JsonVal out;
-    out.type = JEST_JSONTYPE_NULL;
-    return out;
-}
-
-static inline Jest_JsonVal Jest_jsonBool(bool val)
-{
-    Jest_JsonVal out;
-    out.type = JEST_JSONTYPE_BOOL;
-    out.v.as_bool = val;
-    return out;
-}
-
-static inline Jest_JsonVal Jest_jsonNumber(double val)
-{
-    Jest_JsonVal out;
-    out.type = JEST_JSONTYPE_NUM;
-    out.v.as_num = val;
-    return out;
-}
-
-static inline Jest_JsonVal Jest_jsonString(const char *val)
-{
-    Jest_JsonVal out;
-    out.type = JEST_JSONTYPE_STR;
-    out.v.as_str.len = strlen(val);
-    out.v.as_str.data = Jest_strndup(val, out.v.as_str.len);
-    return out;
-}
-
-static inline Jest_JsonVal Jest_jsonArray(void)
-{
-    Jest_JsonVal out;
-    out.type = JEST_JSONTYPE_ARR;
-    memset(&out.v, 0, sizeof(out.v));
-    return out;
-}
-
-static inline Jest_JsonVal Jest_jsonObj(void)
-{
-    Jest_JsonVal out;
-    out.type = JEST_JSONTYPE_OBJ;
-    memset(&out.v, 0, sizeof(out.v));
-    return out;
-}
-
-#endif // !JEST_H_
-
-#ifdef JEST_IMPL
-
-// helper functions for lexers
-static void Jest__lexerSkipCommentAndWhiteSpace(Jest_Lexer *l);
-static Jest_Error Jest__lexerHandleStr(Jest_Lexer *l);
-
-// helper functions for parsing individual pieces of data
-static Jest_Error Jest__parseNull(Jest_JsonVal *out, Jest_Lexer *lexer);
-static Jest_Error Jest__parseBool(Jest_JsonVal *out, Jest_Lexer *lexer);
-static Jest_Error Jest__parseNum(Jest_JsonVal *out, Jest_Lexer *lexer);
-static Jest_Error Jest__parseStr(Jest_JsonVal *out, Jest_Lexer *lexer);
-static Jest_Error Jest__parseArr(Jest_JsonVal *out, Jest_Lexer *lexer);
-static Jest_Error Jest__parseObj(Jest_JsonVal *out, Jest_Lexer *lexer);
-
-// Jest_printJsonVal with prepended tabs
-static void Jest__printJsonVal(FILE *file, const Jest_JsonVal *val, bool escape_unicode, int starttabs, int midtabs);
-
-bool Jest_signbit(double x)
-{
-    return *(uint64_t *)(void *)&x >> 63;
-}
-
-bool Jest_isnan(double x)
-{
-    const uint64_t bits = *(uint64_t *)(void *)&x;
-    // 0xffe0000000000000 (infinity's bits shifted by one so that the sign bit can be ignored)
-    return bits << 1 > UINT64_C(0xffe0000000000000);
-}
-
-bool Jest_isinf(double x)
-{
-    const uint64_t bits = *(uint64_t *)(void *)&x;
-    // 0xffe0000000000000 (infinity's bits shifted by one so that the sign bit can be ignored)
-    return bits << 1 == UINT64_C(0xffe0000000000000);
-}
-
-char *Jest_strndup(const char *str, size_t len)
-{
-    if (!str) return NULL;
-
-    char *ret = (char *)calloc(len + 1, 1);
-    if (!ret) return NULL;
-
-    memcpy(ret, str, len);
-    return ret;
-}
-
-char *Jest_dblToStr(char *buffer, size_t bufsz, double x)
-{
-    if (!buffer || bufsz < 32) return NULL;
-
-    size_t start = 0;
-    if (Jest_signbit(x)) buffer[start++] = '-';
-
-    // the size of the buffer is checked before strcpy is used so this is fine
-    // NOLINTBEGIN(clang-analyzer-security.insecureAPI.strcpy)
-    if (Jest_isinf(x)) {
-        strcpy(&buffer[start], "Infinity");
-        return buffer;
-    }
-
-    if (Jest_isnan(x)) {
-        strcpy(&buffer[start], "NaN");
-        return buffer;
-    }
-    // NOLINTEND(clang-analyzer-security.insecureAPI.strcpy)
-
-    sprintf(buffer, "%.15g", x);
-    return buffer;
-}
-
-char *Jest_boolToStr(char *buffer, size_t bufsz, bool b)
-{
-    if (!buffer || bufsz < 6) return NULL;
-    // the size of the buffer is checked before strcpy is used so this is fine
-    // NOLINTNEXTLINE(clang-analyzer-security.insecureAPI.strcpy)
-    strcpy(buffer, (b)? "true" : "false");
-    return buffer;
-}
-
-size_t Jest_readEntireFile(char **out, FILE *file)
-{
-    if (!out || !file) return 0; 
-
-    fseek(file, 0, SEEK_END);
-    long fsize = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    if (!fsize) return 0;
-
-    // I explicitly make sure that this has an allocation size of more than 0 bytes
-    // NOLINTNEXTLINE(clang-analyzer-optin.portability.UnixAPI)
-    *out = (char *)calloc(fsize + 1, 1);
-    if (!*out) return 0;
-
-    fread(*out, 1, fsize, file);
-    return (size_t)fsize;
-}
-
-size_t Jest_readEntireFileFromPath(char **out, const char *path)
-{
-    if (!out || !path) return 0; 
-
-    FILE *f = fopen(path, "r");
-    if (!f) return 0;
-
-    const size_t ret = Jest_readEntireFile(out, f);
-    fclose(f);
-
-    return ret;
-}
-
-bool Jest_initLexer(Jest_Lexer *l, char *strbuf, size_t strbuf_sz, const char *filebuf, size_t filebuf_sz)
-{
-    if (!l || !strbuf || !strbuf_sz || !filebuf || !filebuf_sz) return false;
-
-    memset(l, 0, sizeof(*l));
-    l->strbuf = strbuf;
-    l->strbuf_sz = strbuf_sz;
-
-    l->filebuf = filebuf;
-    l->filebuf_sz = filebuf_sz;
-    l->filebuf_offset = 0;
-
-    return Jest_lexerStep(l);
-}
-
-bool Jest_lexerStep(Jest_Lexer *l)
-{
-    if (!l) return false;
-    l->type = JEST_LEXEME_ERR;
-
-    Jest__lexerSkipCommentAndWhiteSpace(l);
-    if (l->filebuf_offset >= l->filebuf_sz) {
-        l->type = JEST_LEXEME_EOF;
-        return false;
-    }
-
-    switch (l->filebuf[l->filebuf_offset]) {
-        case ':': l->type = ':'; break;
-        case ',': l->type = ','; break;
-        case '{': l->type = '{'; break;
-        case '}': l->type = '}'; break;
-        case '[': l->type = '['; break;
-        case ']': l->type = ']'; break;
-        case '"':  
-        case '\'': goto lbl_str;
-        default: break;
-    }
-
-    if (l->type < 256) {
-        ++l->filebuf_offset;
-        return true;
-    }
-
-    if (isalpha(l->filebuf[l->filebuf_offset]) || l->filebuf[l->filebuf_offset] == '_' || l->filebuf[l->filebuf_offset] == '$') {
-        l->type = JEST_LEXEME_IDENT;
-        l->ident_start = l->filebuf_offset;
-
-        while (isalnum(l->filebuf[l->filebuf_offset]) || l->filebuf[l->filebuf_offset] == '_' || l->filebuf[l->filebuf_offset] == '$') {
-            ++l->filebuf_offset;
-        }
-
-        l->ident_len = l->filebuf_offset - l->ident_start;
-        if (!strncmp(&l->filebuf[l->ident_start], "Infinity", l->ident_len)) {
-            l->type = JEST_LEXEME_NUM;
-            l->numval = JEST_INF;
-        } else if (!strncmp(&l->filebuf[l->ident_start], "NaN", l->ident_len)) {
-            l->type = JEST_LEXEME_NUM;
-            l->numval = JEST_NAN;
-        } else if (!strncmp(&l->filebuf[l->ident_start], "true", l->ident_len)) {
-            l->type = JEST_LEXEME_BOOL;
-            l->boolval = true;
-        } else if (!strncmp(&l->filebuf[l->ident_start], "false", l->ident_len)) {
-            l->type = JEST_LEXEME_BOOL;
-            l->boolval = false;
-        } else if (!strncmp(&l->filebuf[l->ident_start], "null", l->ident_len)) {
-            l->type = JEST_LEXEME_NULL;
-        }
-
-        return true;
-    }
-
-    if (isdigit(l->filebuf[l->filebuf_offset]) || l->filebuf[l->filebuf_offset] == '.' || l->filebuf[l->filebuf_offset] == '+' || l->filebuf[l->filebuf_offset] == '-') {
-        int tmp = 0;
-        if (sscanf(&l->filebuf[l->filebuf_offset], "%lf%n", &l->numval, &tmp) != 1) return false;
-        l->filebuf_offset += tmp;
-        l->type = JEST_LEXEME_NUM;
-        return true;
-    }
-
-    return false;
-
-lbl_str:
-    l->type = JEST_LEXEME_STR;
-    if (Jest__lexerHandleStr(l)) return false;
-    return true;
-}
-
-Jest_Error Jest_jsonArrayAppend(Jest_JsonVal *arr, const Jest_JsonVal *elem)
-{
-    if (!arr || !elem || arr == elem) return JEST_ERROR_BADPARAM;
-    if (arr->type != JEST_JSONTYPE_ARR) return JEST_ERROR_BADPARAM;
-
-    if (arr->v.as_arr.len + 1 > arr->v.as_arr.cap) {
-        arr->v.as_arr.cap = (arr->v.as_arr.cap)? arr->v.as_arr.cap * 2 : 32;
-        arr->v.as_arr.elems = (Jest_JsonVal *)realloc(arr->v.as_arr.elems, sizeof(*arr->v.as_arr.elems) * arr->v.as_arr.cap);
-        if (!arr->v.as_arr.elems) return JEST_ERROR_NOMEM;
-    }
-
-    memcpy(&arr->v.as_arr.elems[arr->v.as_arr.len++], elem, sizeof(*elem));
-    return JEST_ERROR_NONE;
-}
-
-Jest_Error Jest_jsonObjAdd(Jest_JsonVal *obj, const char *field_name, Jest_JsonVal value)
-{
-    if (!obj || !field_name) return JEST_ERROR_BADPARAM;
-    if (obj->type != JEST_JSONTYPE_OBJ) return JEST_ERROR_BADPARAM;
-
-    const size_t name_len = strlen(field_name);
-
-    for (size_t i = 0; i < obj->v.as_obj.nfields; ++i) {
-        if (!strncmp(field_name, obj->v.as_obj.field_names[i], name_len)) {
-            memcpy(&obj->v.as_obj.field_values[i], &value, sizeof(value));
-            return JEST_ERROR_NONE;
-        }
-    }
-
-    if (obj->v.as_obj.nfields + 1 > obj->v.as_obj.nalloced) {
-        obj->v.as_obj.nalloced = (obj->v.as_obj.nalloced)? 2 * obj->v.as_obj.nalloced : 16;
-        obj->v.as_obj.field_names = (char **)realloc(obj->v.as_obj.field_names, sizeof(*obj->v.as_obj.field_names) * obj->v.as_obj.nalloced);
-        obj->v.as_obj.fn_lens = (size_t *)realloc(obj->v.as_obj.fn_lens, sizeof(*obj->v.as_obj.fn_lens) * obj->v.as_obj.nalloced);
-        obj->v.as_obj.field_values = (Jest_JsonVal *)realloc(obj->v.as_obj.field_values, sizeof(*obj->v.as_obj.field_values) * obj->v.as_obj.nalloced);
-        if (!obj->v.as_obj.field_names || !obj->v.as_obj.fn_lens || !obj->v.as_obj.field_values) return JEST_ERROR_NOMEM;
-    }
-
-    obj->v.as_obj.fn_lens[obj->v.as_obj.nfields] = name_len;
-    obj->v.as_obj.field_names[obj->v.as_obj.nfields] = Jest_strndup(field_name, name_len);
-    if (!obj->v.as_obj.field_names[obj->v.as_obj.nfields]) return JEST_ERROR_NOMEM;
-    memcpy(&obj->v.as_obj.field_values[obj->v.as_obj.nfields], &value, sizeof(value));
-    ++obj->v.as_obj.nfields;
-
-    return JEST_ERROR_NONE;
-}
-
-Jest_Error Jest_parseJsonLexer(Jest_JsonVal *out, Jest_Lexer *lexer)
-{
-    if (!out || !lexer) return JEST_ERROR_BADPARAM;
-
-    switch (lexer->type) {
-        case JEST_LEXEME_NULL: Jest__parseNull(out,lexer);  break;
-        case JEST_LEXEME_BOOL: Jest__parseBool(out, lexer); break;
-        case JEST_LEXEME_NUM:  Jest__parseNum(out, lexer);  break;
-        case JEST_LEXEME_STR:  Jest__parseStr(out, lexer);  break;
-        case '[':               Jest__parseArr(out, lexer);  break;
-        case '{':               Jest__parseObj(out, lexer);  break;
-        default: return JEST_ERROR_SYNTAX;
-    }
-
-    return JEST_ERROR_NONE;
-}
-
-Jest_Error Jest_parseJsonFile(Jest_JsonVal *out, FILE *file)
-{
-    if (!out || !file) return JEST_ERROR_BADPARAM;
-
-    char *strbuf = (char *)calloc(1024, 1);
-    if (!strbuf) return JEST_ERROR_NOMEM;
-
-    char *filebuf = NULL;
-    size_t filebuf_sz = Jest_readEntireFile(&filebuf, file);
-
-    if (!filebuf || !filebuf_sz) {
-        free(filebuf);
-        free(strbuf);
-        return JEST_ERROR_IO;
-    }
-
-    Jest_Lexer l;
-    if (!Jest_initLexer(&l, strbuf, 1024, filebuf, filebuf_sz)) {
-        free(strbuf);
-        free(filebuf);
-        return JEST_ERROR_BADLEXER;
-    }
-
-    Jest_Error ret = Jest_parseJsonLexer(out, &l);
-
-    free(strbuf);
-    free(filebuf);
-    return ret;
-}
-
-Jest_Error Jest_parseJsonFileFromPath(Jest_JsonVal *out, const char *path)
-{
-    if (!out || !path) return JEST_ERROR_BADPARAM; 
-
-    FILE *f = fopen(path, "r");
-    if (!f) return JEST_ERROR_IO;
-
-    const Jest_Error ret = Jest_parseJsonFile(out, f);
-    fclose(f);
-
-    return ret;
-}
-
-Jest_Error Jest_parseJsonFromStr(Jest_JsonVal *out, const char *str);
-
-void Jest_printJsonVal(FILE *file, const Jest_JsonVal *val, bool escape_unicode)
-{
-    Jest__printJsonVal(file, val, escape_unicode, 0, 0);
-}
-
-void Jest_destroyJsonVal(Jest_JsonVal *val)
-{
-    if (!val) return;
-
-    switch (val->type) {
-        case JEST_JSONTYPE_NULL:
-        case JEST_JSONTYPE_BOOL:
-        case JEST_JSONTYPE_NUM:
-        case JEST_JSONTYPE_ERR:
-            break;
-
-        case JEST_JSONTYPE_STR: goto lbl_destroy_str;
-        case JEST_JSONTYPE_ARR: goto lbl_destroy_arr;
-        case JEST_JSONTYPE_OBJ: goto lbl_destroy_obj;
-    }
-
-    memset(val, 0, sizeof(*val));
-    return;
-
-lbl_destroy_str:
-    free(val->v.as_str.data);
-    memset(val, 0, sizeof(*val));
-    return;
-
-lbl_destroy_arr:
-    for (size_t i = 0; i < val->v.as_arr.len; ++i) {
-        Jest_destroyJsonVal(&val->v.as_arr.elems[i]);
-    }
-
-    free(val->v.as_arr.elems);
-    memset(val, 0, sizeof(*val));
-    return;
-
-lbl_destroy_obj:
-    for (size_t i = 0; i < val->v.as_obj.nfields; ++i) {
-        Jest_destroyJsonVal(&val->v.as_obj.field_values[i]);
-        free(val->v.as_obj.field_names[i]);
-    }
-
-    free(val->v.as_obj.field_names);
-    free(val->v.as_obj.fn_lens);
-    free(val->v.as_obj.field_values);
-    memset(val, 0, sizeof(*val));
-    return;
-}
-
-Jest_JsonVal *Jest_jsonIdx(Jest_JsonVal *parent, const char *accessor, Jest_Error *opt_err_out)
-{
-    if (!parent || !accessor) {
-        if (opt_err_out) *opt_err_out = JEST_ERROR_BADPARAM;
-        return NULL;
-    }
-
-    if (parent->type != JEST_JSONTYPE_OBJ && parent->type != JEST_JSONTYPE_ARR) {
-        if (opt_err_out) *opt_err_out = JEST_ERROR_BADPARAM;
-        return NULL;
-    }
-
-    Jest_Lexer lexer;
-    char *strbuf = (char *)malloc(1024);
-    if (!strbuf) {
-        if (opt_err_out) *opt_err_out = JEST_ERROR_NOMEM;
-        return NULL;
-    }
-
-    if (!Jest_initLexer(&lexer, strbuf, 1024, accessor, strlen(accessor) + 1)) {
-        if (opt_err_out) *opt_err_out = JEST_ERROR_BADLEXER;
-        free(strbuf);
-        return NULL;
-    }
-
-    bool is_field_start = false;
-    Jest_JsonVal *current = parent;
-
-    const char *field_name = NULL;
-    size_t field_name_len = 0;
-    size_t elem_idx = (size_t)-1;
-
-    do {
-        if (is_field_start && current->type == JEST_JSONTYPE_OBJ) {
-            if (lexer.type != JEST_LEXEME_STR && lexer.type != JEST_LEXEME_IDENT) {
-                if (opt_err_out) *opt_err_out = JEST_ERROR_BADPARAM;
-                return NULL;
-            }
-
-            field_name = (lexer.type == JEST_LEXEME_STR)
-                ? lexer.strbuf
-                : &lexer.filebuf[lexer.ident_start];
-
-            field_name_len = (lexer.type == JEST_LEXEME_STR)
-                ? lexer.strval_len
-                : lexer.ident_len;
-
-            size_t i; // forward-declare 'i' for error-handling purposes
-            for (i = 0; i < current->v.as_obj.nfields; ++i) {
-                if (!strncmp(current->v.as_obj.field_names[i], field_name, field_name_len)) {
-                    break;
-                }
-            }
-
-            if (i >= current->v.as_obj.nfields) {
-                if (opt_err_out) *opt_err_out = JEST_ERROR_BADPARAM;
-                free(strbuf);
-                return NULL;
-            }
-
-            current = &current->v.as_obj.field_values[i];
-
-            is_field_start = false;
-
-            Jest_lexerStep(&lexer);
-            if (lexer.type != ']') {
-                if (opt_err_out) *opt_err_out = JEST_ERROR_SYNTAX;
-                free(strbuf);
-                return NULL;
-            }
-            continue;
-        }
-
-        if (is_field_start && current->type == JEST_JSONTYPE_ARR) {
-            if (lexer.type != JEST_LEXEME_NUM) {
-                if (opt_err_out) *opt_err_out = JEST_ERROR_SYNTAX;
-                free(strbuf);
-                return NULL;
-            }
-
-            elem_idx = (size_t)lexer.numval;
-            if (elem_idx >= current->v.as_arr.len) {
-                if (opt_err_out) *opt_err_out = JEST_ERROR_BADPARAM;
-                free(strbuf);
-                return NULL;
-            }
-
-            current = &current->v.as_arr.elems[elem_idx];
-
-            is_field_start = false;
-            
-            Jest_lexerStep(&lexer);
-            if (lexer.type != ']') {
-                if (opt_err_out) *opt_err_out = JEST_ERROR_SYNTAX;
-                free(strbuf);
-                return NULL;
-            }
-            continue;
-        }
-
-        if (lexer.type == '[') {
-            if (is_field_start) {
-                if (opt_err_out) *opt_err_out = JEST_ERROR_SYNTAX;
-                free(strbuf);
-                return NULL;
-            }
-
-            is_field_start = true;
-            continue;
-        }
-
-        if (opt_err_out) *opt_err_out = JEST_ERROR_SYNTAX;
-        free(strbuf);
-        return NULL;
-    } while (Jest_lexerStep(&lexer));
-
-    free(strbuf);
-
-    if (opt_err_out) *opt_err_out = JEST_ERROR_NONE;
-    return current;
-}
-
-static void Jest__lexerSkipCommentAndWhiteSpace(Jest_Lexer *l)
-{
-    if (!l) return;
-
-    // save initial offset
-    const size_t start_offset = l->filebuf_offset;
-
-    // skip initial whitespace
-    while (isspace(l->filebuf[l->filebuf_offset])) ++l->filebuf_offset;
-    if (l->filebuf[l->filebuf_offset] != '/') return;
-
-    ++l->filebuf_offset;
-    if (l->filebuf[l->filebuf_offset] == '/') { // single line comments
-        l->filebuf_offset = strchr(&l->filebuf[l->filebuf_offset], '\n') - l->filebuf;
-        if (l->filebuf_offset > l->filebuf_sz) l->filebuf_offset = start_offset;
-    } else if (l->filebuf[l->filebuf_offset] == '*') { // multiline comments
-        ++l->filebuf_offset;
-        do {
-            l->filebuf_offset = strchr(&l->filebuf[l->filebuf_offset], '*') - l->filebuf;
-            if (l->filebuf_offset >= l->filebuf_sz) {
-                l->filebuf_offset = start_offset;
-                goto lbl_end;
-            }
-        } while (l->filebuf[l->filebuf_offset + 1] != '/');
-        l->filebuf_offset += 2;
-    } else l->filebuf_offset = start_offset;
-
-lbl_end:
-    Jest__lexerSkipCommentAndWhiteSpace(l); // skip any extra comments and such
-}
-
-static Jest_Error Jest__lexerHandleStr(Jest_Lexer *l)
-{
-    if (!l) return JEST_ERROR_BADPARAM;
-
-    Jest__lexerSkipCommentAndWhiteSpace(l);
-    if (l->filebuf[l->filebuf_offset] != '\'' && l->filebuf[l->filebuf_offset] != '\"') {
-        return JEST_ERROR_BADPARAM;
-    }
-
-    l->type = JEST_LEXEME_STR;
-    const char quot = l->filebuf[l->filebuf_offset++];
-
-    l->strval_len = 0;
-    while (l->filebuf[l->filebuf_offset] != quot) {
-        if (l->filebuf[l->filebuf_offset] == '\\') {
-            l->filebuf_offset++;
-            switch (l->filebuf[l->filebuf_offset]) {
-                case '\n':
-                case '\r':
-                    while (isspace(l->filebuf[l->filebuf_offset + 1])) ++l->filebuf_offset;
-                    break;
-
-                case '\\': l->strbuf[l->strval_len++] = '\\'; break;
-                case '\'': l->strbuf[l->strval_len++] = '\''; break;
-                case '\"': l->strbuf[l->strval_len++] = '\"'; break;
-                case '/':  l->strbuf[l->strval_len++] =  '/'; break;
-                case 'b':  l->strbuf[l->strval_len++] = '\b'; break;
-                case 'f':  l->strbuf[l->strval_len++] = '\f'; break;
-                case 'n':  l->strbuf[l->strval_len++] = '\n'; break;
-                case 'r':  l->strbuf[l->strval_len++] = '\r'; break;
-                case 't':  l->strbuf[l->strval_len++] = '\t'; break;
-                case 'v':  l->strbuf[l->strval_len++] = '\v'; break;
-                case '0':  l->strbuf[l->strval_len++] = '\0'; break;
-                case 'u': {
-                    --l->filebuf_offset;
-                    int offset = 0;
-                    uint32_t codepoint = 0;
-                    sscanf(&l->filebuf[l->filebuf_offset], "\\u%4" SCNx32 "%n", &codepoint, &offset);
-                    if (offset < 6) return JEST_ERROR_BADCHAR;
-
-                    // if codepoint is a hi surrogate
-                    if (0xd800 <= codepoint && codepoint <= 0xdfbb) {
-                        uint32_t lo = 0;
-                        const int sscanf_result = sscanf(&l->filebuf[l->filebuf_offset + 6], "\\u%4" SCNx32 "%n", &lo, &offset);
-
-                        if (sscanf_result == 1) { // if there is a second unicode char
-                            if (offset < 6) return JEST_ERROR_BADCHAR;
-
-                            if (0xdc00 <= lo && lo <= 0xdfff) { // check if it's a lo surrogate to match the hi surrogate
-                                offset = 12;
-                                codepoint = ((codepoint - 0xd800) << 10) + ((lo - 0xdc00)) + 0x10000;
-                            } else { // if not set the offset to 6 so that it isn't skipped on the next iteration of the loop
-                                offset =  6;
-                            }
-                        }
-                    }
-
-                    if (codepoint <= 0x7F) {
-                        l->strbuf[l->strval_len++] = (char)codepoint;
-                    } else if (codepoint <= 0x7FF) {
-                        l->strbuf[l->strval_len++] = (char)(((codepoint >> 6) & 0x1f)  | 0xc0);
-                        l->strbuf[l->strval_len++] = (char)(((codepoint)      & 0x3f)  | 0x80);
-                    } else if (codepoint <= 0xFFFF) {
-                        l->strbuf[l->strval_len++] = (char)(((codepoint >> 12) & 0x0f) | 0xe0);
-                        l->strbuf[l->strval_len++] = (char)(((codepoint >> 6)  & 0x3f) | 0x80);
-                        l->strbuf[l->strval_len++] = (char)(((codepoint)       & 0x3f) | 0x80);
-                    } else if (codepoint <= 0x10FFFF) {
-                        l->strbuf[l->strval_len++] = (char)(((codepoint >> 18) & 0x07) | 0xf0);
-                        l->strbuf[l->strval_len++] = (char)(((codepoint >> 12) & 0x3f) | 0x80);
-                        l->strbuf[l->strval_len++] = (char)(((codepoint >> 6)  & 0x3f) | 0x80);
-                        l->strbuf[l->strval_len++] = (char)(((codepoint)       & 0x3f) | 0x80);
-                    } else {
-                        return JEST_ERROR_BADCHAR;
-                    }
-
-                    l->filebuf_offset += offset - 1;
-                } break;
-
-                case 'x': {
-                    --l->filebuf_offset;
-                    int offset = 0;
-                    uint32_t codepoint = 0;
-                    sscanf(&l->filebuf[l->filebuf_offset], "\\x%2" SCNx32 "%n", &codepoint, &offset);
-                    if (offset < 4) return JEST_ERROR_BADCHAR;
-
-                    if (codepoint <= 0x7F) {
-                        l->strbuf[l->strval_len++] = (char)codepoint;
-                    } else {
-                        l->strbuf[l->strval_len++] = (char)(((codepoint >> 6) & 0x1f)  | 0xc0);
-                        l->strbuf[l->strval_len++] = (char)(((codepoint)      & 0x3f)  | 0x80);
-                    }
-
-                    l->filebuf_offset += offset - 1;
-                } break;
-                default: l->strbuf[l->strval_len++] = l->filebuf[l->filebuf_offset]; break;
-            }
-
-            ++l->filebuf_offset;
-            continue;
-        }
-
-        l->strbuf[l->strval_len++] = l->filebuf[l->filebuf_offset];
-        ++l->filebuf_offset;
-    }
-
-    ++l->filebuf_offset;
-    return JEST_ERROR_NONE;
-}
-
-static Jest_Error Jest__parseNull(Jest_JsonVal *out, Jest_Lexer *lexer)
-{
-    if (!out || !lexer) return JEST_ERROR_BADPARAM;
-    if (lexer->type != JEST_LEXEME_NULL) return JEST_ERROR_BADPARAM;
-
-    out->type = JEST_JSONTYPE_NULL;
-    Jest_lexerStep(lexer);
-
-    return JEST_ERROR_NONE;
-}
-
-static Jest_Error Jest__parseBool(Jest_JsonVal *out, Jest_Lexer *lexer)
-{
-    if (!out || !lexer) return JEST_ERROR_BADPARAM;
-    if (lexer->type != JEST_LEXEME_BOOL) return JEST_ERROR_BADPARAM;
-
-    out->type = JEST_JSONTYPE_BOOL;
-    out->v.as_bool = lexer->boolval;
-    Jest_lexerStep(lexer);
-
-    return JEST_ERROR_NONE;
-}
-
-static Jest_Error Jest__parseNum(Jest_JsonVal *out, Jest_Lexer *lexer)
-{
-    if (!out || !lexer) return JEST_ERROR_BADPARAM;
-    if (lexer->type != JEST_LEXEME_NUM) return JEST_ERROR_BADPARAM;
-
-    out->type = JEST_JSONTYPE_NUM;
-    out->v.as_num = lexer->numval;
-    Jest_lexerStep(lexer);
-
-    return JEST_ERROR_NONE;
-}
-
-static Jest_Error Jest__parseStr(Jest_JsonVal *out, Jest_Lexer *lexer)
-{
-    if (!out || !lexer) return JEST_ERROR_BADPARAM;
-    if (lexer->type != JEST_LEXEME_STR) return JEST_ERROR_BADPARAM;
-
-    out->type = JEST_JSONTYPE_STR;
-    out->v.as_str.len = lexer->strval_len;
-    out->v.as_str.data   = Jest_strndup(lexer->strbuf, lexer->strval_len);
-    if (!out->v.as_str.data) return JEST_ERROR_NOMEM;
-
-    Jest_lexerStep(lexer);
-    return JEST_ERROR_NONE;
-}
-
-static Jest_Error Jest__parseArr(Jest_JsonVal *out, Jest_Lexer *lexer)
-{
-    if (!out || !lexer) return JEST_ERROR_BADPARAM;
-    if (lexer->type != '[') return JEST_ERROR_BADPARAM;
-
-    out->type = JEST_JSONTYPE_ARR;
-    memset(&out->v, 0, sizeof(out->v));
-
-    do {
-        Jest_lexerStep(lexer);
-        if (lexer->type == ']') break;
-        Jest_JsonVal elem;
-        Jest_parseJsonLexer(&elem, lexer);
-        Jest_jsonArrayAppend(out, &elem);
-    } while (lexer->type == ',');
-    if (lexer->type != ']') return JEST_ERROR_SYNTAX;
-
-    Jest_lexerStep(lexer);
-    return JEST_ERROR_NONE;
-}
-
-static Jest_Error Jest__parseObj(Jest_JsonVal *out, Jest_Lexer *lexer)
-{
-    if (!out || !lexer) return JEST_ERROR_BADPARAM;
-    if (lexer->type != '{') return JEST_ERROR_BADPARAM;
-
-    out->type = JEST_JSONTYPE_OBJ;
-    memset(&out->v, 0, sizeof(out->v));
-
-    do {
-    Jest_lexerStep(lexer);
-        if (lexer->type == '}') break;
-        char *name = NULL;
-        size_t name_len = 0;
-        
-        if (lexer->type != JEST_LEXEME_STR && lexer->type != JEST_LEXEME_IDENT) return JEST_ERROR_BADPARAM;
-        
-        name_len = (lexer->type == JEST_LEXEME_STR)? lexer->strval_len : lexer->ident_len;
-        name = Jest_strndup(
-            (lexer->type == JEST_LEXEME_STR)
-                ?lexer->strbuf
-                :&lexer->filebuf[lexer->ident_start],
-            name_len
-        );
-
-        if (!name) return JEST_ERROR_NOMEM;
-
-        Jest_lexerStep(lexer);
-        if (lexer->type != ':') {
-            free(name);
-            return JEST_ERROR_SYNTAX;
-        }
-
-        Jest_lexerStep(lexer);
-
-        Jest_JsonVal elem;
-        Jest_parseJsonLexer(&elem, lexer);
-        Jest_jsonObjAdd(out, name, elem);
-        free(name);
-    } while (lexer->type == ',');
-    if (lexer->type != '}') return JEST_ERROR_SYNTAX;
-
-    Jest_lexerStep(lexer);
-    return JEST_ERROR_NONE;
-}
-
-static void Jest__printJsonVal(FILE *file, const Jest_JsonVal *val, bool escape_unicode, int starttabs, int midtabs)
-{
-    if (!file || !val) return;
-
-    for (int i = 0; i < starttabs; ++i) fputc('\t', file);
-
-    switch (val->type) {
-        case JEST_JSONTYPE_NULL: fprintf(file, "%s", "null"); break;
-        case JEST_JSONTYPE_BOOL: fprintf(file, "%s", (val->v.as_bool)? "true" : "false"); break;
-        case JEST_JSONTYPE_NUM:  goto lbl_print_num;
-        case JEST_JSONTYPE_STR:  goto lbl_print_str;
-        case JEST_JSONTYPE_ARR:  goto lbl_print_arr;
-        case JEST_JSONTYPE_OBJ:  goto lbl_print_obj;
-        case JEST_JSONTYPE_ERR:  break;
-    }
-
-    return;
-
-lbl_print_num:
-    if (Jest_isinf(val->v.as_num)) {
-        if (Jest_signbit(val->v.as_num)) fputc('-', file);
-        fprintf(file, "%s", "Infinity");
-        return;
-    }
-
-    if (Jest_isnan(val->v.as_num)) {
-        if (Jest_signbit(val->v.as_num)) fputc('-', file);
-        fprintf(file, "%s", "NaN");
-        return;
-    }
-
-    fprintf(file, "%.15g", val->v.as_num);
-    return;
-
-lbl_print_str:
-    fputc('"', file);
-    for (size_t i = 0; i < val->v.as_str.len; ++i) {
-        switch (val->v.as_str.data[i]) {
-            case '\n': fprintf(file, "%s", "\\n");  continue;
-            case '\\': fprintf(file, "%s", "\\\\"); continue;
-            case '\'': fprintf(file, "%s", "\\'");  continue;
-            case '\"': fprintf(file, "%s", "\\\""); continue;
-            case '/':  fprintf(file, "%s", "\\/");  continue;
-            case '\b': fprintf(file, "%s", "\\b");  continue;
-            case '\f': fprintf(file, "%s", "\\f");  continue;
-            case '\r': fprintf(file, "%s", "\\r");  continue;
-            case '\t': fprintf(file, "%s", "\\t");  continue;
-            case '\v': fprintf(file, "%s", "\\v");  continue;
-            default: break;
-        }
-
-        uint32_t codepoint = (uint8_t)(val->v.as_str.data[i]);
-
-        if (iscntrl((int)codepoint)) {
-            fprintf(file, "\\u%.4" PRIx32, codepoint);
-            continue;
-        }
-
-        if (escape_unicode && codepoint >= 0x80) {
-            if (codepoint & 0xf0) {
-                codepoint = (codepoint & 0x07) << 6;
-                codepoint |= ((uint8_t)(val->v.as_str.data[++i]) & 0x3f);
-                codepoint <<= 6;
-                codepoint |= ((uint8_t)(val->v.as_str.data[++i]) & 0x3f);
-                codepoint <<= 6;
-                codepoint |= ((uint8_t)(val->v.as_str.data[++i]) & 0x3f);
-
-                // break the codepoint into utf-16 surrogate pairs
-                codepoint -= 0x10000;
-                codepoint &= 0xfffff;
-                uint16_t hi = (codepoint >> 10) + 0xd800;
-                uint16_t lo = (codepoint & 0x3ff) + 0xdc00;
-
-                fprintf(file, "\\u%.4" PRIx32 "\\u%.4" PRIx32, hi, lo);
-                continue;
-            }
-
-            if (codepoint & 0xc0) {
-                codepoint = (codepoint & 0x1f) << 6;
-                codepoint |= ((uint8_t)(val->v.as_str.data[++i]) & 0x3f);
-                fprintf(file, "\\u%.4" PRIx32, codepoint);
-                continue;
-            }
-
-            if (codepoint & 0xe0) {
-                codepoint = (codepoint & 0x0f) << 6;
-                codepoint |= ((uint8_t)(val->v.as_str.data[++i]) & 0x3f);
-                codepoint <<= 6;
-                codepoint |= ((uint8_t)(val->v.as_str.data[++i]) & 0x3f);
-                fprintf(file, "\\u%.4" PRIx32, codepoint);
-                continue;
-            }
-        } else fputc(val->v.as_str.data[i], file);
-    }
-    fputc('"', file);
-
-    return;
-
-lbl_print_arr:
-    fputc('[', file);
-
-    for (size_t i = 0; i < val->v.as_arr.len; ++i) {
-        if (i) fputc(',', file);
-        fputc('\n', file);
-
-        Jest__printJsonVal(file, &val->v.as_arr.elems[i], escape_unicode, midtabs + 1, midtabs + 1);
-    }
-
-    fputc('\n', file);
-    for (int i = 0; i < midtabs; ++i) fputc('\t', file);
-    fputc(']', file);
-    return;
-
-lbl_print_obj:
-    fputc('{', file);
-
-    for (size_t i = 0; i < val->v.as_obj.nfields; ++i) {
-        if (i) fputc(',', file);
-        fputc('\n', file);
-
-        Jest_JsonVal name_as_val;
-        name_as_val.type = JEST_JSONTYPE_STR;
-        name_as_val.v.as_str.len = val->v.as_obj.fn_lens[i];
-        name_as_val.v.as_str.data   = val->v.as_obj.field_names[i];
-
-        Jest__printJsonVal(file, &name_as_val, escape_unicode, midtabs + 1, midtabs + 1);
-        fputc(':', file);
-        fputc(' ', file);
-        Jest__printJsonVal(file, &val->v.as_obj.field_values[i], escape_unicode, 0, midtabs + 1);
-    }
-
-    fputc('\n', file);
-    for (int i = 0; i < midtabs; ++i) fputc('\t', file);
-    fputc('}', file);
-    return;
-}
-
-#endif // JEST_IMPL
+/*
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JEST_TODO(str) do {fprintf(stderr, "[%s:%d: %s] TODO: %s\n", __FILE__, __LINE__, __func__, str); exit(-1);} while (0)
+
+#ifndef JEST_H_
+#define JEST_H_ 1
+
+#ifndef JEST_NAN
+#   ifdef NAN
+#       define JEST_NAN NAN
+#   elif defined(__GNUC__)
+#       define JEST_NAN __builtin_nanf("")
+#   else
+#       define JEST_NAN (0.0/0.0)
+#   endif
+#endif // !JEST_NAN
+
+#ifndef JEST_INF
+#   ifdef INF
+#       define JEST_INF INF
+#   elif defined(__GNUC__)
+#       define JEST_INF __builtin_inff()
+#   else
+#       define JEST_INF (1.0/0.0)
+#   endif
+#endif // !JEST_INF
+
+typedef int Jest_LexemeType;
+enum Jest__LexemeType {
+    JEST_LEXEME_ERR = 256,
+    JEST_LEXEME_IDENT,
+    JEST_LEXEME_NULL,
+    JEST_LEXEME_BOOL,
+    JEST_LEXEME_NUM,
+    JEST_LEXEME_STR,
+    JEST_LEXEME_EOF
+};
+
+// default for Jest_Lexer.max_depth
+#ifndef JEST_MAX_DEPTH
+#   define JEST_MAX_DEPTH 1024
+#endif // !JEST_MAX_DEPTH
+
+typedef struct Jest_Lexer {
+    bool boolval;
+    Jest_LexemeType type;
+
+    // scratch space for decoding strings with escapes, replaced by a bigger heap buffer whenever
+    // a string doesn't fit, Jest_destroyLexer frees it once the lexer has allocated it itself
+    char *strbuf;
+    size_t strbuf_sz;
+    bool strbuf_owned;
+
+    // the current string, points into filebuf when it has no escapes and into strbuf otherwise
+    const char *strval;
+    size_t strval_len;
+
+    size_t filebuf_offset;
+    size_t filebuf_sz;
+    const char *filebuf;
+
+    size_t ident_start;
+    size_t ident_len;
+    double numval;
+
+    // containers nested deeper than this fail with JEST_ERROR_DEPTH, 0 means JEST_MAX_DEPTH
+    size_t max_depth;
+
+    // decode strings with escapes inside filebuf instead of strbuf, filebuf has to be writable then
+    bool insitu;
+} Jest_Lexer;
+
+typedef enum Jest_JsonType {
+    JEST_JSONTYPE_NULL,
+    JEST_JSONTYPE_BOOL,
+    JEST_JSONTYPE_NUM,
+    JEST_JSONTYPE_STR,
+    JEST_JSONTYPE_ARR,
+    JEST_JSONTYPE_OBJ,
+    JEST_JSONTYPE_ERR
+} Jest_JsonType;
+
+typedef enum Jest_Error {
+    JEST_ERROR_NONE, // no error, everything is fine :)
+    JEST_ERROR_NOMEM, // malloc/calloc/realloc failed
+    JEST_ERROR_BADPARAM, // invalid parameter
+    JEST_ERROR_SYNTAX, // syntax error
+    JEST_ERROR_BADLEXER, // lexer creation failed at some point
+    JEST_ERROR_BADCHAR, // malformed unicode/hex char
+    JEST_ERROR_IO, // i/o error
+    JEST_ERROR_ABORTED, // a callback asked to stop
+    JEST_ERROR_DEPTH // containers are nested deeper than the lexer's max_depth
+} Jest_Error;
+
+// set on values whose storage belongs to a Jest_Document's arena, these are freed
+// all at once by Jest_destroyDocument and must be modified through the Jest_doc* functions
+#define JEST_JSONFLAG_ARENA 0x1u
+
+typedef struct Jest_JsonVal {
+    Jest_JsonType type;
+    unsigned flags; // JEST_JSONFLAG_*
+
+    union {
+        bool as_bool;
+        double as_num;
+        struct { size_t len; char *data; } as_str;
+        struct { size_t len, cap; struct Jest_JsonVal *elems; } as_arr;
+
+        struct {
+            size_t nfields, nalloced;
+            size_t *fn_lens; // field name lengths
+            char **field_names; // field names
+            struct Jest_JsonVal *field_values; // field values
+            uint64_t *index; // hash index over the field names, NULL for small objects
+        } as_obj;
+
+        Jest_Error as_err;
+    } v;
+} Jest_JsonVal;
+
+// objects with at least this many fields get a hash index for field lookups
+#ifndef JEST_OBJ_INDEX_THRESHOLD
+#   define JEST_OBJ_INDEX_THRESHOLD 16
+#endif // !JEST_OBJ_INDEX_THRESHOLD
+
+#ifndef JEST_ARENA_BLOCK_SIZE
+#   define JEST_ARENA_BLOCK_SIZE ((size_t)64 * 1024)
+#endif // !JEST_ARENA_BLOCK_SIZE
+
+// bump allocator, everything allocated from an arena is freed at once by Jest_destroyArena
+typedef struct Jest_Arena {
+    struct Jest__ArenaBlock *head;
+    struct Jest__ArenaBlock *spare; // emptied by Jest_arenaReset and handed out again before anything is malloc'd
+    size_t block_sz; // size of regular blocks, allocations larger than a quarter of this get their own block
+} Jest_Arena;
+
+// strings and field names without escapes point straight into the source instead of being copied,
+// these are not nul-terminated so the stored lengths have to be used
+#define JEST_DOC_ZEROCOPY 0x1u
+
+// equal field names share a single copy, so fields can be told apart by comparing pointers,
+// this takes precedence over JEST_DOC_ZEROCOPY for field names
+#define JEST_DOC_INTERN 0x2u
+
+// a json value along with the arena that all of its strings, arrays and objects are allocated from
+typedef struct Jest_Document {
+    Jest_JsonVal root;
+    Jest_Arena arena;
+
+    unsigned flags; // JEST_DOC_*, set after Jest_initDocument
+    char *source; // input that zero-copy strings point into, owned by the document
+    size_t source_mapped; // length of source when it's a memory-mapped file, 0 when it was malloc'd
+    struct Jest__InternTable *intern; // field names stored so far with JEST_DOC_INTERN, lives in the arena
+} Jest_Document;
+
+// parses one input after another, each parse recycles the memory of the one before so that
+// a steady stream of similarly shaped input stops allocating once the parser has warmed up
+typedef struct Jest_Parser {
+    Jest_Document doc; // doc.root is the result of the last parse and lives until the next one
+    Jest_Lexer lexer; // only its string buffer and max_depth are kept from one parse to the next
+} Jest_Parser;
+
+// one step of a compiled path, either a field lookup or an array index
+typedef struct Jest_PathStep {
+    const char *key; // NULL for array indices, not nul-terminated
+    size_t key_len;
+    uint64_t hash; // hash of key, so objects with an index don't have to rehash it on every lookup
+    size_t idx;
+} Jest_PathStep;
+
+// an accessor like ['a'][b][0] that has been parsed once by Jest_compilePath and can be resolved any number of times,
+// keys are strings or identifiers so [true], [false] and [null] are syntax errors just as they are in objects,
+// and an accessor the lexer can't start on, empty or only whitespace included, is JEST_ERROR_BADLEXER
+typedef struct Jest_Path {
+    Jest_PathStep *steps;
+    size_t nsteps;
+    char *keys; // storage that the keys of the steps point into
+} Jest_Path;
+
+// node of the prefix trie in a Jest_PathSet, links are node or path indices with (size_t)-1 for none
+typedef struct Jest__PathNode {
+    const Jest_PathStep *step; // step leading here from the parent, NULL for the root
+    size_t first_child, next_sibling;
+    size_t first_end; // first path that ends at this node
+} Jest__PathNode;
+
+// a batch of compiled paths that share the walk over their common prefixes
+typedef struct Jest_PathSet {
+    Jest_Path *paths;
+    size_t npaths;
+
+    Jest__PathNode *nodes; // nodes[0] is the root
+    size_t nnodes;
+    size_t *next_end; // next path ending at the same node as paths[i]
+} Jest_PathSet;
+
+// a value inside a source buffer that hasn't been decoded, looking things up in it
+// only walks the containers on the way and jumps over everything else
+typedef struct Jest_LazyVal {
+    Jest_JsonType type;
+    const char *src; // has to outlive the value and everything looked up through it
+    size_t start, end; // byte range of the value, a root container's range runs to the end of the source
+} Jest_LazyVal;
+
+// compact alternative to a tree of Jest_JsonVals, a value is a run of 64-bit entries with a type tag
+// in the top byte. containers are bracketed by an opening and a closing entry, the opening one holds
+// the position just past its closing entry so it can be skipped in one step, and the closing one holds
+// the number of elements. objects alternate key and value entries, numbers take a second entry with
+// the bits of the double, and strings hold an offset into strs where a size_t length, the bytes and a
+// nul terminator are stored
+typedef struct Jest_Tape {
+    uint64_t *entries;
+    size_t len, cap;
+
+    char *strs;
+    size_t strs_len, strs_cap;
+} Jest_Tape;
+
+// walks the elements of an array or the fields of an object on a tape
+typedef struct Jest_TapeIter {
+    const Jest_Tape *tape;
+    size_t key; // position of the current field name, only for objects
+    size_t pos; // position of the current value
+    size_t end; // position of the container's closing entry
+} Jest_TapeIter;
+
+// callbacks for the event based Jest_parseSax* functions, returning false stops parsing with JEST_ERROR_ABORTED
+// NULL callbacks are skipped, strings are only valid until the callback returns and aren't nul-terminated
+typedef struct Jest_SaxHandler {
+    bool (*begin_obj)(void *userdata);
+    bool (*end_obj)(void *userdata);
+    bool (*begin_arr)(void *userdata);
+    bool (*end_arr)(void *userdata);
+    bool (*key)(void *userdata, const char *str, size_t len);
+    bool (*str)(void *userdata, const char *str, size_t len);
+    bool (*num)(void *userdata, double val);
+    bool (*boolean)(void *userdata, bool val);
+    bool (*null)(void *userdata);
+} Jest_SaxHandler;
+
+// what the event parser expects from the next token
+enum Jest__SaxExpect {
+    JEST__SAX_VALUE,
+    JEST__SAX_VALUE_OR_END, // start of an array or after a comma in one
+    JEST__SAX_KEY,
+    JEST__SAX_KEY_OR_END, // start of an object or after a comma in one
+    JEST__SAX_COLON,
+    JEST__SAX_NEXT, // comma or the end of the current container
+    JEST__SAX_DONE
+};
+
+// state of the event parser, kept outside the call stack so it can be fed one token at a time
+typedef struct Jest__SaxState {
+    char *stack; // '[' or '{' for every open container
+    size_t depth, cap;
+    int expect; // Jest__SaxExpect
+} Jest__SaxState;
+
+// builds a tree out of Jest_SaxHandler events
+typedef struct Jest__DomBuilder {
+    Jest_JsonVal *out;
+
+    Jest_JsonVal *stack; // containers that are still open
+    char **keys; // the key each open container will be added to its parent under
+    size_t *key_lens;
+    size_t depth, cap;
+
+    char *key; // key of the next value in the innermost object
+    size_t key_len;
+} Jest__DomBuilder;
+
+// push parser for input that arrives in pieces, only the unfinished token at the end of a chunk is kept around
+typedef struct Jest_ChunkParser {
+    char *buf; // unconsumed input carried over between chunks
+    size_t len, cap;
+    size_t scanned; // how far into buf the unfinished token at its start has been looked at
+    char comment; // '/' or '*' while in a comment that hasn't ended yet, whose body is dropped as it comes in
+
+    Jest_Lexer lexer; // only its string buffer is kept from one chunk to the next
+
+    Jest__SaxState state;
+    const Jest_SaxHandler *handler;
+    void *userdata;
+    Jest__DomBuilder dom; // used by Jest_initChunkParserJson
+
+    Jest_Error err;
+} Jest_ChunkParser;
+
+// records of json lines input in input order, one value per line, field names are interned
+// like with JEST_DOC_INTERN but separately for every thread
+typedef struct Jest_JsonLines {
+    Jest_JsonVal *values; // blank and comment-only lines aren't records
+    Jest_Error *errors; // what went wrong with each record, records that failed are null
+    size_t count;
+    Jest_Arena arena; // holds everything, the arenas of the worker threads are spliced into it
+} Jest_JsonLines;
+
+// receives the records of json lines input in input order, val only lives until the callback returns,
+// returning false stops parsing with JEST_ERROR_ABORTED
+typedef bool (*Jest_JsonLineFn)(void *userdata, size_t idx, const Jest_JsonVal *val, Jest_Error err);
+
+// how much input each thread parses between two rounds of Jest_JsonLineFn callbacks
+#ifndef JEST_LINES_BATCH_SIZE
+#   define JEST_LINES_BATCH_SIZE ((size_t)4 * 1024 * 1024)
+#endif // !JEST_LINES_BATCH_SIZE
+
+// files at least this big are memory-mapped instead of read when parsing from a path
+#ifndef JEST_MMAP_THRESHOLD
+#   define JEST_MMAP_THRESHOLD ((size_t)64 * 1024)
+#endif // !JEST_MMAP_THRESHOLD
+
+// size of the chunks files are read in when they are streamed
+#ifndef JEST_READ_CHUNK_SIZE
+#   define JEST_READ_CHUNK_SIZE 65536
+#endif // !JEST_READ_CHUNK_SIZE
+
+// parsing on several threads gives each of them at least this many bytes, smaller inputs use fewer threads
+#ifndef JEST_PARALLEL_MIN_SLICE
+#   define JEST_PARALLEL_MIN_SLICE ((size_t)64 * 1024)
+#endif // !JEST_PARALLEL_MIN_SLICE
+
+// flags for the Jest_writeJson* functions
+#define JEST_WRITE_PRETTY 0x1u // indent with tabs like Jest_printJsonVal, compact otherwise
+#define JEST_WRITE_ESCAPE_UNICODE 0x2u // write non-ascii characters as \u escapes
+
+// size of the chunks handed to a Jest_WriteFn
+#ifndef JEST_WRITE_CHUNK_SIZE
+#   define JEST_WRITE_CHUNK_SIZE 4096
+#endif // !JEST_WRITE_CHUNK_SIZE
+
+// receives serialized json in chunks, returning false stops the writer with JEST_ERROR_IO
+typedef bool (*Jest_WriteFn)(void *userdata, const char *data, size_t len);
+
+#ifdef JEST_STATS
+// what the lexer, the parsers and the allocation helpers did on the calling thread since the last
+// Jest_resetStats, threads started by a parse add theirs when they finish, without JEST_STATS
+// none of the counting is compiled in
+typedef struct Jest_Stats {
+    // lexemes by type, punctuation being ':', ',' and the brackets
+    size_t tokens_punct;
+    size_t tokens_str;
+    size_t tokens_num; // Infinity and NaN included
+    size_t tokens_ident;
+    size_t tokens_bool;
+    size_t tokens_null;
+
+    size_t strings_clean; // used as they are in the input
+    size_t strings_escaped; // had escapes to decode
+
+    size_t allocs; // on the heap or in an arena
+    size_t reallocs;
+    size_t alloc_bytes; // asked for by allocations plus what reallocations grew by
+    size_t array_grows; // times an array ran out of room for its elements
+    size_t obj_grows; // same for an object's fields
+
+    size_t max_depth; // deepest nesting of containers parsed
+
+    // cpu seconds of the thread as far as the platform can tell, what worker threads spent is added on
+    double read_time; // reading whole files, mapped files are only paged in while they're parsed
+    double parse_time; // spent in any parse function, the outermost one when they call each other
+    double write_time; // serializing values
+} Jest_Stats;
+#endif // JEST_STATS
+
+bool Jest_signbit(double x);
+bool Jest_isnan(double x);
+bool Jest_isinf(double x);
+
+char *Jest_strndup(const char *str, size_t len);
+char *Jest_dblToStr(char *buffer, size_t bufsz, double x);
+char *Jest_boolToStr(char *buffer, size_t bufsz, bool b);
+size_t Jest_readEntireFileFromPath(char **out, const char *path);
+size_t Jest_readEntireFile(char **out, FILE *file);
+bool Jest_initLexer(Jest_Lexer *l, char *strbuf, size_t strbuf_sz, const char *filebuf, size_t filebuf_sz);
+bool Jest_lexerStep(Jest_Lexer *l);
+void Jest_destroyLexer(Jest_Lexer *l);
+
+Jest_Error Jest_jsonArrayAppend(Jest_JsonVal *arr, const Jest_JsonVal *elem);
+Jest_Error Jest_jsonObjAdd(Jest_JsonVal *obj, const char *field_name, Jest_JsonVal value);
+Jest_Error Jest_parseJsonLexer(Jest_JsonVal *out, Jest_Lexer *lexer);
+Jest_Error Jest_parseJsonFile(Jest_JsonVal *out, FILE *file);
+Jest_Error Jest_parseJsonFileFromPath(Jest_JsonVal *out, const char *path);
+Jest_Error Jest_parseJsonFromStr(Jest_JsonVal *out, const char *str);
+Jest_Error Jest_parseJsonFromBuf(Jest_JsonVal *out, const char *buf, size_t len);
+
+void Jest_printJsonVal(FILE *file, const Jest_JsonVal *val, bool escape_unicode);
+Jest_Error Jest_writeJsonToBuffer(char **out, size_t *opt_len_out, const Jest_JsonVal *val, unsigned flags);
+Jest_Error Jest_writeJsonToCallback(Jest_WriteFn write_fn, void *userdata, const Jest_JsonVal *val, unsigned flags);
+void Jest_destroyJsonVal(Jest_JsonVal *val);
+
+Jest_JsonVal *Jest_jsonIdx(Jest_JsonVal *parent, const char *accessor, Jest_Error *opt_err_out);
+
+Jest_Error Jest_compilePath(Jest_Path *path, const char *accessor);
+Jest_JsonVal *Jest_pathResolve(const Jest_Path *path, Jest_JsonVal *root, Jest_Error *opt_err_out);
+void Jest_destroyPath(Jest_Path *path);
+
+Jest_Error Jest_compilePathSet(Jest_PathSet *set, const char *const *accessors, size_t naccessors);
+void Jest_pathSetResolve(const Jest_PathSet *set, Jest_JsonVal *root, Jest_JsonVal **out);
+Jest_Error Jest_pathSetExtract(const Jest_PathSet *set, Jest_Lexer *lexer, Jest_JsonVal *out);
+void Jest_destroyPathSet(Jest_PathSet *set);
+
+Jest_Error Jest_lazyRoot(Jest_LazyVal *out, const char *src, size_t src_len);
+Jest_Error Jest_lazyField(Jest_LazyVal *out, const Jest_LazyVal *obj, const char *field_name);
+Jest_Error Jest_lazyIdx(Jest_LazyVal *out, const Jest_LazyVal *arr, size_t idx);
+Jest_Error Jest_lazyPath(Jest_LazyVal *out, const Jest_LazyVal *root, const Jest_Path *path);
+Jest_Error Jest_lazyDecode(Jest_JsonVal *out, const Jest_LazyVal *val);
+
+Jest_Error Jest_parseTapeLexer(Jest_Tape *tape, Jest_Lexer *lexer);
+Jest_Error Jest_tapeFromJsonVal(Jest_Tape *tape, const Jest_JsonVal *val);
+Jest_Error Jest_tapeToJsonVal(Jest_JsonVal *out, const Jest_Tape *tape, size_t pos);
+Jest_JsonType Jest_tapeType(const Jest_Tape *tape, size_t pos);
+size_t Jest_tapeSkip(const Jest_Tape *tape, size_t pos);
+size_t Jest_tapeCount(const Jest_Tape *tape, size_t pos);
+bool Jest_tapeBool(const Jest_Tape *tape, size_t pos);
+double Jest_tapeNum(const Jest_Tape *tape, size_t pos);
+const char *Jest_tapeStr(const Jest_Tape *tape, size_t pos, size_t *opt_len_out);
+size_t Jest_tapeField(const Jest_Tape *tape, size_t pos, const char *field_name);
+bool Jest_tapeIterBegin(Jest_TapeIter *it, const Jest_Tape *tape, size_t pos);
+bool Jest_tapeIterNext(Jest_TapeIter *it);
+void Jest_destroyTape(Jest_Tape *tape);
+
+Jest_Error Jest_parseSaxLexer(Jest_Lexer *lexer, const Jest_SaxHandler *handler, void *userdata);
+Jest_Error Jest_parseSaxFile(FILE *file, const Jest_SaxHandler *handler, void *userdata);
+Jest_Error Jest_parseSaxFromPath(const char *path, const Jest_SaxHandler *handler, void *userdata);
+
+Jest_Error Jest_initChunkParser(Jest_ChunkParser *p, const Jest_SaxHandler *handler, void *userdata);
+Jest_Error Jest_initChunkParserJson(Jest_ChunkParser *p, Jest_JsonVal *out);
+Jest_Error Jest_chunkParserFeed(Jest_ChunkParser *p, const char *chunk, size_t len);
+Jest_Error Jest_chunkParserFinish(Jest_ChunkParser *p);
+void Jest_destroyChunkParser(Jest_ChunkParser *p);
+
+Jest_Error Jest_parseJsonLines(Jest_JsonLines *out, const char *buf, size_t len, unsigned nthreads);
+Jest_Error Jest_parseJsonLinesCallback(const char *buf, size_t len, unsigned nthreads, Jest_JsonLineFn fn, void *userdata);
+Jest_Error Jest_parseJsonLinesFromPath(const char *path, unsigned nthreads, Jest_JsonLineFn fn, void *userdata);
+void Jest_destroyJsonLines(Jest_JsonLines *lines);
+
+void Jest_initArena(Jest_Arena *arena, size_t block_sz);
+void *Jest_arenaAlloc(Jest_Arena *arena, size_t sz);
+void Jest_arenaReset(Jest_Arena *arena);
+void Jest_destroyArena(Jest_Arena *arena);
+
+void Jest_initDocument(Jest_Document *doc);
+Jest_Error Jest_parseDocumentLexer(Jest_Document *doc, Jest_Lexer *lexer);
+Jest_Error Jest_parseDocumentFile(Jest_Document *doc, FILE *file);
+Jest_Error Jest_parseDocumentFromPath(Jest_Document *doc, const char *path);
+Jest_Error Jest_parseDocumentFromBuf(Jest_Document *doc, const char *buf, size_t len);
+Jest_Error Jest_parseDocumentInSitu(Jest_Document *doc, char *buf, size_t len);
+Jest_Error Jest_parseDocumentParallel(Jest_Document *doc, const char *buf, size_t len, unsigned nthreads);
+Jest_Error Jest_docArrayAppend(Jest_Document *doc, Jest_JsonVal *arr, const Jest_JsonVal *elem);
+Jest_Error Jest_docObjAdd(Jest_Document *doc, Jest_JsonVal *obj, const char *field_name, Jest_JsonVal value);
+Jest_JsonVal Jest_docString(Jest_Document *doc, const char *val);
+void Jest_destroyDocument(Jest_Document *doc);
+
+void Jest_initParser(Jest_Parser *p);
+Jest_Error Jest_parserParse(Jest_Parser *p, const char *buf, size_t len);
+Jest_Error Jest_parserParseInSitu(Jest_Parser *p, char *buf, size_t len);
+void Jest_destroyParser(Jest_Parser *p);
+
+#ifdef JEST_STATS
+void Jest_getStats(Jest_Stats *out);
+void Jest_resetStats(void);
+#endif // JEST_STATS
+
+static inline Jest_JsonVal Jest_jsonNull(void)
+{
+    Jest_JsonVal out;
+    out.type = JEST_JSONTYPE_NULL;
+    out.flags = 0;
+    return out;
+}
+
+static inline Jest_JsonVal Jest_jsonBool(bool val)
+{
+    Jest_JsonVal out;
+    out.type = JEST_JSONTYPE_BOOL;
+    out.flags = 0;
+    out.v.as_bool = val;
+    return out;
+}
+
+static inline Jest_JsonVal Jest_jsonNumber(double val)
+{
+    Jest_JsonVal out;
+    out.type = JEST_JSONTYPE_NUM;
+    out.flags = 0;
+    out.v.as_num = val;
+    return out;
+}
+
+static inline Jest_JsonVal Jest_jsonString(const char *val)
+{
+    Jest_JsonVal out;
+    out.type = JEST_JSONTYPE_STR;
+    out.flags = 0;
+    out.v.as_str.len = strlen(val);
+    out.v.as_str.data = Jest_strndup(val, out.v.as_str.len);
+    return out;
+}
+
+static inline Jest_JsonVal Jest_jsonArray(void)
+{
+    Jest_JsonVal out;
+    out.type = JEST_JSONTYPE_ARR;
+    out.flags = 0;
+    memset(&out.v, 0, sizeof(out.v));
+    return out;
+}
+
+static inline Jest_JsonVal Jest_jsonObj(void)
+{
+    Jest_JsonVal out;
+    out.type = JEST_JSONTYPE_OBJ;
+    out.flags = 0;
+    memset(&out.v, 0, sizeof(out.v));
+    return out;
+}
+
+#endif // !JEST_H_
+
+#ifdef JEST_IMPL
+
+// simd kernels for the lexer, picked at runtime with a scalar fallback
+#if !defined(JEST_NO_SIMD) && defined(__GNUC__) && defined(__x86_64__)
+#   define JEST__SIMD_X86 1
+#   include <immintrin.h>
+#endif
+
+// files given by path are memory-mapped where possible
+#if !defined(JEST_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#   define JEST__MMAP 1
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+// json lines are parsed on a pthread pool where available and serially otherwise
+#if !defined(JEST_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#   define JEST__THREADS 1
+#   include <pthread.h>
+#   include <unistd.h>
+#endif
+
+// numbers that need strtod are read in the "C" locale whatever LC_NUMERIC says, through strtod_l where it's declared
+// and by swapping in the current locale's decimal point otherwise
+#include <locale.h>
+#if defined(_MSC_VER)
+#   define JEST__STRTOD_L(str, end, loc) _strtod_l((str), (end), (loc))
+#   define JEST__NEWLOCALE_C() _create_locale(LC_NUMERIC, "C")
+typedef _locale_t Jest__Locale;
+#elif defined(__APPLE__) || (defined(__GLIBC__) && defined(_GNU_SOURCE))
+#   define JEST__STRTOD_L(str, end, loc) strtod_l((str), (end), (loc))
+#   define JEST__NEWLOCALE_C() newlocale(LC_NUMERIC_MASK, "C", (locale_t)0)
+#   ifdef __APPLE__
+#       include <xlocale.h>
+#   endif // __APPLE__
+typedef locale_t Jest__Locale;
+#endif
+
+// Jest_Stats are counted per thread, JEST__STAT compiles to nothing without JEST_STATS
+#ifdef JEST_STATS
+#   include <time.h>
+#   if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#       define JEST__THREAD_LOCAL _Thread_local
+#   elif defined(__GNUC__)
+#       define JEST__THREAD_LOCAL __thread
+#   elif defined(_MSC_VER)
+#       define JEST__THREAD_LOCAL __declspec(thread)
+#   else
+#       define JEST__THREAD_LOCAL
+#   endif
+
+static JEST__THREAD_LOCAL Jest_Stats Jest__stats;
+static JEST__THREAD_LOCAL unsigned Jest__statParsing; // parse functions the thread is inside of, only the outermost is timed
+
+// times come from the calling thread's own cpu clock where there is one, a monotonic clock or clock() otherwise
+#   if defined(CLOCK_THREAD_CPUTIME_ID)
+#       define JEST__STAT_CLOCK CLOCK_THREAD_CPUTIME_ID
+#   elif defined(CLOCK_MONOTONIC)
+#       define JEST__STAT_CLOCK CLOCK_MONOTONIC
+#   endif
+
+static double Jest__statNow(void); // seconds since some fixed point
+static double Jest__statSince(double start); // seconds since start
+static void Jest__statToken(Jest_LexemeType type);
+static void Jest__statDepth(size_t depth);
+#   ifdef JEST__THREADS
+static void Jest__statMerge(Jest_Stats *dst, const Jest_Stats *src); // adds what a worker thread counted
+#   endif // JEST__THREADS
+
+#   define JEST__STAT(stmt) do { stmt; } while (0)
+#   define JEST__STAT_START(name) const double name = Jest__statNow()
+#   define JEST__STAT_PARSE_START(name) JEST__STAT_START(name); ++Jest__statParsing
+#   define JEST__STAT_PARSE_END(name) do { if (!--Jest__statParsing) Jest__stats.parse_time += Jest__statSince(name); } while (0)
+#else
+#   define JEST__STAT(stmt) ((void)0)
+#   define JEST__STAT_START(name)
+#   define JEST__STAT_PARSE_START(name)
+#   define JEST__STAT_PARSE_END(name) ((void)0)
+#endif // JEST_STATS
+
+// contents of a file, either mapped into memory or read into a malloc'd buffer
+typedef struct Jest__FileBuf {
+    char *data;
+    size_t len;
+    bool mapped;
+} Jest__FileBuf;
+
+static Jest_Error Jest__loadFile(Jest__FileBuf *fb, const char *path);
+static void Jest__releaseFile(Jest__FileBuf *fb);
+
+// helper functions for lexers
+static bool Jest__isWhiteSpace(char c);
+static bool Jest__hexDigit(char c, uint32_t *out);
+static bool Jest__parseHex(const char *buf, size_t offset, size_t end, size_t ndigits, uint32_t *out);
+static double Jest__strtodToken(const char *token, size_t len);
+#ifdef JEST__STRTOD_L
+static void Jest__initCLocale(void);
+#endif // JEST__STRTOD_L
+static size_t Jest__parseNumber(const char *buf, size_t offset, size_t end, double *out);
+static void Jest__lexerSkipCommentAndWhiteSpace(Jest_Lexer *l);
+static Jest_Error Jest__lexerHandleStr(Jest_Lexer *l);
+static bool Jest__lexerReserve(Jest_Lexer *l, size_t extra);
+static char *Jest__lexerStrDst(Jest_Lexer *l, char *insitu, size_t extra); // where decoded string bytes go
+static void Jest__lexerRewind(Jest_Lexer *l, const char *buf, size_t len); // keeps the string buffer
+
+// character classes of every byte, so lexing doesn't depend on the locale or call into ctype
+#define JEST__CC_SPACE 0x1u // what isspace matches in the "C" locale
+#define JEST__CC_IDENT 0x2u // continues an identifier, ascii letters, digits, '_' and '$'
+#define JEST__CC_WORD 0x4u // part of an unquoted token, identifier characters plus '.', '+' and '-'
+#define JEST__CC_STRUCT 0x8u // what Jest__lexerSkipContainer stops at, brackets, ',', quotes and '/'
+
+static const unsigned char Jest__charClass[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, // 0x00
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x10
+    1, 0, 8, 0, 6, 0, 0, 8, 0, 0, 0, 4, 8, 4, 4, 8, // 0x20
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 0, 0, 0, 0, 0, 0, // 0x30
+    0, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, // 0x40
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 8, 0, 8, 0, 6, // 0x50
+    0, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, // 0x60
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 8, 0, 8, 0, 0, // 0x70
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x80
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x90
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xa0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xb0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xc0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xd0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xe0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  // 0xf0
+};
+
+// what Jest_lexerStep does with the first byte of a token
+enum Jest__TokenStart {
+    JEST__TOK_ERR, // nothing can start with it
+    JEST__TOK_PUNCT, // the byte is the lexeme type
+    JEST__TOK_STR,
+    JEST__TOK_IDENT,
+    JEST__TOK_NUM
+};
+
+static const unsigned char Jest__tokenStart[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x00
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x10
+    0, 0, 2, 0, 3, 0, 0, 2, 0, 0, 0, 4, 1, 4, 4, 0, // 0x20
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 1, 0, 0, 0, 0, 0, // 0x30
+    0, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, // 0x40
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 0, 1, 0, 3, // 0x50
+    0, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, // 0x60
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 0, 1, 0, 0, // 0x70
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x80
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x90
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xa0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xb0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xc0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xd0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xe0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  // 0xf0
+};
+
+// state shared by the parsing helpers
+typedef struct Jest__ParseCtx {
+    Jest_Lexer *lexer;
+    Jest_Arena *arena; // NULL when values are allocated individually on the heap
+    bool zerocopy; // use strings without escapes straight from the lexer's filebuf
+    struct Jest__InternTable **intern; // NULL unless field names are interned, created on first use
+} Jest__ParseCtx;
+
+// open addressing table of field names, a NULL name marks an empty slot
+typedef struct Jest__InternSlot {
+    char *name;
+    size_t len;
+    uint64_t hash;
+} Jest__InternSlot;
+
+typedef struct Jest__InternTable {
+    Jest__InternSlot *slots;
+    size_t count, cap; // cap is a power of two
+} Jest__InternTable;
+
+// the stored copy of name, which is added to the table when it isn't there yet
+static char *Jest__internKey(Jest_Arena *arena, Jest__InternTable **table, const char *name, size_t len);
+
+// Jest__strndup unless zero-copy parsing lets the lexer's current string be used in place
+static char *Jest__lexerStrDup(Jest__ParseCtx *ctx, const char *str, size_t len);
+
+// allocation helpers that use the arena when there is one and the heap otherwise
+static void *Jest__alloc(Jest_Arena *arena, size_t sz);
+static void *Jest__realloc(Jest_Arena *arena, void *ptr, size_t old_sz, size_t new_sz);
+static void Jest__free(Jest_Arena *arena, void *ptr);
+static char *Jest__strndup(Jest_Arena *arena, const char *str, size_t len);
+static void *Jest__arenaAllocAligned(Jest_Arena *arena, size_t sz, size_t align);
+static struct Jest__ArenaBlock *Jest__arenaSpare(Jest_Arena *arena, size_t sz);
+static void *Jest__arenaRealloc(Jest_Arena *arena, void *ptr, size_t old_sz, size_t new_sz);
+
+// helpers for the hash index of objects
+static uint64_t Jest__hashStr(const char *str, size_t len);
+static size_t Jest__objIndexCap(size_t nalloced);
+static void Jest__objIndexInsert(Jest_JsonVal *obj, size_t field, uint64_t hash);
+static Jest_Error Jest__objBuildIndex(Jest_Arena *arena, Jest_JsonVal *obj);
+static size_t Jest__objFind(const Jest_JsonVal *obj, const char *name, size_t name_len, uint64_t hash);
+
+// Jest_jsonArrayAppend and Jest_jsonObjAdd, the object takes ownership of field_name
+static Jest_Error Jest__arrayAppend(Jest_Arena *arena, Jest_JsonVal *arr, const Jest_JsonVal *elem);
+static Jest_Error Jest__objAdd(Jest_Arena *arena, Jest_JsonVal *obj, char *field_name, size_t name_len, Jest_JsonVal value);
+
+// helpers for compiled paths, links in the trie are (size_t)-1 when there's nothing there
+#define JEST__PATH_NONE ((size_t)-1)
+static Jest_JsonVal *Jest__pathStepApply(const Jest_PathStep *step, Jest_JsonVal *val);
+static Jest_Error Jest__pathSetWalk(const Jest_PathSet *set, size_t node, Jest_JsonVal *val, Jest_JsonVal **ptr_out, Jest_JsonVal *copy_out);
+static void Jest__pathSetForget(const Jest_PathSet *set, size_t node, Jest_JsonVal *out);
+static Jest_Error Jest__pathSetExtractNode(const Jest_PathSet *set, size_t node, Jest_Lexer *l, Jest_JsonVal *out);
+static Jest_Error Jest__lexerSkipVal(Jest_Lexer *l);
+
+// deep copies, scalars and strings are copied whole while containers come out empty
+static Jest_Error Jest__cloneShallow(Jest_JsonVal *out, const Jest_JsonVal *src);
+static Jest_Error Jest__cloneJsonVal(Jest_JsonVal *out, const Jest_JsonVal *src);
+
+// helpers for lazy values, the lexer is set up over the source without stepping
+static void Jest__lazyLexer(Jest_Lexer *l, char *strbuf, size_t strbuf_sz, const Jest_LazyVal *val, size_t offset);
+static bool Jest__lexerSkipContainer(Jest_Lexer *l, size_t *cuts, size_t ncuts);
+static Jest_Error Jest__lazyNext(Jest_Lexer *l, Jest_LazyVal *out);
+static Jest_Error Jest__lazyField(Jest_LazyVal *out, const Jest_LazyVal *obj, const char *name, size_t name_len);
+
+// tape entries, the tag is one of n t f d " { } [ ] and the payload takes the remaining 56 bits
+#define JEST__TAPE_ENTRY(tag, payload) (((uint64_t)(uint8_t)(tag) << 56) | (uint64_t)(payload))
+#define JEST__TAPE_TAG(entry) ((char)((entry) >> 56))
+#define JEST__TAPE_PAYLOAD(entry) ((size_t)((entry) & UINT64_C(0x00ffffffffffffff)))
+
+// builds a tape out of Jest_SaxHandler events
+typedef struct Jest__TapeBuilder {
+    Jest_Tape *tape;
+    size_t *stack; // opening entry and element count of every open container
+    size_t depth, cap;
+    Jest_Error err;
+} Jest__TapeBuilder;
+
+static bool Jest__tapePush(Jest_Tape *tape, char tag, size_t payload);
+static Jest_Error Jest__tapeAppendVal(Jest_Tape *tape, const Jest_JsonVal *val);
+static Jest_Error Jest__tapeShallow(Jest_JsonVal *out, const Jest_Tape *tape, size_t pos);
+static bool Jest__tapePushStr(Jest_Tape *tape, const char *str, size_t len);
+static bool Jest__tapePushNum(Jest_Tape *tape, double val);
+static bool Jest__tapeBuilderBegin(Jest__TapeBuilder *b, char tag);
+static bool Jest__tapeBuilderEnd(Jest__TapeBuilder *b, char tag);
+static void Jest__tapeBuilderValue(Jest__TapeBuilder *b);
+static bool Jest__tapeBeginObj(void *userdata);
+static bool Jest__tapeEndObj(void *userdata);
+static bool Jest__tapeBeginArr(void *userdata);
+static bool Jest__tapeEndArr(void *userdata);
+static bool Jest__tapeKey(void *userdata, const char *str, size_t len);
+static bool Jest__tapeStr(void *userdata, const char *str, size_t len);
+static bool Jest__tapeNum(void *userdata, double val);
+static bool Jest__tapeBool(void *userdata, bool val);
+static bool Jest__tapeNull(void *userdata);
+
+
+// helper functions for parsing individual pieces of data
+static Jest_Error Jest__parseVal(Jest_JsonVal *out, Jest__ParseCtx *ctx);
+static Jest_Error Jest__parseNull(Jest_JsonVal *out, Jest__ParseCtx *ctx);
+static Jest_Error Jest__parseBool(Jest_JsonVal *out, Jest__ParseCtx *ctx);
+static Jest_Error Jest__parseNum(Jest_JsonVal *out, Jest__ParseCtx *ctx);
+static Jest_Error Jest__parseStr(Jest_JsonVal *out, Jest__ParseCtx *ctx);
+
+// containers are walked with an explicit stack that starts out in a local array of this many frames
+#define JEST__LOCAL_FRAMES 32
+
+// a container the parser is still filling, along with the name it goes under in its parent
+typedef struct Jest__ParseFrame {
+    Jest_JsonVal val;
+    char *name;
+    size_t name_len;
+} Jest__ParseFrame;
+
+// a container that is partway through being destroyed or written
+typedef struct Jest__WalkFrame {
+    const Jest_JsonVal *val;
+    size_t idx;
+} Jest__WalkFrame;
+
+// a container that is partway through being copied into dst
+typedef struct Jest__CloneFrame {
+    const Jest_JsonVal *src;
+    Jest_JsonVal *dst;
+    size_t idx;
+} Jest__CloneFrame;
+
+// doubles the capacity of an explicit stack, moving it to the heap the first time, NULL when out of memory
+static void *Jest__growStack(void *stack, const void *local, size_t *cap, size_t elem_sz);
+
+// shortest representation of a double that reads back as the same value (grisu2), returns the length
+static size_t Jest__writeDouble(char *buffer, double x);
+
+static void Jest__initSaxState(Jest__SaxState *state);
+static Jest_Error Jest__saxPush(Jest__SaxState *state, char container, size_t max_depth);
+static Jest_Error Jest__saxFeed(Jest__SaxState *state, const Jest_Lexer *l, const Jest_SaxHandler *h, void *userdata);
+
+// lexes and feeds every complete token of src, returns how much of it was consumed
+static bool Jest__isIdentChar(char c);
+static bool Jest__chunkTokenEnds(const char *src, size_t start, size_t src_len, size_t *scanned);
+static bool Jest__chunkCommentEnds(const char *src, size_t *offset, size_t src_len, char kind);
+static size_t Jest__chunkParserRun(Jest_ChunkParser *p, const char *src, size_t src_len, bool final);
+
+// Jest_SaxHandler callbacks that build a tree with a Jest__DomBuilder as userdata
+static bool Jest__domAdd(Jest__DomBuilder *dom, Jest_JsonVal val);
+static bool Jest__domBegin(Jest__DomBuilder *dom, Jest_JsonVal container);
+static bool Jest__domBeginObj(void *userdata);
+static bool Jest__domBeginArr(void *userdata);
+static bool Jest__domEnd(void *userdata);
+static bool Jest__domKey(void *userdata, const char *str, size_t len);
+static bool Jest__domStr(void *userdata, const char *str, size_t len);
+static bool Jest__domNum(void *userdata, double val);
+static bool Jest__domBool(void *userdata, bool val);
+static bool Jest__domNull(void *userdata);
+
+// one thread's share of the input, everything it parses goes into its own arena
+typedef struct Jest__ParseWorker {
+    void (*run)(struct Jest__ParseWorker *w); // Jest__linesWorkerRun or Jest__elemsWorkerRun
+    const char *buf;
+    size_t len;
+    unsigned flags; // JEST_DOC_* of the document the slice goes into
+
+    Jest_Arena arena;
+    Jest__InternTable *intern;
+    Jest_Lexer lexer; // pointed at one piece after another so its string buffer is reused
+
+    Jest_JsonVal *values;
+    Jest_Error *errors;
+    size_t count, cap;
+
+    Jest_Error err; // only set when the worker runs out of memory
+
+#ifdef JEST_STATS
+    Jest_Stats stats; // what the worker's own thread counted, added to the caller's after the join
+#endif // JEST_STATS
+} Jest__ParseWorker;
+
+// helpers for parsing on several threads, boundaries are the offsets just past a newline
+static void Jest__arenaSplice(Jest_Arena *dst, Jest_Arena *src);
+static Jest_Error Jest__reinternNames(Jest_Arena *arena, Jest__InternTable **table, Jest_JsonVal *val);
+static size_t Jest__linesBoundary(const char *buf, size_t len, size_t off);
+static unsigned Jest__workerThreads(unsigned nthreads, size_t len);
+static void Jest__linesWorkerRun(Jest__ParseWorker *w);
+static void Jest__elemsWorkerRun(Jest__ParseWorker *w);
+static void Jest__runWorkers(Jest__ParseWorker *workers, unsigned n);
+static void Jest__resetWorker(Jest__ParseWorker *w);
+static Jest_Error Jest__parseElemsParallel(Jest_Document *doc, Jest_Lexer *l, unsigned n); // l is on the opening bracket
+
+// output buffer shared by Jest_printJsonVal and the Jest_writeJson* functions
+typedef struct Jest__Writer {
+    Jest_WriteFn write_fn; // NULL when everything is kept in buf
+    void *userdata;
+
+    char *buf;
+    size_t len, cap;
+
+    unsigned flags; // JEST_WRITE_*
+    Jest_Error err;
+} Jest__Writer;
+
+static void Jest__writerPut(Jest__Writer *w, const char *data, size_t len);
+static void Jest__writerPutc(Jest__Writer *w, char c);
+static void Jest__writerTabs(Jest__Writer *w, int ntabs);
+static void Jest__writeStr(Jest__Writer *w, const char *data, size_t len);
+static bool Jest__fileWriteFn(void *userdata, const char *data, size_t len);
+
+// serializes val, nested containers are indented with tabs when pretty printing
+static void Jest__writeJsonVal(Jest__Writer *w, const Jest_JsonVal *val);
+
+bool Jest_signbit(double x)
+{
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits >> 63;
+}
+
+bool Jest_isnan(double x)
+{
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    // 0xffe0000000000000 (infinity's bits shifted by one so that the sign bit can be ignored)
+    return bits << 1 > UINT64_C(0xffe0000000000000);
+}
+
+bool Jest_isinf(double x)
+{
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    // 0xffe0000000000000 (infinity's bits shifted by one so that the sign bit can be ignored)
+    return bits << 1 == UINT64_C(0xffe0000000000000);
+}
+
+char *Jest_strndup(const char *str, size_t len)
+{
+    if (!str) return NULL;
+
+    char *ret = (char *)calloc(len + 1, 1);
+    if (!ret) return NULL;
+
+    memcpy(ret, str, len);
+    return ret;
+}
+
+char *Jest_dblToStr(char *buffer, size_t bufsz, double x)
+{
+    if (!buffer || bufsz < 32) return NULL;
+
+    // Jest__writeDouble never writes more than 25 characters
+    buffer[Jest__writeDouble(buffer, x)] = '\0';
+    return buffer;
+}
+
+char *Jest_boolToStr(char *buffer, size_t bufsz, bool b)
+{
+    if (!buffer || bufsz < 6) return NULL;
+    // the size of the buffer is checked before strcpy is used so this is fine
+    // NOLINTNEXTLINE(clang-analyzer-security.insecureAPI.strcpy)
+    strcpy(buffer, (b)? "true" : "false");
+    return buffer;
+}
+
+size_t Jest_readEntireFile(char **out, FILE *file)
+{
+    if (!out || !file) return 0; 
+    *out = NULL;
+
+    JEST__STAT_START(start);
+
+    // the size is only a hint, pipes and the like can't seek and are read until they run dry
+    long fsize = -1;
+    if (!fseek(file, 0, SEEK_END)) {
+        fsize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+    }
+
+    // room for one byte past the expected end so a short read means eof, plus the nul terminator
+    size_t cap = (fsize > 0)? (size_t)fsize + 2 : JEST_READ_CHUNK_SIZE;
+    size_t len = 0;
+
+    char *buf = (char *)malloc(cap);
+    if (!buf) return 0;
+
+    for (;;) {
+        const size_t want = cap - len - 1;
+        const size_t got = fread(&buf[len], 1, want, file);
+        len += got;
+        if (got < want) break;
+
+        char *grown = (char *)realloc(buf, cap * 2);
+        if (!grown) {
+            free(buf);
+            return 0;
+        }
+
+        buf = grown;
+        cap *= 2;
+    }
+
+    if (!len || ferror(file)) {
+        free(buf);
+        return 0;
+    }
+
+    buf[len] = '\0';
+    *out = buf;
+
+    JEST__STAT(Jest__stats.read_time += Jest__statSince(start));
+    return len;
+}
+
+size_t Jest_readEntireFileFromPath(char **out, const char *path)
+{
+    if (!out || !path) return 0; 
+
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+
+    const size_t ret = Jest_readEntireFile(out, f);
+    fclose(f);
+
+    return ret;
+}
+
+bool Jest_initLexer(Jest_Lexer *l, char *strbuf, size_t strbuf_sz, const char *filebuf, size_t filebuf_sz)
+{
+    if (!l) return false;
+    memset(l, 0, sizeof(*l));
+
+    // strbuf is optional, the lexer allocates one itself once it decodes a string that doesn't fit
+    if ((!strbuf && strbuf_sz) || !filebuf || !filebuf_sz) return false;
+
+    l->strbuf = strbuf;
+    l->strbuf_sz = (strbuf)? strbuf_sz : 0;
+
+    l->filebuf = filebuf;
+    l->filebuf_sz = filebuf_sz;
+    l->filebuf_offset = 0;
+    l->max_depth = JEST_MAX_DEPTH;
+
+    return Jest_lexerStep(l);
+}
+
+bool Jest_lexerStep(Jest_Lexer *l)
+{
+    if (!l) return false;
+    l->type = JEST_LEXEME_ERR;
+
+    Jest__lexerSkipCommentAndWhiteSpace(l);
+    if (l->filebuf_offset >= l->filebuf_sz) {
+        l->type = JEST_LEXEME_EOF;
+        return false;
+    }
+
+    const unsigned char c = (unsigned char)l->filebuf[l->filebuf_offset];
+    switch (Jest__tokenStart[c]) {
+        case JEST__TOK_PUNCT: goto lbl_punct;
+        case JEST__TOK_STR: goto lbl_str;
+        case JEST__TOK_IDENT: goto lbl_ident;
+        case JEST__TOK_NUM: goto lbl_num;
+        default: return false;
+    }
+
+lbl_punct:
+    l->type = c;
+    ++l->filebuf_offset;
+    JEST__STAT(++Jest__stats.tokens_punct);
+    return true;
+
+lbl_ident:
+    l->type = JEST_LEXEME_IDENT;
+    l->ident_start = l->filebuf_offset++;
+
+    while (l->filebuf_offset < l->filebuf_sz && Jest__charClass[(unsigned char)l->filebuf[l->filebuf_offset]] & JEST__CC_IDENT) {
+        ++l->filebuf_offset;
+    }
+
+    l->ident_len = l->filebuf_offset - l->ident_start;
+
+    // keywords only match whole identifiers, only true and null share a length
+    const char *ident = &l->filebuf[l->ident_start];
+    switch (l->ident_len) {
+        case 3:
+            if (!memcmp(ident, "NaN", 3)) {
+                l->type = JEST_LEXEME_NUM;
+                l->numval = JEST_NAN;
+            }
+            break;
+        case 4:
+            if (!memcmp(ident, "true", 4)) {
+                l->type = JEST_LEXEME_BOOL;
+                l->boolval = true;
+            } else if (!memcmp(ident, "null", 4)) {
+                l->type = JEST_LEXEME_NULL;
+            }
+            break;
+        case 5:
+            if (!memcmp(ident, "false", 5)) {
+                l->type = JEST_LEXEME_BOOL;
+                l->boolval = false;
+            }
+            break;
+        case 8:
+            if (!memcmp(ident, "Infinity", 8)) {
+                l->type = JEST_LEXEME_NUM;
+                l->numval = JEST_INF;
+            }
+            break;
+        default: break;
+    }
+
+    JEST__STAT(Jest__statToken(l->type));
+    return true;
+
+lbl_num:
+    {
+        const size_t end = Jest__parseNumber(l->filebuf, l->filebuf_offset, l->filebuf_sz, &l->numval);
+        if (end == l->filebuf_offset) return false;
+
+        l->filebuf_offset = end;
+        l->type = JEST_LEXEME_NUM;
+        JEST__STAT(++Jest__stats.tokens_num);
+        return true;
+    }
+
+lbl_str:
+    if (Jest__lexerHandleStr(l)) {
+        l->type = JEST_LEXEME_ERR;
+        return false;
+    }
+
+    JEST__STAT(++Jest__stats.tokens_str);
+    return true;
+}
+
+void Jest_destroyLexer(Jest_Lexer *l)
+{
+    if (!l) return;
+
+    if (l->strbuf_owned) free(l->strbuf);
+    l->strbuf = NULL;
+    l->strbuf_sz = 0;
+    l->strbuf_owned = false;
+}
+
+Jest_Error Jest_jsonArrayAppend(Jest_JsonVal *arr, const Jest_JsonVal *elem)
+{
+    if (!arr || arr->flags & JEST_JSONFLAG_ARENA) return JEST_ERROR_BADPARAM;
+    return Jest__arrayAppend(NULL, arr, elem);
+}
+
+Jest_Error Jest_jsonObjAdd(Jest_JsonVal *obj, const char *field_name, Jest_JsonVal value)
+{
+    if (!obj || !field_name || obj->flags & JEST_JSONFLAG_ARENA) return JEST_ERROR_BADPARAM;
+    if (obj->type != JEST_JSONTYPE_OBJ) return JEST_ERROR_BADPARAM;
+
+    const size_t name_len = strlen(field_name);
+    char *name = Jest_strndup(field_name, name_len);
+    if (!name) return JEST_ERROR_NOMEM;
+
+    return Jest__objAdd(NULL, obj, name, name_len, value);
+}
+
+Jest_Error Jest_parseJsonLexer(Jest_JsonVal *out, Jest_Lexer *lexer)
+{
+    if (!out || !lexer) return JEST_ERROR_BADPARAM;
+
+    JEST__STAT_PARSE_START(start);
+    Jest__ParseCtx ctx = {lexer, NULL, false, NULL};
+    const Jest_Error ret = Jest__parseVal(out, &ctx);
+
+    JEST__STAT_PARSE_END(start);
+    return ret;
+}
+
+Jest_Error Jest_parseJsonFile(Jest_JsonVal *out, FILE *file)
+{
+    if (!out || !file) return JEST_ERROR_BADPARAM;
+
+    char *filebuf = NULL;
+    size_t filebuf_sz = Jest_readEntireFile(&filebuf, file);
+    if (!filebuf || !filebuf_sz) return JEST_ERROR_IO;
+
+    const Jest_Error ret = Jest_parseJsonFromBuf(out, filebuf, filebuf_sz);
+    free(filebuf);
+    return ret;
+}
+
+Jest_Error Jest_parseJsonFileFromPath(Jest_JsonVal *out, const char *path)
+{
+    if (!out || !path) return JEST_ERROR_BADPARAM; 
+
+    Jest__FileBuf fb;
+    Jest_Error ret = Jest__loadFile(&fb, path);
+    if (ret) return ret;
+
+    ret = Jest_parseJsonFromBuf(out, fb.data, fb.len);
+    Jest__releaseFile(&fb);
+    return ret;
+}
+
+Jest_Error Jest_parseJsonFromStr(Jest_JsonVal *out, const char *str)
+{
+    if (!out || !str) return JEST_ERROR_BADPARAM;
+    return Jest_parseJsonFromBuf(out, str, strlen(str));
+}
+
+Jest_Error Jest_parseJsonFromBuf(Jest_JsonVal *out, const char *buf, size_t len)
+{
+    if (!out || !buf) return JEST_ERROR_BADPARAM;
+
+    // the buffer doesn't need to be nul-terminated, the lexer never reads past len
+    Jest_Lexer l;
+    if (!Jest_initLexer(&l, NULL, 0, buf, len)) {
+        Jest_destroyLexer(&l);
+        return JEST_ERROR_BADLEXER;
+    }
+
+    const Jest_Error ret = Jest_parseJsonLexer(out, &l);
+    Jest_destroyLexer(&l);
+    return ret;
+}
+
+void Jest_printJsonVal(FILE *file, const Jest_JsonVal *val, bool escape_unicode)
+{
+    if (!file || !val) return;
+    Jest_writeJsonToCallback(Jest__fileWriteFn, file, val, JEST_WRITE_PRETTY | ((escape_unicode)? JEST_WRITE_ESCAPE_UNICODE : 0));
+}
+
+Jest_Error Jest_writeJsonToBuffer(char **out, size_t *opt_len_out, const Jest_JsonVal *val, unsigned flags)
+{
+    if (!out || !val) return JEST_ERROR_BADPARAM;
+
+    Jest__Writer w;
+    memset(&w, 0, sizeof(w));
+    w.flags = flags;
+
+    Jest__writeJsonVal(&w, val);
+    Jest__writerPutc(&w, '\0');
+
+    if (w.err) {
+        free(w.buf);
+        return w.err;
+    }
+
+    *out = w.buf;
+    if (opt_len_out) *opt_len_out = w.len - 1;
+    return JEST_ERROR_NONE;
+}
+
+Jest_Error Jest_writeJsonToCallback(Jest_WriteFn write_fn, void *userdata, const Jest_JsonVal *val, unsigned flags)
+{
+    if (!write_fn || !val) return JEST_ERROR_BADPARAM;
+
+    char buf[JEST_WRITE_CHUNK_SIZE];
+
+    Jest__Writer w;
+    memset(&w, 0, sizeof(w));
+    w.write_fn = write_fn;
+    w.userdata = userdata;
+    w.buf = buf;
+    w.cap = sizeof(buf);
+    w.flags = flags;
+
+    Jest__writeJsonVal(&w, val);
+    if (!w.err && w.len && !write_fn(userdata, w.buf, w.len)) w.err = JEST_ERROR_IO;
+
+    return w.err;
+}
+
+void Jest_destroyJsonVal(Jest_JsonVal *val)
+{
+    if (!val) return;
+
+    // arena values are freed along with the document that owns them
+    if (val->flags & JEST_JSONFLAG_ARENA) {
+        memset(val, 0, sizeof(*val));
+        return;
+    }
+
+    switch (val->type) {
+        case JEST_JSONTYPE_NULL:
+        case JEST_JSONTYPE_BOOL:
+        case JEST_JSONTYPE_NUM:
+        case JEST_JSONTYPE_ERR:
+            break;
+
+        case JEST_JSONTYPE_STR: free(val->v.as_str.data); break;
+        case JEST_JSONTYPE_ARR: goto lbl_destroy_container;
+        case JEST_JSONTYPE_OBJ: goto lbl_destroy_container;
+    }
+
+    memset(val, 0, sizeof(*val));
+    return;
+
+lbl_destroy_container: {
+        // nested containers go on an explicit stack instead of the call stack
+        Jest__WalkFrame local[JEST__LOCAL_FRAMES];
+        Jest__WalkFrame *stack = local;
+        size_t depth = 1, cap = JEST__LOCAL_FRAMES;
+
+        stack[0].val = val;
+        stack[0].idx = 0;
+
+        while (depth) {
+            Jest__WalkFrame *top = &stack[depth - 1];
+            const Jest_JsonVal *c = top->val;
+            const bool is_arr = c->type == JEST_JSONTYPE_ARR;
+
+            if (top->idx < ((is_arr)? c->v.as_arr.len : c->v.as_obj.nfields)) {
+                const Jest_JsonVal *child = (is_arr)? &c->v.as_arr.elems[top->idx] : &c->v.as_obj.field_values[top->idx];
+                if (!is_arr) free(c->v.as_obj.field_names[top->idx]);
+                ++top->idx;
+
+                if (child->flags & JEST_JSONFLAG_ARENA) continue;
+                if (child->type == JEST_JSONTYPE_STR) free(child->v.as_str.data);
+                if (child->type != JEST_JSONTYPE_ARR && child->type != JEST_JSONTYPE_OBJ) continue;
+
+                if (depth == cap) {
+                    Jest__WalkFrame *grown = (Jest__WalkFrame *)Jest__growStack(stack, local, &cap, sizeof(*stack));
+
+                    // without room for another frame the child gets a stack of its own
+                    if (!grown) {
+                        Jest_destroyJsonVal((Jest_JsonVal *)child);
+                        continue;
+                    }
+
+                    stack = grown;
+                }
+
+                stack[depth].val = child;
+                stack[depth].idx = 0;
+                ++depth;
+                continue;
+            }
+
+            if (is_arr) free(c->v.as_arr.elems);
+            else {
+                free(c->v.as_obj.field_names);
+                free(c->v.as_obj.fn_lens);
+                free(c->v.as_obj.field_values);
+                free(c->v.as_obj.index);
+            }
+
+            --depth;
+        }
+
+        if (stack != local) free(stack);
+    }
+
+    memset(val, 0, sizeof(*val));
+}
+
+Jest_JsonVal *Jest_jsonIdx(Jest_JsonVal *parent, const char *accessor, Jest_Error *opt_err_out)
+{
+    if (!parent || !accessor || (parent->type != JEST_JSONTYPE_OBJ && parent->type != JEST_JSONTYPE_ARR)) {
+        if (opt_err_out) *opt_err_out = JEST_ERROR_BADPARAM;
+        return NULL;
+    }
+
+    // one-off lookups, callers resolving the same accessor repeatedly should keep the compiled path around
+    Jest_Path path;
+    const Jest_Error err = Jest_compilePath(&path, accessor);
+    if (err) {
+        if (opt_err_out) *opt_err_out = err;
+        return NULL;
+    }
+
+    Jest_JsonVal *ret = Jest_pathResolve(&path, parent, opt_err_out);
+    Jest_destroyPath(&path);
+    return ret;
+}
+
+Jest_Error Jest_compilePath(Jest_Path *path, const char *accessor)
+{
+    if (!path) return JEST_ERROR_BADPARAM;
+    memset(path, 0, sizeof(*path));
+    if (!accessor) return JEST_ERROR_BADPARAM;
+
+    const size_t accessor_len = strlen(accessor);
+    if (!accessor_len) return JEST_ERROR_BADLEXER;
+
+    Jest_Lexer lexer;
+    if (!Jest_initLexer(&lexer, NULL, 0, accessor, accessor_len)) {
+        Jest_destroyLexer(&lexer);
+        return JEST_ERROR_BADLEXER;
+    }
+
+    // keys are stored back to back, decoded keys are never longer than the accessor itself so this never moves
+    path->keys = (char *)malloc(accessor_len);
+    size_t keys_len = 0, cap = 0;
+    Jest_Error err = (path->keys)? JEST_ERROR_NONE : JEST_ERROR_NOMEM;
+
+    while (!err && lexer.type != JEST_LEXEME_EOF) {
+        if (lexer.type != '[') {
+            err = JEST_ERROR_SYNTAX;
+            break;
+        }
+
+        if (path->nsteps + 1 > cap) {
+            cap = (cap)? cap * 2 : 8;
+            Jest_PathStep *steps = (Jest_PathStep *)realloc(path->steps, sizeof(*steps) * cap);
+            if (!steps) {
+                err = JEST_ERROR_NOMEM;
+                break;
+            }
+
+            path->steps = steps;
+        }
+
+        Jest_PathStep *step = &path->steps[path->nsteps];
+        memset(step, 0, sizeof(*step));
+
+        Jest_lexerStep(&lexer);
+        if (lexer.type == JEST_LEXEME_NUM) {
+            if (!(lexer.numval >= 0 && lexer.numval < (double)SIZE_MAX && lexer.numval == (double)(size_t)lexer.numval)) {
+                err = JEST_ERROR_SYNTAX;
+                break;
+            }
+
+            step->idx = (size_t)lexer.numval;
+        } else if (lexer.type == JEST_LEXEME_STR || lexer.type == JEST_LEXEME_IDENT) {
+            const char *key = (lexer.type == JEST_LEXEME_STR)? lexer.strval : &lexer.filebuf[lexer.ident_start];
+            const size_t key_len = (lexer.type == JEST_LEXEME_STR)? lexer.strval_len : lexer.ident_len;
+
+            memcpy(&path->keys[keys_len], key, key_len);
+            step->key = &path->keys[keys_len];
+            step->key_len = key_len;
+            step->hash = Jest__hashStr(key, key_len);
+            keys_len += key_len;
+        } else {
+            err = JEST_ERROR_SYNTAX;
+            break;
+        }
+
+        ++path->nsteps;
+
+        Jest_lexerStep(&lexer);
+        if (lexer.type != ']') {
+            err = JEST_ERROR_SYNTAX;
+            break;
+        }
+
+        Jest_lexerStep(&lexer);
+    }
+
+    Jest_destroyLexer(&lexer);
+    if (err) Jest_destroyPath(path);
+
+    return err;
+}
+
+Jest_JsonVal *Jest_pathResolve(const Jest_Path *path, Jest_JsonVal *root, Jest_Error *opt_err_out)
+{
+    if (!path || !root) {
+        if (opt_err_out) *opt_err_out = JEST_ERROR_BADPARAM;
+        return NULL;
+    }
+
+    Jest_JsonVal *current = root;
+    for (size_t i = 0; current && i < path->nsteps; ++i) {
+        current = Jest__pathStepApply(&path->steps[i], current);
+    }
+
+    if (opt_err_out) *opt_err_out = (current)? JEST_ERROR_NONE : JEST_ERROR_BADPARAM;
+    return current;
+}
+
+void Jest_destroyPath(Jest_Path *path)
+{
+    if (!path) return;
+
+    free(path->steps);
+    free(path->keys);
+    memset(path, 0, sizeof(*path));
+}
+
+Jest_Error Jest_compilePathSet(Jest_PathSet *set, const char *const *accessors, size_t naccessors)
+{
+    if (!set) return JEST_ERROR_BADPARAM;
+    memset(set, 0, sizeof(*set));
+    if (!accessors && naccessors) return JEST_ERROR_BADPARAM;
+
+    set->paths = (Jest_Path *)calloc(naccessors + 1, sizeof(*set->paths));
+    set->next_end = (size_t *)malloc(sizeof(*set->next_end) * (naccessors + 1));
+    set->nodes = (Jest__PathNode *)malloc(sizeof(*set->nodes) * 16);
+    if (!set->paths || !set->next_end || !set->nodes) {
+        Jest_destroyPathSet(set);
+        return JEST_ERROR_NOMEM;
+    }
+
+    size_t cap = 16;
+    const Jest__PathNode root = {NULL, JEST__PATH_NONE, JEST__PATH_NONE, JEST__PATH_NONE};
+    set->nodes[set->nnodes++] = root;
+
+    for (; set->npaths < naccessors; ++set->npaths) {
+        const size_t i = set->npaths;
+        const Jest_Error err = Jest_compilePath(&set->paths[i], accessors[i]);
+        if (err) {
+            Jest_destroyPathSet(set);
+            return err;
+        }
+
+        // follow the steps that are already in the trie and add the rest
+        size_t node = 0;
+        for (size_t s = 0; s < set->paths[i].nsteps; ++s) {
+            const Jest_PathStep *step = &set->paths[i].steps[s];
+
+            size_t child = set->nodes[node].first_child;
+            for (; child != JEST__PATH_NONE; child = set->nodes[child].next_sibling) {
+                const Jest_PathStep *other = set->nodes[child].step;
+                if (!step->key != !other->key) continue;
+
+                if (step->key) {
+                    if (step->hash == other->hash && step->key_len == other->key_len && !memcmp(step->key, other->key, step->key_len)) break;
+                } else if (step->idx == other->idx) break;
+            }
+
+            if (child == JEST__PATH_NONE) {
+                if (set->nnodes + 1 > cap) {
+                    Jest__PathNode *nodes = (Jest__PathNode *)realloc(set->nodes, sizeof(*nodes) * cap * 2);
+                    if (!nodes) {
+                        ++set->npaths;
+                        Jest_destroyPathSet(set);
+                        return JEST_ERROR_NOMEM;
+                    }
+
+                    set->nodes = nodes;
+                    cap *= 2;
+                }
+
+                child = set->nnodes++;
+                const Jest__PathNode added = {step, JEST__PATH_NONE, set->nodes[node].first_child, JEST__PATH_NONE};
+                set->nodes[child] = added;
+                set->nodes[node].first_child = child;
+            }
+
+            node = child;
+        }
+
+        set->next_end[i] = set->nodes[node].first_end;
+        set->nodes[node].first_end = i;
+    }
+
+    return JEST_ERROR_NONE;
+}
+
+void Jest_pathSetResolve(const Jest_PathSet *set, Jest_JsonVal *root, Jest_JsonVal **out)
+{
+    if (!set || !out) return;
+
+    for (size_t i = 0; i < set->npaths; ++i) out[i] = NULL;
+    if (root && set->nodes) Jest__pathSetWalk(set, 0, root, out, NULL);
+}
+
+Jest_Error Jest_pathSetExtract(const Jest_PathSet *set, Jest_Lexer *lexer, Jest_JsonVal *out)
+{
+    if (!set || !set->nodes || !lexer || !out) return JEST_ERROR_BADPARAM;
+
+    // paths that aren't found are left as errors
+    for (size_t i = 0; i < set->npaths; ++i) {
+        out[i] = Jest_jsonNull();
+        out[i].type = JEST_JSONTYPE_ERR;
+        out[i].v.as_err = JEST_ERROR_BADPARAM;
+    }
+
+    JEST__STAT_PARSE_START(start);
+    const Jest_Error err = Jest__pathSetExtractNode(set, 0, lexer, out);
+    JEST__STAT_PARSE_END(start);
+    if (!err) return JEST_ERROR_NONE;
+
+    for (size_t i = 0; i < set->npaths; ++i) {
+        Jest_destroyJsonVal(&out[i]);
+        out[i].type = JEST_JSONTYPE_ERR;
+        out[i].v.as_err = err;
+    }
+
+    return err;
+}
+
+void Jest_destroyPathSet(Jest_PathSet *set)
+{
+    if (!set) return;
+
+    for (size_t i = 0; i < set->npaths; ++i) Jest_destroyPath(&set->paths[i]);
+
+    free(set->paths);
+    free(set->nodes);
+    free(set->next_end);
+    memset(set, 0, sizeof(*set));
+}
+
+Jest_Error Jest_lazyRoot(Jest_LazyVal *out, const char *src, size_t src_len)
+{
+    if (!out || !src || !src_len) return JEST_ERROR_BADPARAM;
+
+    const Jest_LazyVal whole = {JEST_JSONTYPE_NULL, src, 0, src_len};
+    Jest_Lexer l;
+    Jest__lazyLexer(&l, NULL, 0, &whole, 0);
+
+    Jest__lexerSkipCommentAndWhiteSpace(&l);
+    if (l.filebuf_offset >= src_len) return JEST_ERROR_SYNTAX;
+
+    // finding the end of a root container would mean scanning all of it up front
+    const char c = src[l.filebuf_offset];
+    if (c == '{' || c == '[') {
+        out->type = (c == '{')? JEST_JSONTYPE_OBJ : JEST_JSONTYPE_ARR;
+        out->src = src;
+        out->start = l.filebuf_offset;
+        out->end = src_len;
+        return JEST_ERROR_NONE;
+    }
+
+    const Jest_Error err = Jest__lazyNext(&l, out);
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+Jest_Error Jest_lazyField(Jest_LazyVal *out, const Jest_LazyVal *obj, const char *field_name)
+{
+    if (!out || !obj || !field_name) return JEST_ERROR_BADPARAM;
+    return Jest__lazyField(out, obj, field_name, strlen(field_name));
+}
+
+Jest_Error Jest_lazyIdx(Jest_LazyVal *out, const Jest_LazyVal *arr, size_t idx)
+{
+    if (!out || !arr || arr->type != JEST_JSONTYPE_ARR) return JEST_ERROR_BADPARAM;
+
+    Jest_Lexer l;
+    Jest__lazyLexer(&l, NULL, 0, arr, arr->start + 1);
+
+    Jest_Error err = JEST_ERROR_BADPARAM;
+    for (size_t i = 0;; ++i) {
+        Jest__lexerSkipCommentAndWhiteSpace(&l);
+        if (l.filebuf_offset < l.filebuf_sz && l.filebuf[l.filebuf_offset] == ']') break;
+
+        Jest_LazyVal elem;
+        const Jest_Error elem_err = Jest__lazyNext(&l, &elem);
+        if (elem_err) {
+            err = elem_err;
+            break;
+        }
+
+        if (i == idx) {
+            *out = elem;
+            err = JEST_ERROR_NONE;
+            break;
+        }
+
+        Jest_lexerStep(&l);
+        if (l.type == ']') break;
+        if (l.type != ',') {
+            err = JEST_ERROR_SYNTAX;
+            break;
+        }
+    }
+
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+Jest_Error Jest_lazyPath(Jest_LazyVal *out, const Jest_LazyVal *root, const Jest_Path *path)
+{
+    if (!out || !root || !path) return JEST_ERROR_BADPARAM;
+
+    Jest_LazyVal current = *root;
+    for (size_t i = 0; i < path->nsteps; ++i) {
+        const Jest_PathStep *step = &path->steps[i];
+        const Jest_Error err = (step->key)
+            ? Jest__lazyField(&current, &current, step->key, step->key_len)
+            : Jest_lazyIdx(&current, &current, step->idx);
+        if (err) return err;
+    }
+
+    *out = current;
+    return JEST_ERROR_NONE;
+}
+
+Jest_Error Jest_lazyDecode(Jest_JsonVal *out, const Jest_LazyVal *val)
+{
+    if (!out || !val || !val->src) return JEST_ERROR_BADPARAM;
+
+    Jest_Lexer l;
+    Jest__lazyLexer(&l, NULL, 0, val, val->start);
+    Jest_lexerStep(&l);
+
+    const Jest_Error err = Jest_parseJsonLexer(out, &l);
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+Jest_Error Jest_parseTapeLexer(Jest_Tape *tape, Jest_Lexer *lexer)
+{
+    if (!tape || !lexer) return JEST_ERROR_BADPARAM;
+
+    static const Jest_SaxHandler tape_handler = {
+        Jest__tapeBeginObj, Jest__tapeEndObj, Jest__tapeBeginArr, Jest__tapeEndArr,
+        Jest__tapeKey, Jest__tapeStr, Jest__tapeNum, Jest__tapeBool, Jest__tapeNull
+    };
+
+    memset(tape, 0, sizeof(*tape));
+
+    Jest__TapeBuilder b;
+    memset(&b, 0, sizeof(b));
+    b.tape = tape;
+
+    Jest_Error err = Jest_parseSaxLexer(lexer, &tape_handler, &b);
+    if (err == JEST_ERROR_ABORTED && b.err) err = b.err;
+
+    free(b.stack);
+    if (err) Jest_destroyTape(tape);
+    return err;
+}
+
+Jest_Error Jest_tapeFromJsonVal(Jest_Tape *tape, const Jest_JsonVal *val)
+{
+    if (!tape || !val) return JEST_ERROR_BADPARAM;
+
+    memset(tape, 0, sizeof(*tape));
+    const Jest_Error err = Jest__tapeAppendVal(tape, val);
+    if (err) Jest_destroyTape(tape);
+
+    return err;
+}
+
+Jest_Error Jest_tapeToJsonVal(Jest_JsonVal *out, const Jest_Tape *tape, size_t pos)
+{
+    if (!out || !tape || pos >= tape->len) return JEST_ERROR_BADPARAM;
+
+    Jest_Error err = Jest__tapeShallow(out, tape, pos);
+    if (err || (out->type != JEST_JSONTYPE_ARR && out->type != JEST_JSONTYPE_OBJ)) return err;
+
+    // nested containers go on an explicit stack, each one is added to its parent empty and filled in from there,
+    // the idx of a frame is the tape position of its next element, or of the key in front of it
+    Jest__WalkFrame local[JEST__LOCAL_FRAMES];
+    Jest__WalkFrame *stack = local;
+    size_t depth = 1, cap = JEST__LOCAL_FRAMES;
+
+    stack[0].val = out;
+    stack[0].idx = pos + 1;
+
+    while (depth) {
+        Jest__WalkFrame *top = &stack[depth - 1];
+        Jest_JsonVal *to = (Jest_JsonVal *)top->val;
+        const bool is_obj = to->type == JEST_JSONTYPE_OBJ;
+
+        if (top->idx >= tape->len) {
+            err = JEST_ERROR_BADPARAM;
+            break;
+        }
+
+        const char tag = JEST__TAPE_TAG(tape->entries[top->idx]);
+        if (tag == ']' || tag == '}') {
+            --depth;
+            continue;
+        }
+
+        const size_t key = top->idx, at = (is_obj)? key + 1 : key;
+        top->idx = Jest_tapeSkip(tape, at);
+
+        Jest_JsonVal elem;
+        err = (at < tape->len)? Jest__tapeShallow(&elem, tape, at) : JEST_ERROR_BADPARAM;
+        if (err) break;
+
+        size_t name_len = 0;
+        const char *name = (is_obj)? Jest_tapeStr(tape, key, &name_len) : NULL;
+        const size_t nfields = (is_obj)? to->v.as_obj.nfields : 0;
+
+        if (is_obj) {
+            char *owned_name = (name)? Jest__strndup(NULL, name, name_len) : NULL;
+            if (!name) err = JEST_ERROR_BADPARAM;
+            else err = (owned_name)? Jest__objAdd(NULL, to, owned_name, name_len, elem) : JEST_ERROR_NOMEM;
+        } else err = Jest__arrayAppend(NULL, to, &elem);
+
+        if (err) {
+            Jest_destroyJsonVal(&elem);
+            break;
+        }
+
+        if (elem.type != JEST_JSONTYPE_ARR && elem.type != JEST_JSONTYPE_OBJ) continue;
+
+        // a name that's there already has its value replaced where it is
+        Jest_JsonVal *added;
+        if (!is_obj) added = &to->v.as_arr.elems[to->v.as_arr.len - 1];
+        else if (to->v.as_obj.nfields > nfields) added = &to->v.as_obj.field_values[nfields];
+        else added = &to->v.as_obj.field_values[Jest__objFind(to, name, name_len, Jest__hashStr(name, name_len))];
+
+        if (depth == cap) {
+            Jest__WalkFrame *grown = (Jest__WalkFrame *)Jest__growStack(stack, local, &cap, sizeof(*stack));
+            if (!grown) {
+                err = JEST_ERROR_NOMEM;
+                break;
+            }
+
+            stack = grown;
+        }
+
+        stack[depth].val = added;
+        stack[depth].idx = at + 1;
+        ++depth;
+    }
+
+    if (stack != local) free(stack);
+    if (err) Jest_destroyJsonVal(out);
+    return err;
+}
+
+Jest_JsonType Jest_tapeType(const Jest_Tape *tape, size_t pos)
+{
+    if (!tape || pos >= tape->len) return JEST_JSONTYPE_ERR;
+
+    switch (JEST__TAPE_TAG(tape->entries[pos])) {
+        case 'n': return JEST_JSONTYPE_NULL;
+        case 't':
+        case 'f': return JEST_JSONTYPE_BOOL;
+        case 'd': return JEST_JSONTYPE_NUM;
+        case '"': return JEST_JSONTYPE_STR;
+        case '[': return JEST_JSONTYPE_ARR;
+        case '{': return JEST_JSONTYPE_OBJ;
+        default:  return JEST_JSONTYPE_ERR;
+    }
+}
+
+size_t Jest_tapeSkip(const Jest_Tape *tape, size_t pos)
+{
+    if (!tape || pos >= tape->len) return (size_t)-1;
+
+    switch (JEST__TAPE_TAG(tape->entries[pos])) {
+        case '[':
+        case '{': return JEST__TAPE_PAYLOAD(tape->entries[pos]);
+        case 'd': return pos + 2;
+        default:  return pos + 1;
+    }
+}
+
+size_t Jest_tapeCount(const Jest_Tape *tape, size_t pos)
+{
+    const Jest_JsonType type = Jest_tapeType(tape, pos);
+    if (type != JEST_JSONTYPE_ARR && type != JEST_JSONTYPE_OBJ) return 0;
+
+    return JEST__TAPE_PAYLOAD(tape->entries[Jest_tapeSkip(tape, pos) - 1]);
+}
+
+bool Jest_tapeBool(const Jest_Tape *tape, size_t pos)
+{
+    return tape && pos < tape->len && JEST__TAPE_TAG(tape->entries[pos]) == 't';
+}
+
+double Jest_tapeNum(const Jest_Tape *tape, size_t pos)
+{
+    if (Jest_tapeType(tape, pos) != JEST_JSONTYPE_NUM) return JEST_NAN;
+
+    double val;
+    memcpy(&val, &tape->entries[pos + 1], sizeof(val));
+    return val;
+}
+
+const char *Jest_tapeStr(const Jest_Tape *tape, size_t pos, size_t *opt_len_out)
+{
+    if (Jest_tapeType(tape, pos) != JEST_JSONTYPE_STR) return NULL;
+
+    const size_t offset = JEST__TAPE_PAYLOAD(tape->entries[pos]);
+    if (opt_len_out) memcpy(opt_len_out, &tape->strs[offset], sizeof(*opt_len_out));
+    return &tape->strs[offset + sizeof(size_t)];
+}
+
+size_t Jest_tapeField(const Jest_Tape *tape, size_t pos, const char *field_name)
+{
+    if (!field_name || Jest_tapeType(tape, pos) != JEST_JSONTYPE_OBJ) return (size_t)-1;
+
+    const size_t name_len = strlen(field_name);
+    size_t found = (size_t)-1;
+
+    // tapes keep duplicate keys, the last one wins like it does in a tree
+    Jest_TapeIter it;
+    for (bool more = Jest_tapeIterBegin(&it, tape, pos); more; more = Jest_tapeIterNext(&it)) {
+        size_t len = 0;
+        const char *key = Jest_tapeStr(tape, it.key, &len);
+        if (len == name_len && !memcmp(key, field_name, len)) found = it.pos;
+    }
+
+    return found;
+}
+
+bool Jest_tapeIterBegin(Jest_TapeIter *it, const Jest_Tape *tape, size_t pos)
+{
+    const Jest_JsonType type = Jest_tapeType(tape, pos);
+    if (!it || (type != JEST_JSONTYPE_ARR && type != JEST_JSONTYPE_OBJ)) return false;
+
+    it->tape = tape;
+    it->end = Jest_tapeSkip(tape, pos) - 1;
+    it->key = (type == JEST_JSONTYPE_OBJ)? pos + 1 : (size_t)-1;
+    it->pos = (type == JEST_JSONTYPE_OBJ)? pos + 2 : pos + 1;
+
+    // an empty container has its closing entry right after the opening one
+    return it->pos - (type == JEST_JSONTYPE_OBJ) < it->end;
+}
+
+bool Jest_tapeIterNext(Jest_TapeIter *it)
+{
+    if (!it) return false;
+
+    const size_t next = Jest_tapeSkip(it->tape, it->pos);
+    if (next >= it->end) return false;
+
+    if (it->key != (size_t)-1) {
+        it->key = next;
+        it->pos = next + 1;
+    } else it->pos = next;
+
+    return true;
+}
+
+void Jest_destroyTape(Jest_Tape *tape)
+{
+    if (!tape) return;
+
+    free(tape->entries);
+    free(tape->strs);
+    memset(tape, 0, sizeof(*tape));
+}
+
+struct Jest__ArenaBlock {
+    struct Jest__ArenaBlock *prev, *next;
+    size_t used, cap;
+};
+
+#define JEST__ARENA_ALIGN ((size_t)16)
+#define JEST__ARENA_HDR_SZ ((sizeof(struct Jest__ArenaBlock) + JEST__ARENA_ALIGN - 1) & ~(JEST__ARENA_ALIGN - 1))
+#define JEST__ARENA_DATA(block) ((char *)(block) + JEST__ARENA_HDR_SZ)
+#define JEST__ARENA_BLOCK_SZ(arena) (((arena)->block_sz)? (arena)->block_sz : JEST_ARENA_BLOCK_SIZE)
+
+void Jest_initArena(Jest_Arena *arena, size_t block_sz)
+{
+    if (!arena) return;
+
+    arena->head = NULL;
+    arena->spare = NULL;
+    arena->block_sz = block_sz;
+}
+
+void *Jest_arenaAlloc(Jest_Arena *arena, size_t sz)
+{
+    return Jest__arenaAllocAligned(arena, sz, JEST__ARENA_ALIGN);
+}
+
+void Jest_arenaReset(Jest_Arena *arena)
+{
+    if (!arena) return;
+
+    // everything allocated so far is dropped, the blocks move over to the spare list
+    struct Jest__ArenaBlock *block = arena->head;
+    while (block) {
+        struct Jest__ArenaBlock *next = block->next;
+        block->used = 0;
+        block->prev = NULL;
+        block->next = arena->spare;
+        arena->spare = block;
+        block = next;
+    }
+
+    arena->head = NULL;
+}
+
+void Jest_destroyArena(Jest_Arena *arena)
+{
+    if (!arena) return;
+
+    Jest_arenaReset(arena);
+
+    struct Jest__ArenaBlock *block = arena->spare;
+    while (block) {
+        struct Jest__ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->spare = NULL;
+}
+
+void Jest_initDocument(Jest_Document *doc)
+{
+    if (!doc) return;
+
+    doc->root = Jest_jsonNull();
+    Jest_initArena(&doc->arena, 0);
+    doc->flags = 0;
+    doc->source = NULL;
+    doc->source_mapped = 0;
+    doc->intern = NULL;
+}
+
+Jest_Error Jest_parseDocumentLexer(Jest_Document *doc, Jest_Lexer *lexer)
+{
+    if (!doc || !lexer) return JEST_ERROR_BADPARAM;
+
+    // with JEST_DOC_ZEROCOPY the lexer's filebuf has to outlive the document
+    JEST__STAT_PARSE_START(start);
+    Jest__ParseCtx ctx = {lexer, &doc->arena, (doc->flags & JEST_DOC_ZEROCOPY) != 0, (doc->flags & JEST_DOC_INTERN)? &doc->intern : NULL};
+    const Jest_Error ret = Jest__parseVal(&doc->root, &ctx);
+
+    JEST__STAT_PARSE_END(start);
+    return ret;
+}
+
+Jest_Error Jest_parseDocumentFile(Jest_Document *doc, FILE *file)
+{
+    if (!doc || !file) return JEST_ERROR_BADPARAM;
+
+    char *filebuf = NULL;
+    size_t filebuf_sz = Jest_readEntireFile(&filebuf, file);
+    if (!filebuf || !filebuf_sz) return JEST_ERROR_IO;
+
+    Jest_Error ret = Jest_parseDocumentFromBuf(doc, filebuf, filebuf_sz);
+
+    // zero-copy strings point into filebuf, so the document holds on to it
+    if (doc->flags & JEST_DOC_ZEROCOPY) {
+        Jest__FileBuf old = {doc->source, doc->source_mapped, doc->source_mapped != 0};
+        Jest__releaseFile(&old);
+
+        doc->source = filebuf;
+        doc->source_mapped = 0;
+    } else free(filebuf);
+
+    return ret;
+}
+
+Jest_Error Jest_parseDocumentFromPath(Jest_Document *doc, const char *path)
+{
+    if (!doc || !path) return JEST_ERROR_BADPARAM;
+
+    Jest__FileBuf fb;
+    Jest_Error ret = Jest__loadFile(&fb, path);
+    if (ret) return ret;
+
+    ret = Jest_parseDocumentFromBuf(doc, fb.data, fb.len);
+
+    // a mapping is handed over to the document the same way a buffer is
+    if (doc->flags & JEST_DOC_ZEROCOPY) {
+        Jest__FileBuf old = {doc->source, doc->source_mapped, doc->source_mapped != 0};
+        Jest__releaseFile(&old);
+
+        doc->source = fb.data;
+        doc->source_mapped = (fb.mapped)? fb.len : 0;
+    } else Jest__releaseFile(&fb);
+
+    return ret;
+}
+
+Jest_Error Jest_parseDocumentFromBuf(Jest_Document *doc, const char *buf, size_t len)
+{
+    if (!doc || !buf) return JEST_ERROR_BADPARAM;
+
+    // with JEST_DOC_ZEROCOPY buf has to outlive the document
+    Jest_Lexer l;
+    if (!Jest_initLexer(&l, NULL, 0, buf, len)) {
+        Jest_destroyLexer(&l);
+        return JEST_ERROR_BADLEXER;
+    }
+
+    const Jest_Error ret = Jest_parseDocumentLexer(doc, &l);
+    Jest_destroyLexer(&l);
+    return ret;
+}
+
+Jest_Error Jest_parseDocumentInSitu(Jest_Document *doc, char *buf, size_t len)
+{
+    if (!doc || !buf || !len) return JEST_ERROR_BADPARAM;
+
+    // every string is decoded into buf and used from there, so the parse is zero-copy
+    // and buf has to outlive the document, its contents are garbage as json afterwards,
+    // the flag only holds for this parse so that later ones into doc copy their strings again
+    Jest_Lexer l;
+    memset(&l, 0, sizeof(l));
+    l.max_depth = JEST_MAX_DEPTH;
+    l.insitu = true;
+    Jest__lexerRewind(&l, buf, len);
+
+    const unsigned flags = doc->flags;
+    doc->flags |= JEST_DOC_ZEROCOPY;
+    const Jest_Error err = Jest_parseDocumentLexer(doc, &l);
+    doc->flags = flags;
+    return err;
+}
+
+Jest_Error Jest_parseDocumentParallel(Jest_Document *doc, const char *buf, size_t len, unsigned nthreads)
+{
+    if (!doc || !buf || !len) return JEST_ERROR_BADPARAM;
+
+    const unsigned n = Jest__workerThreads(nthreads, len);
+
+    // only a top level array can be split up, anything else is parsed on this thread
+    Jest_Lexer l;
+    memset(&l, 0, sizeof(l));
+    l.filebuf = buf;
+    l.filebuf_sz = len;
+    Jest__lexerSkipCommentAndWhiteSpace(&l);
+
+    if (n < 2 || l.filebuf_offset >= len || buf[l.filebuf_offset] != '[') return Jest_parseDocumentFromBuf(doc, buf, len);
+
+    JEST__STAT_PARSE_START(start);
+    const Jest_Error err = Jest__parseElemsParallel(doc, &l, n);
+    JEST__STAT_PARSE_END(start);
+    return err;
+}
+
+Jest_Error Jest_docArrayAppend(Jest_Document *doc, Jest_JsonVal *arr, const Jest_JsonVal *elem)
+{
+    if (!doc || !arr) return JEST_ERROR_BADPARAM;
+    return Jest__arrayAppend(&doc->arena, arr, elem);
+}
+
+Jest_Error Jest_docObjAdd(Jest_Document *doc, Jest_JsonVal *obj, const char *field_name, Jest_JsonVal value)
+{
+    if (!doc || !obj || !field_name) return JEST_ERROR_BADPARAM;
+    if (obj->type != JEST_JSONTYPE_OBJ) return JEST_ERROR_BADPARAM;
+
+    const size_t name_len = strlen(field_name);
+    char *name = (doc->flags & JEST_DOC_INTERN)
+        ?Jest__internKey(&doc->arena, &doc->intern, field_name, name_len)
+        :Jest__strndup(&doc->arena, field_name, name_len);
+    if (!name) return JEST_ERROR_NOMEM;
+
+    return Jest__objAdd(&doc->arena, obj, name, name_len, value);
+}
+
+Jest_JsonVal Jest_docString(Jest_Document *doc, const char *val)
+{
+    Jest_JsonVal out = Jest_jsonNull();
+    if (!doc || !val) return out;
+
+    const size_t len = strlen(val);
+    char *data = Jest__strndup(&doc->arena, val, len);
+    if (!data) return out;
+
+    out.type = JEST_JSONTYPE_STR;
+    out.flags = JEST_JSONFLAG_ARENA;
+    out.v.as_str.len = len;
+    out.v.as_str.data = data;
+    return out;
+}
+
+void Jest_destroyDocument(Jest_Document *doc)
+{
+    if (!doc) return;
+
+    Jest_destroyArena(&doc->arena);
+
+    Jest__FileBuf source = {doc->source, doc->source_mapped, doc->source_mapped != 0};
+    Jest__releaseFile(&source);
+    doc->source = NULL;
+    doc->source_mapped = 0;
+    doc->intern = NULL;
+    doc->root = Jest_jsonNull();
+}
+
+void Jest_initParser(Jest_Parser *p)
+{
+    if (!p) return;
+
+    Jest_initDocument(&p->doc);
+    memset(&p->lexer, 0, sizeof(p->lexer));
+    p->lexer.max_depth = JEST_MAX_DEPTH;
+}
+
+Jest_Error Jest_parserParse(Jest_Parser *p, const char *buf, size_t len)
+{
+    if (!p || !buf || !len) return JEST_ERROR_BADPARAM;
+
+    // the previous tree is dropped all at once, its blocks are what this one is built from
+    Jest_arenaReset(&p->doc.arena);
+    p->doc.root = Jest_jsonNull();
+    p->doc.intern = NULL;
+
+    p->lexer.insitu = false;
+    Jest__lexerRewind(&p->lexer, buf, len);
+    return Jest_parseDocumentLexer(&p->doc, &p->lexer);
+}
+
+Jest_Error Jest_parserParseInSitu(Jest_Parser *p, char *buf, size_t len)
+{
+    if (!p || !buf || !len) return JEST_ERROR_BADPARAM;
+
+    Jest_arenaReset(&p->doc.arena);
+    p->doc.root = Jest_jsonNull();
+    p->doc.intern = NULL;
+
+    // like Jest_parseDocumentInSitu, nothing but the arena's recycled blocks is needed,
+    // zero-copy only holds for this parse so that Jest_parserParse doesn't keep pointing into buf
+    const unsigned flags = p->doc.flags;
+    p->doc.flags |= JEST_DOC_ZEROCOPY;
+    p->lexer.insitu = true;
+    Jest__lexerRewind(&p->lexer, buf, len);
+
+    const Jest_Error err = Jest_parseDocumentLexer(&p->doc, &p->lexer);
+    p->doc.flags = flags;
+    return err;
+}
+
+void Jest_destroyParser(Jest_Parser *p)
+{
+    if (!p) return;
+
+    Jest_destroyDocument(&p->doc);
+    Jest_destroyLexer(&p->lexer);
+}
+
+#ifdef JEST_STATS
+void Jest_getStats(Jest_Stats *out)
+{
+    if (out) *out = Jest__stats;
+}
+
+void Jest_resetStats(void)
+{
+    memset(&Jest__stats, 0, sizeof(Jest__stats));
+}
+#endif // JEST_STATS
+
+Jest_Error Jest_parseSaxLexer(Jest_Lexer *lexer, const Jest_SaxHandler *handler, void *userdata)
+{
+    if (!lexer || !handler) return JEST_ERROR_BADPARAM;
+
+    JEST__STAT_PARSE_START(start);
+    Jest__SaxState state;
+    Jest__initSaxState(&state);
+
+    Jest_Error err;
+    while (!(err = Jest__saxFeed(&state, lexer, handler, userdata)) && state.expect != JEST__SAX_DONE) {
+        Jest_lexerStep(lexer);
+    }
+
+    // leave the lexer on whatever comes after the value, like Jest_parseJsonLexer does
+    if (!err) Jest_lexerStep(lexer);
+
+    free(state.stack);
+    JEST__STAT_PARSE_END(start);
+    return err;
+}
+
+Jest_Error Jest_parseSaxFile(FILE *file, const Jest_SaxHandler *handler, void *userdata)
+{
+    if (!file || !handler) return JEST_ERROR_BADPARAM;
+
+    Jest_ChunkParser p;
+    Jest_Error err = Jest_initChunkParser(&p, handler, userdata);
+
+    // the file is streamed through in chunks so it never has to fit in memory
+    char chunk[JEST_READ_CHUNK_SIZE];
+    size_t nread;
+    while (!err && (nread = fread(chunk, 1, sizeof(chunk), file))) {
+        err = Jest_chunkParserFeed(&p, chunk, nread);
+    }
+
+    if (!err && ferror(file)) err = JEST_ERROR_IO;
+    if (!err) err = Jest_chunkParserFinish(&p);
+
+    Jest_destroyChunkParser(&p);
+    return err;
+}
+
+Jest_Error Jest_parseSaxFromPath(const char *path, const Jest_SaxHandler *handler, void *userdata)
+{
+    if (!path || !handler) return JEST_ERROR_BADPARAM;
+
+    FILE *f = fopen(path, "r");
+    if (!f) return JEST_ERROR_IO;
+
+    const Jest_Error ret = Jest_parseSaxFile(f, handler, userdata);
+    fclose(f);
+
+    return ret;
+}
+
+Jest_Error Jest_initChunkParser(Jest_ChunkParser *p, const Jest_SaxHandler *handler, void *userdata)
+{
+    if (!p || !handler) return JEST_ERROR_BADPARAM;
+
+    memset(p, 0, sizeof(*p));
+    p->handler = handler;
+    p->userdata = userdata;
+    Jest__initSaxState(&p->state);
+
+    return JEST_ERROR_NONE;
+}
+
+Jest_Error Jest_initChunkParserJson(Jest_ChunkParser *p, Jest_JsonVal *out)
+{
+    if (!p || !out) return JEST_ERROR_BADPARAM;
+
+    static const Jest_SaxHandler dom_handler = {
+        Jest__domBeginObj, Jest__domEnd, Jest__domBeginArr, Jest__domEnd,
+        Jest__domKey, Jest__domStr, Jest__domNum, Jest__domBool, Jest__domNull
+    };
+
+    const Jest_Error err = Jest_initChunkParser(p, &dom_handler, &p->dom);
+    if (err) return err;
+
+    *out = Jest_jsonNull();
+    p->dom.out = out;
+    return JEST_ERROR_NONE;
+}
+
+Jest_Error Jest_chunkParserFeed(Jest_ChunkParser *p, const char *chunk, size_t len)
+{
+    if (!p || (!chunk && len)) return JEST_ERROR_BADPARAM;
+    if (p->err || p->state.expect == JEST__SAX_DONE || !len) return p->err;
+
+    // lex straight from the chunk unless part of a token is left over from the last one
+    const char *src = chunk;
+    size_t src_len = len;
+
+    if (p->len) {
+        if (p->len + len > p->cap) {
+            size_t cap = (p->cap)? p->cap : 4096;
+            while (cap < p->len + len) cap *= 2;
+
+            char *buf = (char *)realloc(p->buf, cap);
+            if (!buf) return p->err = JEST_ERROR_NOMEM;
+
+            p->buf = buf;
+            p->cap = cap;
+        }
+
+        memcpy(&p->buf[p->len], chunk, len);
+        p->len += len;
+        src = p->buf;
+        src_len = p->len;
+    }
+
+    const size_t consumed = Jest__chunkParserRun(p, src, src_len, false);
+    if (p->err) return p->err;
+
+    // hold on to the incomplete tail for the next chunk
+    const size_t tail = src_len - consumed;
+    if (src == p->buf) {
+        if (consumed) memmove(p->buf, &p->buf[consumed], tail);
+    } else if (tail) {
+        if (tail > p->cap) {
+            char *buf = (char *)realloc(p->buf, tail);
+            if (!buf) return p->err = JEST_ERROR_NOMEM;
+
+            p->buf = buf;
+            p->cap = tail;
+        }
+
+        memcpy(p->buf, &src[consumed], tail);
+    }
+
+    p->len = tail;
+    return JEST_ERROR_NONE;
+}
+
+Jest_Error Jest_chunkParserFinish(Jest_ChunkParser *p)
+{
+    if (!p) return JEST_ERROR_BADPARAM;
+    if (p->err) return p->err;
+
+    // whatever is left of a comment that never ended can't hold the rest of the value
+    if (p->state.expect != JEST__SAX_DONE && !p->comment) Jest__chunkParserRun(p, p->buf, p->len, true);
+    if (!p->err && p->state.expect != JEST__SAX_DONE) p->err = JEST_ERROR_SYNTAX;
+
+    p->len = 0;
+    p->scanned = 0;
+    p->comment = '\0';
+    return p->err;
+}
+
+void Jest_destroyChunkParser(Jest_ChunkParser *p)
+{
+    if (!p) return;
+
+    // a tree that was never finished is thrown away
+    while (p->dom.depth) {
+        --p->dom.depth;
+        Jest_destroyJsonVal(&p->dom.stack[p->dom.depth]);
+        free(p->dom.keys[p->dom.depth]);
+    }
+
+    if (p->dom.out && p->err) Jest_destroyJsonVal(p->dom.out);
+
+    free(p->dom.stack);
+    free(p->dom.keys);
+    free(p->dom.key_lens);
+    free(p->dom.key);
+    free(p->state.stack);
+    Jest_destroyLexer(&p->lexer);
+    free(p->buf);
+    memset(p, 0, sizeof(*p));
+}
+
+Jest_Error Jest_parseJsonLines(Jest_JsonLines *out, const char *buf, size_t len, unsigned nthreads)
+{
+    if (!out) return JEST_ERROR_BADPARAM;
+    memset(out, 0, sizeof(*out));
+    Jest_initArena(&out->arena, 0);
+    if (!buf) return JEST_ERROR_BADPARAM;
+
+    const unsigned n = Jest__workerThreads(nthreads, len);
+    Jest__ParseWorker *workers = (Jest__ParseWorker *)calloc(n, sizeof(*workers));
+    if (!workers) return JEST_ERROR_NOMEM;
+
+    JEST__STAT_PARSE_START(start);
+
+    // every worker gets about the same number of bytes, cut at the next newline
+    size_t off = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        const size_t end = (i + 1 == n)? len : Jest__linesBoundary(buf, len, ((i + 1) * (len / n) > off)? (i + 1) * (len / n) : off);
+
+        workers[i].run = Jest__linesWorkerRun;
+        workers[i].buf = &buf[off];
+        workers[i].len = end - off;
+        off = end;
+    }
+
+    Jest__runWorkers(workers, n);
+
+    Jest_Error err = JEST_ERROR_NONE;
+    size_t count = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        if (workers[i].err) err = workers[i].err;
+        count += workers[i].count;
+    }
+
+    if (!err && count) {
+        out->values = (Jest_JsonVal *)Jest_arenaAlloc(&out->arena, count * sizeof(*out->values));
+        out->errors = (Jest_Error *)Jest_arenaAlloc(&out->arena, count * sizeof(*out->errors));
+        if (!out->values || !out->errors) err = JEST_ERROR_NOMEM;
+    }
+
+    // the values already live in the workers' arenas, only the block lists are moved over
+    for (unsigned i = 0; i < n; ++i) {
+        if (!err && workers[i].count) {
+            memcpy(&out->values[out->count], workers[i].values, workers[i].count * sizeof(*out->values));
+            memcpy(&out->errors[out->count], workers[i].errors, workers[i].count * sizeof(*out->errors));
+            out->count += workers[i].count;
+            Jest__arenaSplice(&out->arena, &workers[i].arena);
+        }
+
+        Jest__resetWorker(&workers[i]);
+        Jest_destroyLexer(&workers[i].lexer);
+    }
+
+    free(workers);
+    if (err) Jest_destroyJsonLines(out);
+    JEST__STAT_PARSE_END(start);
+    return err;
+}
+
+Jest_Error Jest_parseJsonLinesCallback(const char *buf, size_t len, unsigned nthreads, Jest_JsonLineFn fn, void *userdata)
+{
+    if (!buf || !fn) return JEST_ERROR_BADPARAM;
+
+    const unsigned n = Jest__workerThreads(nthreads, len);
+    Jest__ParseWorker *workers = (Jest__ParseWorker *)calloc(n, sizeof(*workers));
+    if (!workers) return JEST_ERROR_NOMEM;
+
+    // input is handed out in batches so only a bounded amount of it is decoded at any time
+    Jest_Error err = JEST_ERROR_NONE;
+    size_t off = 0, idx = 0;
+    while (!err && off < len) {
+        for (unsigned i = 0; i < n; ++i) {
+            const size_t end = (len - off > JEST_LINES_BATCH_SIZE)? Jest__linesBoundary(buf, len, off + JEST_LINES_BATCH_SIZE) : len;
+
+            workers[i].run = Jest__linesWorkerRun;
+            workers[i].buf = &buf[off];
+            workers[i].len = end - off;
+            off = end;
+        }
+
+        // only the parsing is timed, not the callbacks
+        JEST__STAT_PARSE_START(start);
+        Jest__runWorkers(workers, n);
+        JEST__STAT_PARSE_END(start);
+
+        for (unsigned i = 0; i < n && !err; ++i) {
+            err = workers[i].err;
+
+            for (size_t j = 0; j < workers[i].count && !err; ++j) {
+                if (!fn(userdata, idx++, &workers[i].values[j], workers[i].errors[j])) err = JEST_ERROR_ABORTED;
+            }
+        }
+
+        for (unsigned i = 0; i < n; ++i) Jest__resetWorker(&workers[i]);
+    }
+
+    for (unsigned i = 0; i < n; ++i) Jest_destroyLexer(&workers[i].lexer);
+    free(workers);
+    return err;
+}
+
+Jest_Error Jest_parseJsonLinesFromPath(const char *path, unsigned nthreads, Jest_JsonLineFn fn, void *userdata)
+{
+    if (!path || !fn) return JEST_ERROR_BADPARAM;
+
+    Jest__FileBuf fb;
+    Jest_Error ret = Jest__loadFile(&fb, path);
+    if (ret) return ret;
+
+    ret = Jest_parseJsonLinesCallback(fb.data, fb.len, nthreads, fn, userdata);
+    Jest__releaseFile(&fb);
+    return ret;
+}
+
+void Jest_destroyJsonLines(Jest_JsonLines *lines)
+{
+    if (!lines) return;
+
+    Jest_destroyArena(&lines->arena);
+    lines->values = NULL;
+    lines->errors = NULL;
+    lines->count = 0;
+}
+
+static Jest_Error Jest__loadFile(Jest__FileBuf *fb, const char *path)
+{
+    memset(fb, 0, sizeof(*fb));
+
+#ifdef JEST__MMAP
+    JEST__STAT_START(start);
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return JEST_ERROR_IO;
+
+    struct stat st;
+    if (fstat(fd, &st)) st.st_size = 0;
+
+    if (S_ISREG(st.st_mode) && st.st_size > 0 && (uintmax_t)st.st_size >= JEST_MMAP_THRESHOLD && (uintmax_t)st.st_size <= SIZE_MAX) {
+        const size_t len = (size_t)st.st_size;
+        void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (map != MAP_FAILED) {
+#   if defined(MADV_SEQUENTIAL)
+            madvise(map, len, MADV_SEQUENTIAL);
+#   elif defined(POSIX_MADV_SEQUENTIAL)
+            posix_madvise(map, len, POSIX_MADV_SEQUENTIAL);
+#   endif
+
+            close(fd);
+            fb->data = (char *)map;
+            fb->len = len;
+            fb->mapped = true;
+
+            JEST__STAT(Jest__stats.read_time += Jest__statSince(start));
+            return JEST_ERROR_NONE;
+        }
+    }
+
+    // small files, pipes and anything that couldn't be mapped are read until they run dry,
+    // reads that a signal cut short are retried rather than taken as the file having failed
+    size_t cap = (st.st_size > 0 && (uintmax_t)st.st_size < SIZE_MAX - 2)? (size_t)st.st_size + 2 : JEST_READ_CHUNK_SIZE;
+    size_t len = 0;
+    Jest_Error err = JEST_ERROR_NONE;
+
+    char *buf = (char *)malloc(cap);
+    if (!buf) err = JEST_ERROR_NOMEM;
+
+    while (!err) {
+        const ssize_t got = read(fd, &buf[len], cap - len - 1);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) err = JEST_ERROR_IO;
+        if (got <= 0) break;
+
+        len += (size_t)got;
+        if (len + 1 < cap) continue;
+
+        char *grown = (char *)realloc(buf, cap * 2);
+        if (!grown) {
+            err = JEST_ERROR_NOMEM;
+            break;
+        }
+
+        buf = grown;
+        cap *= 2;
+    }
+
+    close(fd);
+    if (!err && !len) err = JEST_ERROR_IO;
+    if (err) {
+        free(buf);
+        return err;
+    }
+
+    buf[len] = '\0';
+    fb->data = buf;
+    fb->len = len;
+
+    JEST__STAT(Jest__stats.read_time += Jest__statSince(start));
+    return JEST_ERROR_NONE;
+#else
+    fb->len = Jest_readEntireFileFromPath(&fb->data, path);
+    return (fb->data)? JEST_ERROR_NONE : JEST_ERROR_IO;
+#endif // JEST__MMAP
+}
+
+static void Jest__releaseFile(Jest__FileBuf *fb)
+{
+#ifdef JEST__MMAP
+    if (fb->mapped) munmap(fb->data, fb->len);
+    else free(fb->data);
+#else
+    free(fb->data);
+#endif // JEST__MMAP
+
+    memset(fb, 0, sizeof(*fb));
+}
+
+static Jest_JsonVal *Jest__pathStepApply(const Jest_PathStep *step, Jest_JsonVal *val)
+{
+    if (step->key && val->type == JEST_JSONTYPE_OBJ) {
+        const size_t field = Jest__objFind(val, step->key, step->key_len, step->hash);
+        return (field < val->v.as_obj.nfields)? &val->v.as_obj.field_values[field] : NULL;
+    }
+
+    if (!step->key && val->type == JEST_JSONTYPE_ARR && step->idx < val->v.as_arr.len) {
+        return &val->v.as_arr.elems[step->idx];
+    }
+
+    return NULL;
+}
+
+static Jest_Error Jest__pathSetWalk(const Jest_PathSet *set, size_t node, Jest_JsonVal *val, Jest_JsonVal **ptr_out, Jest_JsonVal *copy_out)
+{
+    // either hand out pointers into the tree or copies of what was found
+    for (size_t i = set->nodes[node].first_end; i != JEST__PATH_NONE; i = set->next_end[i]) {
+        if (ptr_out) ptr_out[i] = val;
+        else if (copy_out[i].type == JEST_JSONTYPE_ERR) {
+            const Jest_Error err = Jest__cloneJsonVal(&copy_out[i], val);
+            if (err) return err;
+        }
+    }
+
+    for (size_t child = set->nodes[node].first_child; child != JEST__PATH_NONE; child = set->nodes[child].next_sibling) {
+        Jest_JsonVal *next = Jest__pathStepApply(set->nodes[child].step, val);
+        if (!next) continue;
+
+        const Jest_Error err = Jest__pathSetWalk(set, child, next, ptr_out, copy_out);
+        if (err) return err;
+    }
+
+    return JEST_ERROR_NONE;
+}
+
+static void Jest__pathSetForget(const Jest_PathSet *set, size_t node, Jest_JsonVal *out)
+{
+    for (size_t i = set->nodes[node].first_end; i != JEST__PATH_NONE; i = set->next_end[i]) {
+        if (out[i].type == JEST_JSONTYPE_ERR) continue;
+
+        Jest_destroyJsonVal(&out[i]);
+        out[i].type = JEST_JSONTYPE_ERR;
+        out[i].v.as_err = JEST_ERROR_BADPARAM;
+    }
+
+    for (size_t child = set->nodes[node].first_child; child != JEST__PATH_NONE; child = set->nodes[child].next_sibling) {
+        Jest__pathSetForget(set, child, out);
+    }
+}
+
+static Jest_Error Jest__pathSetExtractNode(const Jest_PathSet *set, size_t node, Jest_Lexer *l, Jest_JsonVal *out)
+{
+    const Jest__PathNode *n = &set->nodes[node];
+    Jest_Error err = JEST_ERROR_NONE;
+
+    // the last of duplicate keys wins like it does in a tree, so whatever an earlier one left here goes
+    Jest__pathSetForget(set, node, out);
+
+    // a value that some path ends at is built once, anything below it is copied out of that tree
+    if (n->first_end != JEST__PATH_NONE) {
+        Jest_JsonVal *val = &out[n->first_end];
+
+        Jest__ParseCtx ctx = {l, NULL, false, NULL};
+        err = Jest__parseVal(val, &ctx);
+        if (err) {
+            val->type = JEST_JSONTYPE_ERR;
+            return err;
+        }
+
+        return Jest__pathSetWalk(set, node, val, NULL, out);
+    }
+
+    if (n->first_child == JEST__PATH_NONE || (l->type != '{' && l->type != '[')) return Jest__lexerSkipVal(l);
+
+    const bool is_obj = l->type == '{';
+    const char close = (is_obj)? '}' : ']';
+    size_t idx = 0;
+
+    Jest_lexerStep(l);
+    while (l->type != close) {
+        size_t child = n->first_child;
+
+        if (is_obj) {
+            if (l->type != JEST_LEXEME_STR && l->type != JEST_LEXEME_IDENT) return JEST_ERROR_SYNTAX;
+
+            const char *key = (l->type == JEST_LEXEME_STR)? l->strval : &l->filebuf[l->ident_start];
+            const size_t key_len = (l->type == JEST_LEXEME_STR)? l->strval_len : l->ident_len;
+
+            // fan-out is small enough that comparing lengths first beats hashing every key
+            for (; child != JEST__PATH_NONE; child = set->nodes[child].next_sibling) {
+                const Jest_PathStep *step = set->nodes[child].step;
+                if (step->key && step->key_len == key_len && !memcmp(step->key, key, key_len)) break;
+            }
+
+            Jest_lexerStep(l);
+            if (l->type != ':') return JEST_ERROR_SYNTAX;
+            Jest_lexerStep(l);
+        } else {
+            for (; child != JEST__PATH_NONE; child = set->nodes[child].next_sibling) {
+                if (!set->nodes[child].step->key && set->nodes[child].step->idx == idx) break;
+            }
+
+            ++idx;
+        }
+
+        err = (child != JEST__PATH_NONE)
+            ? Jest__pathSetExtractNode(set, child, l, out)
+            : Jest__lexerSkipVal(l);
+        if (err) return err;
+
+        if (l->type == ',') Jest_lexerStep(l);
+        else if (l->type != close) return JEST_ERROR_SYNTAX;
+    }
+
+    Jest_lexerStep(l);
+    return JEST_ERROR_NONE;
+}
+
+static Jest_Error Jest__lexerSkipVal(Jest_Lexer *l)
+{
+    size_t depth = 0;
+
+    do {
+        switch (l->type) {
+            case '{':
+            case '[':
+                ++depth;
+                break;
+
+            case '}':
+            case ']':
+                if (!depth) return JEST_ERROR_SYNTAX;
+                --depth;
+                break;
+
+            case ':':
+            case ',':
+                if (!depth) return JEST_ERROR_SYNTAX;
+                break;
+
+            case JEST_LEXEME_ERR:
+            case JEST_LEXEME_EOF:
+                return JEST_ERROR_SYNTAX;
+
+            default: break;
+        }
+
+        Jest_lexerStep(l);
+    } while (depth);
+
+    return JEST_ERROR_NONE;
+}
+
+static Jest_Error Jest__cloneShallow(Jest_JsonVal *out, const Jest_JsonVal *src)
+{
+    *out = *src;
+    out->flags = 0;
+
+    switch (src->type) {
+        case JEST_JSONTYPE_STR:
+            out->v.as_str.data = Jest__strndup(NULL, src->v.as_str.data, src->v.as_str.len);
+            return (out->v.as_str.data)? JEST_ERROR_NONE : JEST_ERROR_NOMEM;
+
+        case JEST_JSONTYPE_ARR: *out = Jest_jsonArray(); break;
+        case JEST_JSONTYPE_OBJ: *out = Jest_jsonObj(); break;
+        default: break;
+    }
+
+    return JEST_ERROR_NONE;
+}
+
+static Jest_Error Jest__cloneJsonVal(Jest_JsonVal *out, const Jest_JsonVal *src)
+{
+    Jest_Error err = Jest__cloneShallow(out, src);
+    if (err || (src->type != JEST_JSONTYPE_ARR && src->type != JEST_JSONTYPE_OBJ)) return err;
+
+    // nested containers go on an explicit stack, each one is added to its parent empty and filled in from there
+    Jest__CloneFrame local[JEST__LOCAL_FRAMES];
+    Jest__CloneFrame *stack = local;
+    size_t depth = 1, cap = JEST__LOCAL_FRAMES;
+
+    stack[0].src = src;
+    stack[0].dst = out;
+    stack[0].idx = 0;
+
+    while (depth) {
+        Jest__CloneFrame *top = &stack[depth - 1];
+        const Jest_JsonVal *from = top->src;
+        Jest_JsonVal *to = top->dst;
+        const bool is_arr = from->type == JEST_JSONTYPE_ARR;
+
+        if (top->idx == ((is_arr)? from->v.as_arr.len : from->v.as_obj.nfields)) {
+            --depth;
+            continue;
+        }
+
+        const size_t i = top->idx++;
+        const Jest_JsonVal *child = (is_arr)? &from->v.as_arr.elems[i] : &from->v.as_obj.field_values[i];
+
+        Jest_JsonVal copy;
+        err = Jest__cloneShallow(&copy, child);
+        if (err) break;
+
+        const char *name = (is_arr)? NULL : from->v.as_obj.field_names[i];
+        const size_t name_len = (is_arr)? 0 : from->v.as_obj.fn_lens[i];
+        const size_t nfields = (is_arr)? 0 : to->v.as_obj.nfields;
+
+        if (is_arr) err = Jest__arrayAppend(NULL, to, &copy);
+        else {
+            char *name_copy = Jest__strndup(NULL, name, name_len);
+            err = (name_copy)? Jest__objAdd(NULL, to, name_copy, name_len, copy) : JEST_ERROR_NOMEM;
+        }
+
+        if (err) {
+            Jest_destroyJsonVal(&copy);
+            break;
+        }
+
+        if (child->type != JEST_JSONTYPE_ARR && child->type != JEST_JSONTYPE_OBJ) continue;
+
+        // a name that's there already has its value replaced where it is
+        Jest_JsonVal *added;
+        if (is_arr) added = &to->v.as_arr.elems[to->v.as_arr.len - 1];
+        else if (to->v.as_obj.nfields > nfields) added = &to->v.as_obj.field_values[nfields];
+        else added = &to->v.as_obj.field_values[Jest__objFind(to, name, name_len, Jest__hashStr(name, name_len))];
+
+        if (depth == cap) {
+            Jest__CloneFrame *grown = (Jest__CloneFrame *)Jest__growStack(stack, local, &cap, sizeof(*stack));
+            if (!grown) {
+                err = JEST_ERROR_NOMEM;
+                break;
+            }
+
+            stack = grown;
+        }
+
+        stack[depth].src = child;
+        stack[depth].dst = added;
+        stack[depth].idx = 0;
+        ++depth;
+    }
+
+    if (stack != local) free(stack);
+    if (err) Jest_destroyJsonVal(out);
+    return err;
+}
+
+static bool Jest__tapePush(Jest_Tape *tape, char tag, size_t payload)
+{
+    if (tape->len + 1 > tape->cap) {
+        const size_t cap = (tape->cap)? tape->cap * 2 : 256;
+        uint64_t *entries = (uint64_t *)realloc(tape->entries, sizeof(*entries) * cap);
+        if (!entries) return false;
+
+        tape->entries = entries;
+        tape->cap = cap;
+    }
+
+    tape->entries[tape->len++] = JEST__TAPE_ENTRY(tag, payload);
+    return true;
+}
+
+static Jest_Error Jest__tapeAppendVal(Jest_Tape *tape, const Jest_JsonVal *val)
+{
+    // nested containers go on an explicit stack, and until a container is closed its opening entry
+    // holds the position of the opening entry of its parent, so only the innermost one is kept here
+    Jest__WalkFrame local[JEST__LOCAL_FRAMES];
+    Jest__WalkFrame *stack = local;
+    size_t depth = 0, cap = JEST__LOCAL_FRAMES;
+    size_t open = 0;
+    Jest_Error err = JEST_ERROR_NONE;
+
+    while (val) {
+        bool ok = true;
+        switch (val->type) {
+            case JEST_JSONTYPE_NULL: ok = Jest__tapePush(tape, 'n', 0); break;
+            case JEST_JSONTYPE_BOOL: ok = Jest__tapePush(tape, (val->v.as_bool)? 't' : 'f', 0); break;
+            case JEST_JSONTYPE_NUM:  ok = Jest__tapePushNum(tape, val->v.as_num); break;
+            case JEST_JSONTYPE_STR:  ok = Jest__tapePushStr(tape, val->v.as_str.data, val->v.as_str.len); break;
+
+            case JEST_JSONTYPE_ARR:
+            case JEST_JSONTYPE_OBJ:
+                if (depth == cap) {
+                    Jest__WalkFrame *grown = (Jest__WalkFrame *)Jest__growStack(stack, local, &cap, sizeof(*stack));
+                    if (!grown) {
+                        ok = false;
+                        break;
+                    }
+
+                    stack = grown;
+                }
+
+                ok = Jest__tapePush(tape, (val->type == JEST_JSONTYPE_OBJ)? '{' : '[', open);
+                open = tape->len - 1;
+
+                stack[depth].val = val;
+                stack[depth].idx = 0;
+                ++depth;
+                break;
+
+            default: err = JEST_ERROR_BADPARAM; break;
+        }
+
+        if (!ok) err = JEST_ERROR_NOMEM;
+        if (err) break;
+
+        // close containers that are done until one has an element left, which goes next
+        val = NULL;
+        while (depth && !val) {
+            Jest__WalkFrame *top = &stack[depth - 1];
+            const bool is_obj = top->val->type == JEST_JSONTYPE_OBJ;
+            const size_t count = (is_obj)? top->val->v.as_obj.nfields : top->val->v.as_arr.len;
+
+            if (top->idx < count) {
+                const size_t i = top->idx++;
+                if (is_obj && !Jest__tapePushStr(tape, top->val->v.as_obj.field_names[i], top->val->v.as_obj.fn_lens[i])) {
+                    err = JEST_ERROR_NOMEM;
+                    break;
+                }
+
+                val = (is_obj)? &top->val->v.as_obj.field_values[i] : &top->val->v.as_arr.elems[i];
+                continue;
+            }
+
+            const size_t parent = JEST__TAPE_PAYLOAD(tape->entries[open]);
+            if (!Jest__tapePush(tape, (is_obj)? '}' : ']', count)) {
+                err = JEST_ERROR_NOMEM;
+                break;
+            }
+
+            tape->entries[open] = JEST__TAPE_ENTRY((is_obj)? '{' : '[', tape->len);
+            open = parent;
+            --depth;
+        }
+    }
+
+    if (stack != local) free(stack);
+    return err;
+}
+
+static Jest_Error Jest__tapeShallow(Jest_JsonVal *out, const Jest_Tape *tape, size_t pos)
+{
+    switch (JEST__TAPE_TAG(tape->entries[pos])) {
+        case 'n': *out = Jest_jsonNull(); return JEST_ERROR_NONE;
+        case 't': *out = Jest_jsonBool(true); return JEST_ERROR_NONE;
+        case 'f': *out = Jest_jsonBool(false); return JEST_ERROR_NONE;
+        case 'd': *out = Jest_jsonNumber(Jest_tapeNum(tape, pos)); return JEST_ERROR_NONE;
+        case '[':
+        case '{': break;
+
+        case '"': {
+            size_t len;
+            const char *str = Jest_tapeStr(tape, pos, &len);
+
+            *out = Jest_jsonNull();
+            out->v.as_str.data = Jest__strndup(NULL, str, len);
+            if (!out->v.as_str.data) return JEST_ERROR_NOMEM;
+
+            out->type = JEST_JSONTYPE_STR;
+            out->v.as_str.len = len;
+            return JEST_ERROR_NONE;
+        }
+
+        default: return JEST_ERROR_BADPARAM;
+    }
+
+    // the closing entry has the element count, so containers get exactly the room they need up front
+    const size_t count = Jest_tapeCount(tape, pos);
+    if (JEST__TAPE_TAG(tape->entries[pos]) == '[') {
+        *out = Jest_jsonArray();
+        if (!count) return JEST_ERROR_NONE;
+
+        out->v.as_arr.elems = (Jest_JsonVal *)Jest__alloc(NULL, sizeof(*out->v.as_arr.elems) * count);
+        if (!out->v.as_arr.elems) return JEST_ERROR_NOMEM;
+
+        out->v.as_arr.cap = count;
+        return JEST_ERROR_NONE;
+    }
+
+    *out = Jest_jsonObj();
+    if (!count) return JEST_ERROR_NONE;
+
+    out->v.as_obj.field_names = (char **)Jest__alloc(NULL, sizeof(*out->v.as_obj.field_names) * count);
+    out->v.as_obj.fn_lens = (size_t *)Jest__alloc(NULL, sizeof(*out->v.as_obj.fn_lens) * count);
+    out->v.as_obj.field_values = (Jest_JsonVal *)Jest__alloc(NULL, sizeof(*out->v.as_obj.field_values) * count);
+    if (!out->v.as_obj.field_names || !out->v.as_obj.fn_lens || !out->v.as_obj.field_values) {
+        Jest_destroyJsonVal(out);
+        return JEST_ERROR_NOMEM;
+    }
+
+    out->v.as_obj.nalloced = count;
+    return JEST_ERROR_NONE;
+}
+
+static bool Jest__tapePushStr(Jest_Tape *tape, const char *str, size_t len)
+{
+    const size_t need = tape->strs_len + sizeof(len) + len + 1;
+    if (need > tape->strs_cap) {
+        size_t cap = (tape->strs_cap)? tape->strs_cap * 2 : 4096;
+        while (cap < need) cap *= 2;
+
+        char *strs = (char *)realloc(tape->strs, cap);
+        if (!strs) return false;
+
+        tape->strs = strs;
+        tape->strs_cap = cap;
+    }
+
+    if (!Jest__tapePush(tape, '"', tape->strs_len)) return false;
+
+    memcpy(&tape->strs[tape->strs_len], &len, sizeof(len));
+    if (len) memcpy(&tape->strs[tape->strs_len + sizeof(len)], str, len);
+    tape->strs[tape->strs_len + sizeof(len) + len] = '\0';
+
+    tape->strs_len = need;
+    return true;
+}
+
+static bool Jest__tapePushNum(Jest_Tape *tape, double val)
+{
+    if (!Jest__tapePush(tape, 'd', 0) || !Jest__tapePush(tape, 0, 0)) return false;
+
+    memcpy(&tape->entries[tape->len - 1], &val, sizeof(val));
+    return true;
+}
+
+static bool Jest__tapeBuilderBegin(Jest__TapeBuilder *b, char tag)
+{
+    Jest__tapeBuilderValue(b);
+
+    if (b->depth + 1 > b->cap) {
+        const size_t cap = (b->cap)? b->cap * 2 : 32;
+        size_t *stack = (size_t *)realloc(b->stack, sizeof(*stack) * 2 * cap);
+        if (!stack) {
+            b->err = JEST_ERROR_NOMEM;
+            return false;
+        }
+
+        b->stack = stack;
+        b->cap = cap;
+    }
+
+    b->stack[b->depth * 2] = b->tape->len;
+    b->stack[b->depth * 2 + 1] = 0;
+    ++b->depth;
+
+    if (!Jest__tapePush(b->tape, tag, 0)) b->err = JEST_ERROR_NOMEM;
+    return !b->err;
+}
+
+static bool Jest__tapeBuilderEnd(Jest__TapeBuilder *b, char tag)
+{
+    --b->depth;
+    const size_t open = b->stack[b->depth * 2];
+
+    if (!Jest__tapePush(b->tape, tag, b->stack[b->depth * 2 + 1])) {
+        b->err = JEST_ERROR_NOMEM;
+        return false;
+    }
+
+    b->tape->entries[open] = JEST__TAPE_ENTRY((tag == '}')? '{' : '[', b->tape->len);
+    return true;
+}
+
+static void Jest__tapeBuilderValue(Jest__TapeBuilder *b)
+{
+    // fields are counted by their keys
+    if (b->depth && JEST__TAPE_TAG(b->tape->entries[b->stack[(b->depth - 1) * 2]]) == '[') ++b->stack[(b->depth - 1) * 2 + 1];
+}
+
+static bool Jest__tapeBeginObj(void *userdata)
+{
+    return Jest__tapeBuilderBegin((Jest__TapeBuilder *)userdata, '{');
+}
+
+static bool Jest__tapeEndObj(void *userdata)
+{
+    return Jest__tapeBuilderEnd((Jest__TapeBuilder *)userdata, '}');
+}
+
+static bool Jest__tapeBeginArr(void *userdata)
+{
+    return Jest__tapeBuilderBegin((Jest__TapeBuilder *)userdata, '[');
+}
+
+static bool Jest__tapeEndArr(void *userdata)
+{
+    return Jest__tapeBuilderEnd((Jest__TapeBuilder *)userdata, ']');
+}
+
+static bool Jest__tapeKey(void *userdata, const char *str, size_t len)
+{
+    Jest__TapeBuilder *b = (Jest__TapeBuilder *)userdata;
+
+    ++b->stack[(b->depth - 1) * 2 + 1];
+    if (!Jest__tapePushStr(b->tape, str, len)) b->err = JEST_ERROR_NOMEM;
+    return !b->err;
+}
+
+static bool Jest__tapeStr(void *userdata, const char *str, size_t len)
+{
+    Jest__TapeBuilder *b = (Jest__TapeBuilder *)userdata;
+
+    Jest__tapeBuilderValue(b);
+    if (!Jest__tapePushStr(b->tape, str, len)) b->err = JEST_ERROR_NOMEM;
+    return !b->err;
+}
+
+static bool Jest__tapeNum(void *userdata, double val)
+{
+    Jest__TapeBuilder *b = (Jest__TapeBuilder *)userdata;
+
+    Jest__tapeBuilderValue(b);
+    if (!Jest__tapePushNum(b->tape, val)) b->err = JEST_ERROR_NOMEM;
+    return !b->err;
+}
+
+static bool Jest__tapeBool(void *userdata, bool val)
+{
+    Jest__TapeBuilder *b = (Jest__TapeBuilder *)userdata;
+
+    Jest__tapeBuilderValue(b);
+    if (!Jest__tapePush(b->tape, (val)? 't' : 'f', 0)) b->err = JEST_ERROR_NOMEM;
+    return !b->err;
+}
+
+static bool Jest__tapeNull(void *userdata)
+{
+    Jest__TapeBuilder *b = (Jest__TapeBuilder *)userdata;
+
+    Jest__tapeBuilderValue(b);
+    if (!Jest__tapePush(b->tape, 'n', 0)) b->err = JEST_ERROR_NOMEM;
+    return !b->err;
+}
+
+static void *Jest__growStack(void *stack, const void *local, size_t *cap, size_t elem_sz)
+{
+    void *grown = (stack == local)? malloc(*cap * 2 * elem_sz) : realloc(stack, *cap * 2 * elem_sz);
+    if (!grown) return NULL;
+
+    if (stack == local) memcpy(grown, local, *cap * elem_sz);
+    *cap *= 2;
+    return grown;
+}
+
+static void *Jest__alloc(Jest_Arena *arena, size_t sz)
+{
+    JEST__STAT(++Jest__stats.allocs; Jest__stats.alloc_bytes += sz);
+    return (arena)? Jest_arenaAlloc(arena, sz) : malloc(sz);
+}
+
+static void *Jest__realloc(Jest_Arena *arena, void *ptr, size_t old_sz, size_t new_sz)
+{
+    JEST__STAT(++Jest__stats.reallocs; if (new_sz > old_sz) Jest__stats.alloc_bytes += new_sz - old_sz);
+    return (arena)? Jest__arenaRealloc(arena, ptr, old_sz, new_sz) : realloc(ptr, new_sz);
+}
+
+static void Jest__free(Jest_Arena *arena, void *ptr)
+{
+    // arena allocations are only freed along with the whole arena
+    if (!arena) free(ptr);
+}
+
+static char *Jest__strndup(Jest_Arena *arena, const char *str, size_t len)
+{
+    if (!str) return NULL;
+    JEST__STAT(++Jest__stats.allocs; Jest__stats.alloc_bytes += len + 1);
+    if (!arena) return Jest_strndup(str, len);
+
+    // strings don't need any alignment
+    char *ret = (char *)Jest__arenaAllocAligned(arena, len + 1, 1);
+    if (!ret) return NULL;
+
+    memcpy(ret, str, len);
+    ret[len] = '\0';
+    return ret;
+}
+
+static void *Jest__arenaAllocAligned(Jest_Arena *arena, size_t sz, size_t align)
+{
+    if (!arena) return NULL;
+    if (!sz) sz = 1;
+
+    const size_t block_sz = JEST__ARENA_BLOCK_SZ(arena);
+
+    // large allocations get a block of their own so that Jest__arenaRealloc can grow them with realloc
+    if (sz > block_sz / 4) {
+        struct Jest__ArenaBlock *block = Jest__arenaSpare(arena, sz);
+        if (!block) {
+            block = (struct Jest__ArenaBlock *)malloc(JEST__ARENA_HDR_SZ + sz);
+            if (!block) return NULL;
+            block->cap = sz;
+        }
+
+        // the whole block counts as used, nothing else may end up behind the allocation
+        block->used = block->cap;
+        block->prev = arena->head;
+        block->next = (arena->head)? arena->head->next : NULL;
+
+        if (block->next) block->next->prev = block;
+        if (arena->head) arena->head->next = block;
+        else arena->head = block;
+
+        return JEST__ARENA_DATA(block);
+    }
+
+    struct Jest__ArenaBlock *head = arena->head;
+    size_t start = (head)? (head->used + align - 1) & ~(align - 1) : 0;
+
+    if (!head || start + sz > head->cap) {
+        head = Jest__arenaSpare(arena, block_sz);
+        if (!head) {
+            head = (struct Jest__ArenaBlock *)malloc(JEST__ARENA_HDR_SZ + block_sz);
+            if (!head) return NULL;
+            head->cap = block_sz;
+        }
+
+        head->used = 0;
+        head->prev = NULL;
+        head->next = arena->head;
+        if (arena->head) arena->head->prev = head;
+        arena->head = head;
+
+        start = 0;
+    }
+
+    head->used = start + sz;
+    return JEST__ARENA_DATA(head) + start;
+}
+
+static struct Jest__ArenaBlock *Jest__arenaSpare(Jest_Arena *arena, size_t sz)
+{
+    // best fit, so that regular blocks don't use up the big ones that large allocations were given before
+    struct Jest__ArenaBlock **best = NULL;
+    for (struct Jest__ArenaBlock **link = &arena->spare; *link; link = &(*link)->next) {
+        if ((*link)->cap < sz || (best && (*best)->cap <= (*link)->cap)) continue;
+
+        best = link;
+        if ((*link)->cap == sz) break;
+    }
+
+    if (!best) return NULL;
+
+    struct Jest__ArenaBlock *block = *best;
+    *best = block->next;
+    return block;
+}
+
+static void *Jest__arenaRealloc(Jest_Arena *arena, void *ptr, size_t old_sz, size_t new_sz)
+{
+    if (!arena) return NULL;
+    if (!ptr) return Jest_arenaAlloc(arena, new_sz);
+    if (new_sz <= old_sz) return ptr;
+
+    const size_t block_sz = JEST__ARENA_BLOCK_SZ(arena);
+    struct Jest__ArenaBlock *head = arena->head;
+
+    // grow the last allocation of the current block in place while it still counts as a small allocation
+    if (new_sz <= block_sz / 4 && (char *)ptr + old_sz == JEST__ARENA_DATA(head) + head->used) {
+        if (head->used - old_sz + new_sz <= head->cap) {
+            head->used += new_sz - old_sz;
+            return ptr;
+        }
+    }
+
+    // large allocations own their block so the block itself can be reallocated
+    if (old_sz > block_sz / 4) {
+        struct Jest__ArenaBlock *block = (struct Jest__ArenaBlock *)((char *)ptr - JEST__ARENA_HDR_SZ);
+
+        // a recycled block may already be big enough, or there may be a spare one that is
+        if (new_sz <= block->cap) return ptr;
+
+        struct Jest__ArenaBlock *spare = Jest__arenaSpare(arena, new_sz);
+        if (spare) {
+            memcpy(JEST__ARENA_DATA(spare), ptr, old_sz);
+            spare->used = spare->cap;
+            spare->prev = block->prev;
+            spare->next = block->next;
+            if (spare->prev) spare->prev->next = spare;
+            else arena->head = spare;
+            if (spare->next) spare->next->prev = spare;
+
+            block->prev = NULL;
+            block->next = arena->spare;
+            arena->spare = block;
+            return JEST__ARENA_DATA(spare);
+        }
+
+        block = (struct Jest__ArenaBlock *)realloc(block, JEST__ARENA_HDR_SZ + new_sz);
+        if (!block) return NULL;
+
+        block->used = block->cap = new_sz;
+        if (block->prev) block->prev->next = block;
+        else arena->head = block;
+        if (block->next) block->next->prev = block;
+
+        return JEST__ARENA_DATA(block);
+    }
+
+    void *ret = Jest_arenaAlloc(arena, new_sz);
+    if (!ret) return NULL;
+
+    memcpy(ret, ptr, old_sz);
+    return ret;
+}
+
+static Jest_Error Jest__arrayAppend(Jest_Arena *arena, Jest_JsonVal *arr, const Jest_JsonVal *elem)
+{
+    if (!arr || !elem || arr == elem) return JEST_ERROR_BADPARAM;
+    if (arr->type != JEST_JSONTYPE_ARR) return JEST_ERROR_BADPARAM;
+
+    if (arr->v.as_arr.len + 1 > arr->v.as_arr.cap) {
+        JEST__STAT(++Jest__stats.array_grows);
+        const size_t cap = (arr->v.as_arr.cap)? arr->v.as_arr.cap * 2 : 32;
+        Jest_JsonVal *elems = (Jest_JsonVal *)Jest__realloc(arena, arr->v.as_arr.elems,
+            sizeof(*elems) * arr->v.as_arr.cap, sizeof(*elems) * cap);
+        if (!elems) return JEST_ERROR_NOMEM;
+
+        arr->v.as_arr.elems = elems;
+        arr->v.as_arr.cap = cap;
+    }
+
+    memcpy(&arr->v.as_arr.elems[arr->v.as_arr.len++], elem, sizeof(*elem));
+    return JEST_ERROR_NONE;
+}
+
+static uint64_t Jest__hashStr(const char *str, size_t len)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (uint8_t)str[i];
+        hash *= UINT64_C(0x100000001b3);
+    }
+
+    return hash;
+}
+
+static char *Jest__internKey(Jest_Arena *arena, Jest__InternTable **table, const char *name, size_t len)
+{
+    Jest__InternTable *t = *table;
+    if (!t) {
+        t = (Jest__InternTable *)Jest_arenaAlloc(arena, sizeof(*t));
+        if (!t) return NULL;
+
+        memset(t, 0, sizeof(*t));
+        *table = t;
+    }
+
+    // kept at most half full, the old slots are left behind in the arena when it grows
+    if ((t->count + 1) * 2 > t->cap) {
+        const size_t cap = (t->cap)? t->cap * 2 : 64;
+        Jest__InternSlot *slots = (Jest__InternSlot *)Jest_arenaAlloc(arena, cap * sizeof(*slots));
+        if (!slots) return NULL;
+        memset(slots, 0, cap * sizeof(*slots));
+
+        for (size_t i = 0; i < t->cap; ++i) {
+            if (!t->slots[i].name) continue;
+
+            size_t slot = (size_t)t->slots[i].hash & (cap - 1);
+            while (slots[slot].name) slot = (slot + 1) & (cap - 1);
+            slots[slot] = t->slots[i];
+        }
+
+        t->slots = slots;
+        t->cap = cap;
+    }
+
+    const uint64_t hash = Jest__hashStr(name, len);
+    size_t slot = (size_t)hash & (t->cap - 1);
+    for (; t->slots[slot].name; slot = (slot + 1) & (t->cap - 1)) {
+        const Jest__InternSlot *e = &t->slots[slot];
+        if (e->hash == hash && e->len == len && !memcmp(e->name, name, len)) return e->name;
+    }
+
+    char *copy = Jest__strndup(arena, name, len);
+    if (!copy) return NULL;
+
+    t->slots[slot].name = copy;
+    t->slots[slot].len = len;
+    t->slots[slot].hash = hash;
+    ++t->count;
+    return copy;
+}
+
+static size_t Jest__objIndexCap(size_t nalloced)
+{
+    // keep the load factor at or below 1/2
+    size_t cap = 32;
+    while (cap < 2 * nalloced) cap <<= 1;
+    return cap;
+}
+
+static void Jest__objIndexInsert(Jest_JsonVal *obj, size_t field, uint64_t hash)
+{
+    // a slot holds the upper half of the hash and field + 1, so 0 marks an empty slot
+    const size_t mask = Jest__objIndexCap(obj->v.as_obj.nalloced) - 1;
+    size_t slot = (size_t)hash & mask;
+
+    while (obj->v.as_obj.index[slot]) slot = (slot + 1) & mask;
+    obj->v.as_obj.index[slot] = (hash & UINT64_C(0xffffffff00000000)) | (uint64_t)(field + 1);
+}
+
+static Jest_Error Jest__objBuildIndex(Jest_Arena *arena, Jest_JsonVal *obj)
+{
+    const size_t cap = Jest__objIndexCap(obj->v.as_obj.nalloced);
+
+    uint64_t *index = (uint64_t *)Jest__alloc(arena, sizeof(*index) * cap);
+    if (!index) return JEST_ERROR_NOMEM;
+    memset(index, 0, sizeof(*index) * cap);
+
+    Jest__free(arena, obj->v.as_obj.index);
+    obj->v.as_obj.index = index;
+
+    for (size_t i = 0; i < obj->v.as_obj.nfields; ++i) {
+        Jest__objIndexInsert(obj, i, Jest__hashStr(obj->v.as_obj.field_names[i], obj->v.as_obj.fn_lens[i]));
+    }
+
+    return JEST_ERROR_NONE;
+}
+
+static size_t Jest__objFind(const Jest_JsonVal *obj, const char *name, size_t name_len, uint64_t hash)
+{
+    if (!obj->v.as_obj.index) {
+        for (size_t i = 0; i < obj->v.as_obj.nfields; ++i) {
+            // interned names are found without looking at the bytes
+            if (obj->v.as_obj.field_names[i] == name) return i;
+            if (obj->v.as_obj.fn_lens[i] == name_len && !memcmp(obj->v.as_obj.field_names[i], name, name_len)) {
+                return i;
+            }
+        }
+
+        return (size_t)-1;
+    }
+
+    const size_t mask = Jest__objIndexCap(obj->v.as_obj.nalloced) - 1;
+    const uint64_t tag = hash & UINT64_C(0xffffffff00000000);
+
+    for (size_t slot = (size_t)hash & mask; obj->v.as_obj.index[slot]; slot = (slot + 1) & mask) {
+        if ((obj->v.as_obj.index[slot] & UINT64_C(0xffffffff00000000)) != tag) continue;
+
+        const size_t i = (size_t)(obj->v.as_obj.index[slot] & UINT64_C(0xffffffff)) - 1;
+        if (obj->v.as_obj.fn_lens[i] == name_len && !memcmp(obj->v.as_obj.field_names[i], name, name_len)) {
+            return i;
+        }
+    }
+
+    return (size_t)-1;
+}
+
+static Jest_Error Jest__objAdd(Jest_Arena *arena, Jest_JsonVal *obj, char *field_name, size_t name_len, Jest_JsonVal value)
+{
+    if (!obj || !field_name) return JEST_ERROR_BADPARAM;
+    if (obj->type != JEST_JSONTYPE_OBJ) return JEST_ERROR_BADPARAM;
+
+    const uint64_t hash = Jest__hashStr(field_name, name_len);
+    const size_t existing = Jest__objFind(obj, field_name, name_len, hash);
+
+    if (existing != (size_t)-1) {
+        Jest_destroyJsonVal(&obj->v.as_obj.field_values[existing]);
+        memcpy(&obj->v.as_obj.field_values[existing], &value, sizeof(value));
+        Jest__free(arena, field_name);
+        return JEST_ERROR_NONE;
+    }
+
+    if (obj->v.as_obj.nfields + 1 > obj->v.as_obj.nalloced) {
+        JEST__STAT(++Jest__stats.obj_grows);
+        const size_t old_n = obj->v.as_obj.nalloced;
+        const size_t new_n = (old_n)? 2 * old_n : 16;
+
+        char **names = (char **)Jest__realloc(arena, obj->v.as_obj.field_names, sizeof(*names) * old_n, sizeof(*names) * new_n);
+        if (names) obj->v.as_obj.field_names = names;
+
+        size_t *lens = (size_t *)Jest__realloc(arena, obj->v.as_obj.fn_lens, sizeof(*lens) * old_n, sizeof(*lens) * new_n);
+        if (lens) obj->v.as_obj.fn_lens = lens;
+
+        Jest_JsonVal *values = (Jest_JsonVal *)Jest__realloc(arena, obj->v.as_obj.field_values, sizeof(*values) * old_n, sizeof(*values) * new_n);
+        if (values) obj->v.as_obj.field_values = values;
+
+        if (!names || !lens || !values) {
+            Jest__free(arena, field_name);
+            return JEST_ERROR_NOMEM;
+        }
+
+        obj->v.as_obj.nalloced = new_n;
+
+        // the index is sized by nalloced, so it gets rebuilt below
+        Jest__free(arena, obj->v.as_obj.index);
+        obj->v.as_obj.index = NULL;
+    }
+
+    const size_t field = obj->v.as_obj.nfields++;
+    obj->v.as_obj.fn_lens[field] = name_len;
+    obj->v.as_obj.field_names[field] = field_name;
+    memcpy(&obj->v.as_obj.field_values[field], &value, sizeof(value));
+
+    if (obj->v.as_obj.index) {
+        Jest__objIndexInsert(obj, field, hash);
+    } else if (obj->v.as_obj.nfields >= JEST_OBJ_INDEX_THRESHOLD) {
+        // without the index, lookups just fall back to a linear scan so running out of memory here isn't fatal
+        Jest__objBuildIndex(arena, obj);
+    }
+
+    return JEST_ERROR_NONE;
+}
+
+static bool Jest__isWhiteSpace(char c)
+{
+    return Jest__charClass[(unsigned char)c] & JEST__CC_SPACE;
+}
+
+static size_t Jest__scanWhiteSpaceScalar(const char *buf, size_t offset, size_t end)
+{
+    while (offset < end && Jest__isWhiteSpace(buf[offset])) ++offset;
+    return offset;
+}
+
+static size_t Jest__scanStrScalar(const char *buf, size_t offset, size_t end, char quot)
+{
+    while (offset < end && buf[offset] != quot && buf[offset] != '\\') ++offset;
+    return offset;
+}
+
+// finds the next byte Jest__lexerSkipContainer cares about, a bracket, a comma, a quote or a slash
+static size_t Jest__scanStructuralScalar(const char *buf, size_t offset, size_t end)
+{
+    while (offset < end && !(Jest__charClass[(unsigned char)buf[offset]] & JEST__CC_STRUCT)) ++offset;
+    return offset;
+}
+
+#ifdef JEST__SIMD_X86
+// sse2 is part of x86-64 so these need no runtime check
+static size_t Jest__scanWhiteSpaceSse2(const char *buf, size_t offset, size_t end)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i below_tab = _mm_set1_epi8('\t' - 1);
+    const __m128i above_cr = _mm_set1_epi8('\r' + 1);
+
+    for (; offset + 16 <= end; offset += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)&buf[offset]);
+        const __m128i ws = _mm_or_si128(
+            _mm_cmpeq_epi8(chunk, space),
+            _mm_and_si128(_mm_cmpgt_epi8(chunk, below_tab), _mm_cmplt_epi8(chunk, above_cr))
+        );
+
+        const unsigned mask = ~(unsigned)_mm_movemask_epi8(ws) & 0xffffu;
+        if (mask) return offset + (size_t)__builtin_ctz(mask);
+    }
+
+    return Jest__scanWhiteSpaceScalar(buf, offset, end);
+}
+
+static size_t Jest__scanStrSse2(const char *buf, size_t offset, size_t end, char quot)
+{
+    const __m128i q = _mm_set1_epi8(quot);
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    for (; offset + 16 <= end; offset += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)&buf[offset]);
+        const unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, q), _mm_cmpeq_epi8(chunk, backslash)));
+        if (mask) return offset + (size_t)__builtin_ctz(mask);
+    }
+
+    return Jest__scanStrScalar(buf, offset, end, quot);
+}
+
+static size_t Jest__scanStructuralSse2(const char *buf, size_t offset, size_t end)
+{
+    // '[' and ']' are '{' and '}' without bit 5, so both kinds of bracket take one compare each
+    const __m128i bit5 = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i dquot = _mm_set1_epi8('"');
+    const __m128i squot = _mm_set1_epi8('\'');
+    const __m128i slash = _mm_set1_epi8('/');
+
+    for (; offset + 16 <= end; offset += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)&buf[offset]);
+        const __m128i folded = _mm_or_si128(chunk, bit5);
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)),
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, slash)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, dquot), _mm_cmpeq_epi8(chunk, squot))
+            )
+        );
+
+        const unsigned mask = (unsigned)_mm_movemask_epi8(hits);
+        if (mask) return offset + (size_t)__builtin_ctz(mask);
+    }
+
+    return Jest__scanStructuralScalar(buf, offset, end);
+}
+
+__attribute__((target("avx2")))
+static size_t Jest__scanWhiteSpaceAvx2(const char *buf, size_t offset, size_t end)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i below_tab = _mm256_set1_epi8('\t' - 1);
+    const __m256i above_cr = _mm256_set1_epi8('\r' + 1);
+
+    for (; offset + 32 <= end; offset += 32) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i *)(const void *)&buf[offset]);
+        const __m256i ws = _mm256_or_si256(
+            _mm256_cmpeq_epi8(chunk, space),
+            _mm256_and_si256(_mm256_cmpgt_epi8(chunk, below_tab), _mm256_cmpgt_epi8(above_cr, chunk))
+        );
+
+        const uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(ws);
+        if (mask) return offset + (size_t)__builtin_ctz(mask);
+    }
+
+    return Jest__scanWhiteSpaceSse2(buf, offset, end);
+}
+
+__attribute__((target("avx2")))
+static size_t Jest__scanStrAvx2(const char *buf, size_t offset, size_t end, char quot)
+{
+    const __m256i q = _mm256_set1_epi8(quot);
+    const __m256i backslash = _mm256_set1_epi8('\\');
+
+    for (; offset + 32 <= end; offset += 32) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i *)(const void *)&buf[offset]);
+        const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, q), _mm256_cmpeq_epi8(chunk, backslash)));
+        if (mask) return offset + (size_t)__builtin_ctz(mask);
+    }
+
+    return Jest__scanStrSse2(buf, offset, end, quot);
+}
+
+__attribute__((target("avx2")))
+static size_t Jest__scanStructuralAvx2(const char *buf, size_t offset, size_t end)
+{
+    const __m256i bit5 = _mm256_set1_epi8(0x20);
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i dquot = _mm256_set1_epi8('"');
+    const __m256i squot = _mm256_set1_epi8('\'');
+    const __m256i slash = _mm256_set1_epi8('/');
+
+    for (; offset + 32 <= end; offset += 32) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i *)(const void *)&buf[offset]);
+        const __m256i folded = _mm256_or_si256(chunk, bit5);
+        const __m256i hits = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close)),
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, comma), _mm256_cmpeq_epi8(chunk, slash)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, dquot), _mm256_cmpeq_epi8(chunk, squot))
+            )
+        );
+
+        const uint32_t mask = (uint32_t)_mm256_movemask_epi8(hits);
+        if (mask) return offset + (size_t)__builtin_ctz(mask);
+    }
+
+    return Jest__scanStructuralSse2(buf, offset, end);
+}
+
+static size_t Jest__scanWhiteSpaceInit(const char *buf, size_t offset, size_t end);
+static size_t Jest__scanStrInit(const char *buf, size_t offset, size_t end, char quot);
+static size_t Jest__scanStructuralInit(const char *buf, size_t offset, size_t end);
+
+// the kernels are picked on first use, which several threads can get to at the same time, so the pick
+// runs once under pthread_once and the pointers are only ever loaded and stored atomically
+static size_t (*Jest__scanWhiteSpaceFn)(const char *buf, size_t offset, size_t end) = Jest__scanWhiteSpaceInit;
+static size_t (*Jest__scanStrFn)(const char *buf, size_t offset, size_t end, char quot) = Jest__scanStrInit;
+static size_t (*Jest__scanStructuralFn)(const char *buf, size_t offset, size_t end) = Jest__scanStructuralInit;
+
+static void Jest__selectScanKernels(void)
+{
+    __builtin_cpu_init();
+    const bool avx2 = __builtin_cpu_supports("avx2");
+
+    __atomic_store_n(&Jest__scanWhiteSpaceFn, (avx2)? Jest__scanWhiteSpaceAvx2 : Jest__scanWhiteSpaceSse2, __ATOMIC_RELEASE);
+    __atomic_store_n(&Jest__scanStrFn, (avx2)? Jest__scanStrAvx2 : Jest__scanStrSse2, __ATOMIC_RELEASE);
+    __atomic_store_n(&Jest__scanStructuralFn, (avx2)? Jest__scanStructuralAvx2 : Jest__scanStructuralSse2, __ATOMIC_RELEASE);
+}
+
+static void Jest__initScanKernels(void)
+{
+#ifdef JEST__THREADS
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, Jest__selectScanKernels);
+#else
+    Jest__selectScanKernels();
+#endif // JEST__THREADS
+}
+
+static size_t Jest__scanWhiteSpace(const char *buf, size_t offset, size_t end)
+{
+    return __atomic_load_n(&Jest__scanWhiteSpaceFn, __ATOMIC_ACQUIRE)(buf, offset, end);
+}
+
+static size_t Jest__scanStr(const char *buf, size_t offset, size_t end, char quot)
+{
+    return __atomic_load_n(&Jest__scanStrFn, __ATOMIC_ACQUIRE)(buf, offset, end, quot);
+}
+
+static size_t Jest__scanStructural(const char *buf, size_t offset, size_t end)
+{
+    return __atomic_load_n(&Jest__scanStructuralFn, __ATOMIC_ACQUIRE)(buf, offset, end);
+}
+
+static size_t Jest__scanWhiteSpaceInit(const char *buf, size_t offset, size_t end)
+{
+    Jest__initScanKernels();
+    return Jest__scanWhiteSpace(buf, offset, end);
+}
+
+static size_t Jest__scanStrInit(const char *buf, size_t offset, size_t end, char quot)
+{
+    Jest__initScanKernels();
+    return Jest__scanStr(buf, offset, end, quot);
+}
+
+static size_t Jest__scanStructuralInit(const char *buf, size_t offset, size_t end)
+{
+    Jest__initScanKernels();
+    return Jest__scanStructural(buf, offset, end);
+}
+#else
+// nothing to pick between without simd
+static size_t Jest__scanWhiteSpace(const char *buf, size_t offset, size_t end)
+{
+    return Jest__scanWhiteSpaceScalar(buf, offset, end);
+}
+
+static size_t Jest__scanStr(const char *buf, size_t offset, size_t end, char quot)
+{
+    return Jest__scanStrScalar(buf, offset, end, quot);
+}
+
+static size_t Jest__scanStructural(const char *buf, size_t offset, size_t end)
+{
+    return Jest__scanStructuralScalar(buf, offset, end);
+}
+#endif // JEST__SIMD_X86
+
+static void Jest__lazyLexer(Jest_Lexer *l, char *strbuf, size_t strbuf_sz, const Jest_LazyVal *val, size_t offset)
+{
+    memset(l, 0, sizeof(*l));
+    l->strbuf = strbuf;
+    l->strbuf_sz = strbuf_sz;
+
+    l->filebuf = val->src;
+    l->filebuf_sz = val->end;
+    l->filebuf_offset = offset;
+}
+
+static bool Jest__lexerSkipContainer(Jest_Lexer *l, size_t *cuts, size_t ncuts)
+{
+    const char *buf = l->filebuf;
+    const size_t end = l->filebuf_sz;
+    size_t offset = l->filebuf_offset;
+    size_t depth = 0, ncut = 0;
+
+    // only brackets, strings and comments matter, nothing in between is validated, gaps between
+    // them are mostly a few bytes so the simd scan only takes over once one runs past 16
+    while (offset < end) {
+        const size_t short_end = (end - offset > 16)? offset + 16 : end;
+        while (offset < short_end && !(Jest__charClass[(unsigned char)buf[offset]] & JEST__CC_STRUCT)) ++offset;
+        if (offset == short_end) offset = Jest__scanStructural(buf, offset, end);
+        if (offset >= end) break;
+
+        switch (buf[offset]) {
+            case '{':
+            case '[':
+                ++depth;
+                break;
+
+            case '}':
+            case ']':
+                if (!--depth) {
+                    // cuts that no comma came after are at the closing bracket
+                    while (ncut < ncuts) cuts[ncut++] = offset;
+                    l->filebuf_offset = offset + 1;
+                    return true;
+                }
+                break;
+
+            // each cut starts out as a target offset and ends up just past the first top level comma at or after it
+            case ',':
+                while (depth == 1 && ncut < ncuts && offset >= cuts[ncut]) cuts[ncut++] = offset + 1;
+                break;
+
+            case '"':
+            case '\'': {
+                const char quot = buf[offset];
+                offset = Jest__scanStr(buf, offset + 1, end, quot);
+                while (offset + 1 < end && buf[offset] == '\\') offset = Jest__scanStr(buf, offset + 2, end, quot);
+                if (offset >= end || buf[offset] != quot) return false;
+            } break;
+
+            case '/':
+                l->filebuf_offset = offset;
+                Jest__lexerSkipCommentAndWhiteSpace(l);
+                if (l->filebuf_offset != offset) {
+                    offset = l->filebuf_offset;
+                    continue;
+                }
+                break;
+
+            default: break;
+        }
+
+        ++offset;
+    }
+
+    return false;
+}
+
+static Jest_Error Jest__lazyNext(Jest_Lexer *l, Jest_LazyVal *out)
+{
+    Jest__lexerSkipCommentAndWhiteSpace(l);
+    if (l->filebuf_offset >= l->filebuf_sz) return JEST_ERROR_SYNTAX;
+
+    out->src = l->filebuf;
+    out->start = l->filebuf_offset;
+
+    const char c = l->filebuf[l->filebuf_offset];
+    if (c == '{' || c == '[') {
+        if (!Jest__lexerSkipContainer(l, NULL, 0)) return JEST_ERROR_SYNTAX;
+
+        out->type = (c == '{')? JEST_JSONTYPE_OBJ : JEST_JSONTYPE_ARR;
+        out->end = l->filebuf_offset;
+        return JEST_ERROR_NONE;
+    }
+
+    // scalars are short, the lexer finds where they end
+    Jest_lexerStep(l);
+    switch (l->type) {
+        case JEST_LEXEME_NULL: out->type = JEST_JSONTYPE_NULL; break;
+        case JEST_LEXEME_BOOL: out->type = JEST_JSONTYPE_BOOL; break;
+        case JEST_LEXEME_NUM:  out->type = JEST_JSONTYPE_NUM; break;
+        case JEST_LEXEME_STR:  out->type = JEST_JSONTYPE_STR; break;
+        default: return JEST_ERROR_SYNTAX;
+    }
+
+    out->end = l->filebuf_offset;
+    return JEST_ERROR_NONE;
+}
+
+static Jest_Error Jest__lazyField(Jest_LazyVal *out, const Jest_LazyVal *obj, const char *name, size_t name_len)
+{
+    if (obj->type != JEST_JSONTYPE_OBJ) return JEST_ERROR_BADPARAM;
+
+    // keys with escapes are decoded here, and only go to the heap when they're long,
+    // the walk goes on to the closing brace since the last of duplicate keys wins like it does in a tree
+    char strbuf[256];
+    Jest_Lexer l;
+    Jest__lazyLexer(&l, strbuf, sizeof(strbuf), obj, obj->start + 1);
+
+    Jest_LazyVal found = {JEST_JSONTYPE_ERR, NULL, 0, 0};
+    Jest_Error err = JEST_ERROR_BADPARAM;
+    for (;;) {
+        Jest_lexerStep(&l);
+        if (l.type == '}') break;
+
+        bool match;
+        if (l.type == JEST_LEXEME_STR) {
+            match = l.strval_len == name_len && !memcmp(l.strval, name, name_len);
+        } else if (l.type == JEST_LEXEME_IDENT) {
+            match = l.ident_len == name_len && !memcmp(&l.filebuf[l.ident_start], name, name_len);
+        } else {
+            err = JEST_ERROR_SYNTAX;
+            break;
+        }
+
+        Jest_lexerStep(&l);
+        if (l.type != ':') {
+            err = JEST_ERROR_SYNTAX;
+            break;
+        }
+
+        Jest_LazyVal val;
+        const Jest_Error val_err = Jest__lazyNext(&l, &val);
+        if (val_err) {
+            err = val_err;
+            break;
+        }
+
+        if (match) {
+            found = val;
+            err = JEST_ERROR_NONE;
+        }
+
+        Jest_lexerStep(&l);
+        if (l.type == '}') break;
+        if (l.type != ',') {
+            err = JEST_ERROR_SYNTAX;
+            break;
+        }
+    }
+
+    if (!err) *out = found;
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+static void Jest__initSaxState(Jest__SaxState *state)
+{
+    memset(state, 0, sizeof(*state));
+    state->expect = JEST__SAX_VALUE;
+}
+
+static Jest_Error Jest__saxPush(Jest__SaxState *state, char container, size_t max_depth)
+{
+    if (state->depth >= ((max_depth)? max_depth : JEST_MAX_DEPTH)) return JEST_ERROR_DEPTH;
+
+    if (state->depth + 1 > state->cap) {
+        const size_t cap = (state->cap)? state->cap * 2 : 32;
+        char *stack = (char *)realloc(state->stack, cap);
+        if (!stack) return JEST_ERROR_NOMEM;
+
+        state->stack = stack;
+        state->cap = cap;
+    }
+
+    state->stack[state->depth++] = container;
+    JEST__STAT(Jest__statDepth(state->depth));
+    return JEST_ERROR_NONE;
+}
+
+static Jest_Error Jest__saxFeed(Jest__SaxState *state, const Jest_Lexer *l, const Jest_SaxHandler *h, void *userdata)
+{
+    // a missing callback just means the event isn't interesting
+    #define JEST__SAX_EMIT(cb, ...) do { if (h->cb && !h->cb(__VA_ARGS__)) return JEST_ERROR_ABORTED; } while (0)
+
+    switch (state->expect) {
+        case JEST__SAX_KEY:
+        case JEST__SAX_KEY_OR_END:
+            if (l->type == '}' && state->expect == JEST__SAX_KEY_OR_END) goto lbl_end_container;
+            if (l->type == JEST_LEXEME_STR) {
+                JEST__SAX_EMIT(key, userdata, l->strval, l->strval_len);
+            } else if (l->type == JEST_LEXEME_IDENT) {
+                JEST__SAX_EMIT(key, userdata, &l->filebuf[l->ident_start], l->ident_len);
+            } else return JEST_ERROR_SYNTAX;
+
+            state->expect = JEST__SAX_COLON;
+            return JEST_ERROR_NONE;
+
+        case JEST__SAX_COLON:
+            if (l->type != ':') return JEST_ERROR_SYNTAX;
+            state->expect = JEST__SAX_VALUE;
+            return JEST_ERROR_NONE;
+
+        case JEST__SAX_NEXT:
+            if (l->type == ',') {
+                state->expect = (state->stack[state->depth - 1] == '{')? JEST__SAX_KEY_OR_END : JEST__SAX_VALUE_OR_END;
+                return JEST_ERROR_NONE;
+            }
+
+            if (l->type != ((state->stack[state->depth - 1] == '{')? '}' : ']')) return JEST_ERROR_SYNTAX;
+            goto lbl_end_container;
+
+        case JEST__SAX_VALUE:
+        case JEST__SAX_VALUE_OR_END:
+            if (l->type == ']' && state->expect == JEST__SAX_VALUE_OR_END) goto lbl_end_container;
+            break;
+
+        default: return JEST_ERROR_BADPARAM;
+    }
+
+    switch (l->type) {
+        case JEST_LEXEME_NULL: JEST__SAX_EMIT(null, userdata); break;
+        case JEST_LEXEME_BOOL: JEST__SAX_EMIT(boolean, userdata, l->boolval); break;
+        case JEST_LEXEME_NUM:  JEST__SAX_EMIT(num, userdata, l->numval); break;
+        case JEST_LEXEME_STR:  JEST__SAX_EMIT(str, userdata, l->strval, l->strval_len); break;
+
+        case '[': {
+            const Jest_Error err = Jest__saxPush(state, '[', l->max_depth);
+            if (err) return err;
+        }
+            JEST__SAX_EMIT(begin_arr, userdata);
+            state->expect = JEST__SAX_VALUE_OR_END;
+            return JEST_ERROR_NONE;
+
+        case '{': {
+            const Jest_Error err = Jest__saxPush(state, '{', l->max_depth);
+            if (err) return err;
+        }
+            JEST__SAX_EMIT(begin_obj, userdata);
+            state->expect = JEST__SAX_KEY_OR_END;
+            return JEST_ERROR_NONE;
+
+        default: return JEST_ERROR_SYNTAX;
+    }
+
+    state->expect = (state->depth)? JEST__SAX_NEXT : JEST__SAX_DONE;
+    return JEST_ERROR_NONE;
+
+lbl_end_container:
+    if (state->stack[--state->depth] == '{') JEST__SAX_EMIT(end_obj, userdata);
+    else JEST__SAX_EMIT(end_arr, userdata);
+
+    state->expect = (state->depth)? JEST__SAX_NEXT : JEST__SAX_DONE;
+    return JEST_ERROR_NONE;
+
+    #undef JEST__SAX_EMIT
+}
+
+static bool Jest__isIdentChar(char c)
+{
+    return Jest__charClass[(unsigned char)c] & JEST__CC_WORD;
+}
+
+// whether the token at src[start] is complete within src, *scanned is where looking for its end picks up
+// again, so a long token that arrives over many chunks is only looked at once
+static bool Jest__chunkTokenEnds(const char *src, size_t start, size_t src_len, size_t *scanned)
+{
+    const char c = src[start];
+    size_t i = (*scanned > start)? *scanned : start + 1;
+
+    if (c == '"' || c == '\'') {
+        for (;;) {
+            i = Jest__scanStr(src, i, src_len, c);
+            if (i >= src_len) break;
+            if (src[i] == c) return true;
+
+            // escapes are checked in full, a bad one is an error no matter how the string goes on
+            if (i + 1 >= src_len) break;
+            const size_t ndigits = (src[i + 1] == 'u')? 4 : (src[i + 1] == 'x')? 2 : 0;
+            for (size_t k = 0; k < ndigits && i + 2 + k < src_len; ++k) {
+                uint32_t digit;
+                if (!Jest__hexDigit(src[i + 2 + k], &digit)) return true;
+            }
+
+            if (i + 2 + ndigits > src_len) break;
+            i += 2 + ndigits;
+        }
+    } else if (Jest__isIdentChar(c)) {
+        while (i < src_len && Jest__isIdentChar(src[i])) ++i;
+        if (i < src_len) return true;
+    } else if (c == '/') {
+        // might be the start of a comment
+        if (start + 1 < src_len) return true;
+    } else return true;
+
+    *scanned = i;
+    return false;
+}
+
+// moves *offset past the end of the comment whose body starts there, or as far as it can when it doesn't end in src
+static bool Jest__chunkCommentEnds(const char *src, size_t *offset, size_t src_len, char kind)
+{
+    if (kind == '/') {
+        const char *newline = (const char *)memchr(&src[*offset], '\n', src_len - *offset);
+        *offset = (newline)? (size_t)(newline - src) : src_len;
+        return newline != NULL;
+    }
+
+    for (size_t i = *offset; i + 1 < src_len; ++i) {
+        if (src[i] == '*' && src[i + 1] == '/') {
+            *offset = i + 2;
+            return true;
+        }
+    }
+
+    // a star at the very end might be closed by the next chunk
+    *offset = (src_len > *offset && src[src_len - 1] == '*')? src_len - 1 : src_len;
+    return false;
+}
+
+static size_t Jest__chunkParserRun(Jest_ChunkParser *p, const char *src, size_t src_len, bool final)
+{
+    JEST__STAT_PARSE_START(start);
+    Jest_Lexer *l = &p->lexer;
+    l->filebuf = src;
+    l->filebuf_sz = src_len;
+
+    size_t consumed = 0;
+    while (p->state.expect != JEST__SAX_DONE) {
+        if (!final) {
+            // whitespace and comments are never part of a token so they're dropped right away, anything
+            // else has to be complete before it's lexed since it might continue in the next chunk
+            if (p->comment) {
+                if (!Jest__chunkCommentEnds(src, &consumed, src_len, p->comment)) break;
+                p->comment = '\0';
+            }
+
+            consumed = Jest__scanWhiteSpace(src, consumed, src_len);
+            if (consumed >= src_len) break;
+
+            if (src[consumed] == '/' && consumed + 1 < src_len && (src[consumed + 1] == '/' || src[consumed + 1] == '*')) {
+                p->comment = src[consumed + 1];
+                consumed += 2;
+                continue;
+            }
+
+            if (!Jest__chunkTokenEnds(src, consumed, src_len, &p->scanned)) break;
+            p->scanned = 0;
+        }
+
+        l->filebuf_offset = consumed;
+        Jest_lexerStep(l);
+
+        p->err = Jest__saxFeed(&p->state, l, p->handler, p->userdata);
+        if (p->err) break;
+
+        consumed = l->filebuf_offset;
+    }
+
+    // what's left starts with the unfinished token, which is where p->scanned is counted from
+    p->scanned = (p->scanned > consumed)? p->scanned - consumed : 0;
+    JEST__STAT_PARSE_END(start);
+    return consumed;
+}
+
+static bool Jest__domAdd(Jest__DomBuilder *dom, Jest_JsonVal val)
+{
+    if (!dom->depth) {
+        *dom->out = val;
+        return true;
+    }
+
+    Jest_JsonVal *parent = &dom->stack[dom->depth - 1];
+    Jest_Error err;
+
+    if (parent->type == JEST_JSONTYPE_ARR) {
+        err = Jest__arrayAppend(NULL, parent, &val);
+    } else {
+        // Jest__objAdd takes care of the key even if it fails
+        err = Jest__objAdd(NULL, parent, dom->key, dom->key_len, val);
+        dom->key = NULL;
+    }
+
+    if (err) Jest_destroyJsonVal(&val);
+    return !err;
+}
+
+static bool Jest__domBegin(Jest__DomBuilder *dom, Jest_JsonVal container)
+{
+    if (dom->depth + 1 > dom->cap) {
+        const size_t cap = (dom->cap)? dom->cap * 2 : 32;
+
+        Jest_JsonVal *stack = (Jest_JsonVal *)realloc(dom->stack, sizeof(*stack) * cap);
+        if (stack) dom->stack = stack;
+
+        char **keys = (char **)realloc(dom->keys, sizeof(*keys) * cap);
+        if (keys) dom->keys = keys;
+
+        size_t *key_lens = (size_t *)realloc(dom->key_lens, sizeof(*key_lens) * cap);
+        if (key_lens) dom->key_lens = key_lens;
+
+        if (!stack || !keys || !key_lens) return false;
+        dom->cap = cap;
+    }
+
+    // the key this container gets added to its parent under has to wait until it's done
+    dom->stack[dom->depth] = container;
+    dom->keys[dom->depth] = dom->key;
+    dom->key_lens[dom->depth] = dom->key_len;
+    ++dom->depth;
+
+    dom->key = NULL;
+    return true;
+}
+
+static bool Jest__domBeginObj(void *userdata)
+{
+    return Jest__domBegin((Jest__DomBuilder *)userdata, Jest_jsonObj());
+}
+
+static bool Jest__domBeginArr(void *userdata)
+{
+    return Jest__domBegin((Jest__DomBuilder *)userdata, Jest_jsonArray());
+}
+
+static bool Jest__domEnd(void *userdata)
+{
+    Jest__DomBuilder *dom = (Jest__DomBuilder *)userdata;
+
+    --dom->depth;
+    dom->key = dom->keys[dom->depth];
+    dom->key_len = dom->key_lens[dom->depth];
+
+    return Jest__domAdd(dom, dom->stack[dom->depth]);
+}
+
+static bool Jest__domKey(void *userdata, const char *str, size_t len)
+{
+    Jest__DomBuilder *dom = (Jest__DomBuilder *)userdata;
+
+    dom->key = Jest_strndup(str, len);
+    dom->key_len = len;
+    return dom->key != NULL;
+}
+
+static bool Jest__domStr(void *userdata, const char *str, size_t len)
+{
+    Jest_JsonVal val = Jest_jsonNull();
+    val.v.as_str.data = Jest_strndup(str, len);
+    if (!val.v.as_str.data) return false;
+
+    val.type = JEST_JSONTYPE_STR;
+    val.v.as_str.len = len;
+    return Jest__domAdd((Jest__DomBuilder *)userdata, val);
+}
+
+static bool Jest__domNum(void *userdata, double val)
+{
+    return Jest__domAdd((Jest__DomBuilder *)userdata, Jest_jsonNumber(val));
+}
+
+static bool Jest__domBool(void *userdata, bool val)
+{
+    return Jest__domAdd((Jest__DomBuilder *)userdata, Jest_jsonBool(val));
+}
+
+static bool Jest__domNull(void *userdata)
+{
+    return Jest__domAdd((Jest__DomBuilder *)userdata, Jest_jsonNull());
+}
+
+static void Jest__arenaSplice(Jest_Arena *dst, Jest_Arena *src)
+{
+    if (!src->head) return;
+
+    // src's blocks go behind dst's so that dst keeps bumping into its current block
+    struct Jest__ArenaBlock *tail = dst->head;
+    while (tail && tail->next) tail = tail->next;
+
+    if (tail) {
+        tail->next = src->head;
+        src->head->prev = tail;
+    } else dst->head = src->head;
+
+    src->head = NULL;
+}
+
+static Jest_Error Jest__reinternNames(Jest_Arena *arena, Jest__InternTable **table, Jest_JsonVal *val)
+{
+    if (val->type != JEST_JSONTYPE_ARR && val->type != JEST_JSONTYPE_OBJ) return JEST_ERROR_NONE;
+
+    // every field name is swapped for the one copy in table, nested containers go on an explicit stack
+    Jest__WalkFrame local[JEST__LOCAL_FRAMES];
+    Jest__WalkFrame *stack = local;
+    size_t depth = 1, cap = JEST__LOCAL_FRAMES;
+    Jest_Error err = JEST_ERROR_NONE;
+
+    stack[0].val = val;
+    stack[0].idx = 0;
+
+    while (depth) {
+        Jest__WalkFrame *top = &stack[depth - 1];
+        Jest_JsonVal *c = (Jest_JsonVal *)top->val;
+        const bool is_arr = c->type == JEST_JSONTYPE_ARR;
+
+        if (top->idx >= ((is_arr)? c->v.as_arr.len : c->v.as_obj.nfields)) {
+            --depth;
+            continue;
+        }
+
+        const size_t i = top->idx++;
+        if (!is_arr) {
+            char *name = Jest__internKey(arena, table, c->v.as_obj.field_names[i], c->v.as_obj.fn_lens[i]);
+            if (!name) {
+                err = JEST_ERROR_NOMEM;
+                break;
+            }
+
+            c->v.as_obj.field_names[i] = name;
+        }
+
+        const Jest_JsonVal *child = (is_arr)? &c->v.as_arr.elems[i] : &c->v.as_obj.field_values[i];
+        if (child->type != JEST_JSONTYPE_ARR && child->type != JEST_JSONTYPE_OBJ) continue;
+
+        if (depth == cap) {
+            Jest__WalkFrame *grown = (Jest__WalkFrame *)Jest__growStack(stack, local, &cap, sizeof(*stack));
+            if (!grown) {
+                err = JEST_ERROR_NOMEM;
+                break;
+            }
+
+            stack = grown;
+        }
+
+        stack[depth].val = child;
+        stack[depth].idx = 0;
+        ++depth;
+    }
+
+    if (stack != local) free(stack);
+    return err;
+}
+
+static size_t Jest__linesBoundary(const char *buf, size_t len, size_t off)
+{
+    if (off >= len) return len;
+
+    const char *nl = (const char *)memchr(&buf[off], '\n', len - off);
+    return (nl)? (size_t)(nl - buf) + 1 : len;
+}
+
+static unsigned Jest__workerThreads(unsigned nthreads, size_t len)
+{
+#ifdef JEST__THREADS
+#   ifdef _SC_NPROCESSORS_ONLN
+    if (!nthreads) {
+        const long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (ncpu > 0)? (unsigned)ncpu : 1;
+    }
+#   endif // _SC_NPROCESSORS_ONLN
+#else
+    nthreads = 1;
+#endif // JEST__THREADS
+
+    // small inputs aren't worth waking up threads for
+    const size_t most = len / JEST_PARALLEL_MIN_SLICE + 1;
+    if (!nthreads) nthreads = 1;
+    return (nthreads > most)? (unsigned)most : nthreads;
+}
+
+static void Jest__linesWorkerRun(Jest__ParseWorker *w)
+{
+    size_t off = 0;
+    while (off < w->len && !w->err) {
+        const size_t end = Jest__linesBoundary(w->buf, w->len, off);
+
+        Jest_Lexer *l = &w->lexer;
+        Jest__lexerRewind(l, &w->buf[off], end - off);
+        off = end;
+
+        if (l->type == JEST_LEXEME_EOF) continue;
+
+        if (w->count == w->cap) {
+            const size_t cap = (w->cap)? w->cap * 2 : 64;
+            Jest_JsonVal *values = (Jest_JsonVal *)realloc(w->values, cap * sizeof(*values));
+            if (values) w->values = values;
+            Jest_Error *errors = (Jest_Error *)realloc(w->errors, cap * sizeof(*errors));
+            if (errors) w->errors = errors;
+
+            if (!values || !errors) {
+                w->err = JEST_ERROR_NOMEM;
+                break;
+            }
+
+            w->cap = cap;
+        }
+
+        // anything after the value is an error, a record has to fit on its line,
+        // records tend to repeat the same keys so those are always interned
+        Jest__ParseCtx ctx = {l, &w->arena, false, &w->intern};
+        Jest_JsonVal val;
+        Jest_Error err = Jest__parseVal(&val, &ctx);
+        if (!err && l->type != JEST_LEXEME_EOF) err = JEST_ERROR_SYNTAX;
+
+        w->values[w->count] = (err)? Jest_jsonNull() : val;
+        w->errors[w->count] = err;
+        ++w->count;
+    }
+}
+
+static void Jest__elemsWorkerRun(Jest__ParseWorker *w)
+{
+    // a slice is a run of elements that each end with a comma, except at the end of the array
+    Jest_Lexer *l = &w->lexer;
+    Jest__lexerRewind(l, w->buf, w->len);
+
+    Jest__ParseCtx ctx = {l, &w->arena, (w->flags & JEST_DOC_ZEROCOPY) != 0, (w->flags & JEST_DOC_INTERN)? &w->intern : NULL};
+    while (!w->err && l->type != JEST_LEXEME_EOF) {
+        if (w->count == w->cap) {
+            const size_t cap = (w->cap)? w->cap * 2 : 64;
+            Jest_JsonVal *values = (Jest_JsonVal *)realloc(w->values, cap * sizeof(*values));
+            if (!values) {
+                w->err = JEST_ERROR_NOMEM;
+                break;
+            }
+
+            w->values = values;
+            w->cap = cap;
+        }
+
+        w->err = Jest__parseVal(&w->values[w->count], &ctx);
+        if (w->err) break;
+        ++w->count;
+
+        if (l->type == ',') Jest_lexerStep(l);
+        else if (l->type != JEST_LEXEME_EOF) w->err = JEST_ERROR_SYNTAX;
+    }
+}
+
+static Jest_Error Jest__parseElemsParallel(Jest_Document *doc, Jest_Lexer *l, unsigned n)
+{
+    const char *buf = l->filebuf;
+    const size_t len = l->filebuf_sz;
+    const size_t start = l->filebuf_offset;
+
+    // the first phase cuts the array into slices of about the same size with a scan that
+    // only looks at brackets, strings and comments, the last cut is the closing bracket
+    size_t *cuts = (size_t *)malloc(n * sizeof(*cuts));
+    if (!cuts) return JEST_ERROR_NOMEM;
+
+    for (unsigned i = 0; i + 1 < n; ++i) cuts[i] = start + (i + 1) * ((len - start) / n);
+    if (!Jest__lexerSkipContainer(l, cuts, n - 1)) {
+        free(cuts);
+        return JEST_ERROR_SYNTAX;
+    }
+
+    // the scan pairs up brackets of either kind, the array has to be closed by its own
+    cuts[n - 1] = l->filebuf_offset - 1;
+    if (buf[cuts[n - 1]] != ']') {
+        free(cuts);
+        return JEST_ERROR_SYNTAX;
+    }
+
+    Jest__ParseWorker *workers = (Jest__ParseWorker *)calloc(n, sizeof(*workers));
+    if (!workers) {
+        free(cuts);
+        return JEST_ERROR_NOMEM;
+    }
+
+    for (unsigned i = 0; i < n; ++i) {
+        const size_t from = (i)? cuts[i - 1] : start + 1;
+
+        workers[i].run = Jest__elemsWorkerRun;
+        workers[i].buf = &buf[from];
+        workers[i].len = cuts[i] - from;
+        workers[i].flags = doc->flags;
+    }
+
+    free(cuts);
+    Jest__runWorkers(workers, n);
+
+    Jest_Error err = JEST_ERROR_NONE;
+    size_t count = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        if (!err) err = workers[i].err;
+        count += workers[i].count;
+    }
+
+    Jest_JsonVal root = Jest_jsonArray();
+    root.flags = JEST_JSONFLAG_ARENA;
+
+    if (!err && count) {
+        root.v.as_arr.elems = (Jest_JsonVal *)Jest_arenaAlloc(&doc->arena, count * sizeof(*root.v.as_arr.elems));
+        if (!root.v.as_arr.elems) err = JEST_ERROR_NOMEM;
+    }
+
+    // the second phase stitches the slices together, their values stay in the workers' arenas
+    // and only the block lists are moved over to the document
+    for (unsigned i = 0; i < n; ++i) {
+        if (!err && workers[i].count) {
+            memcpy(&root.v.as_arr.elems[root.v.as_arr.len], workers[i].values, workers[i].count * sizeof(*root.v.as_arr.elems));
+            root.v.as_arr.len += workers[i].count;
+            Jest__arenaSplice(&doc->arena, &workers[i].arena);
+        }
+
+        Jest__resetWorker(&workers[i]);
+        Jest_destroyLexer(&workers[i].lexer);
+    }
+
+    free(workers);
+    root.v.as_arr.cap = root.v.as_arr.len;
+
+    // every worker interned into a table of its own, the names go into the document's one so
+    // that equal names are the same pointer across slices and later additions find them too
+    if (!err && (doc->flags & JEST_DOC_INTERN)) err = Jest__reinternNames(&doc->arena, &doc->intern, &root);
+
+    doc->root = (err)? Jest_jsonNull() : root;
+    return err;
+}
+
+#ifdef JEST__THREADS
+static void *Jest__workerThread(void *arg)
+{
+    Jest__ParseWorker *w = (Jest__ParseWorker *)arg;
+    JEST__STAT_PARSE_START(start);
+    w->run(w);
+    JEST__STAT_PARSE_END(start);
+    JEST__STAT(w->stats = Jest__stats);
+    return NULL;
+}
+#endif // JEST__THREADS
+
+static void Jest__runWorkers(Jest__ParseWorker *workers, unsigned n)
+{
+#ifdef JEST__THREADS
+    pthread_t *threads = (n > 1)? (pthread_t *)malloc((n - 1) * sizeof(*threads)) : NULL;
+    bool *started = (n > 1)? (bool *)calloc(n - 1, sizeof(*started)) : NULL;
+
+    // the calling thread takes the first share, workers that can't get a thread run on it afterwards
+    if (threads && started) {
+        for (unsigned i = 1; i < n; ++i) {
+            started[i - 1] = !pthread_create(&threads[i - 1], NULL, Jest__workerThread, &workers[i]);
+        }
+    }
+
+    workers[0].run(&workers[0]);
+
+    for (unsigned i = 1; i < n; ++i) {
+        if (threads && started && started[i - 1]) {
+            pthread_join(threads[i - 1], NULL);
+            JEST__STAT(Jest__statMerge(&Jest__stats, &workers[i].stats));
+        } else workers[i].run(&workers[i]);
+    }
+
+    free(threads);
+    free(started);
+#else
+    for (unsigned i = 0; i < n; ++i) workers[i].run(&workers[i]);
+#endif // JEST__THREADS
+}
+
+static void Jest__resetWorker(Jest__ParseWorker *w)
+{
+    // the lexer stays around for its string buffer
+    Jest_destroyArena(&w->arena);
+    w->intern = NULL;
+    free(w->values);
+    free(w->errors);
+
+    w->values = NULL;
+    w->errors = NULL;
+    w->count = w->cap = 0;
+    w->err = JEST_ERROR_NONE;
+}
+
+#ifdef JEST_STATS
+static double Jest__statNow(void)
+{
+#   ifdef JEST__STAT_CLOCK
+    struct timespec ts;
+    if (!clock_gettime(JEST__STAT_CLOCK, &ts)) return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#   endif // JEST__STAT_CLOCK
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Jest__statSince(double start)
+{
+    return Jest__statNow() - start;
+}
+
+static void Jest__statToken(Jest_LexemeType type)
+{
+    switch (type) {
+        case JEST_LEXEME_IDENT: ++Jest__stats.tokens_ident; break;
+        case JEST_LEXEME_NULL: ++Jest__stats.tokens_null; break;
+        case JEST_LEXEME_BOOL: ++Jest__stats.tokens_bool; break;
+        case JEST_LEXEME_NUM: ++Jest__stats.tokens_num; break;
+        case JEST_LEXEME_STR: ++Jest__stats.tokens_str; break;
+        default: if (type < 256) ++Jest__stats.tokens_punct; break;
+    }
+}
+
+static void Jest__statDepth(size_t depth)
+{
+    if (depth > Jest__stats.max_depth) Jest__stats.max_depth = depth;
+}
+
+#ifdef JEST__THREADS
+static void Jest__statMerge(Jest_Stats *dst, const Jest_Stats *src)
+{
+    dst->tokens_punct += src->tokens_punct;
+    dst->tokens_str += src->tokens_str;
+    dst->tokens_num += src->tokens_num;
+    dst->tokens_ident += src->tokens_ident;
+    dst->tokens_bool += src->tokens_bool;
+    dst->tokens_null += src->tokens_null;
+
+    dst->strings_clean += src->strings_clean;
+    dst->strings_escaped += src->strings_escaped;
+
+    dst->allocs += src->allocs;
+    dst->reallocs += src->reallocs;
+    dst->alloc_bytes += src->alloc_bytes;
+    dst->array_grows += src->array_grows;
+    dst->obj_grows += src->obj_grows;
+
+    if (src->max_depth > dst->max_depth) dst->max_depth = src->max_depth;
+
+    dst->read_time += src->read_time;
+    dst->parse_time += src->parse_time;
+    dst->write_time += src->write_time;
+}
+#endif // JEST__THREADS
+#endif // JEST_STATS
+
+static void Jest__lexerSkipCommentAndWhiteSpace(Jest_Lexer *l)
+{
+    if (!l) return;
+
+    for (;;) {
+        if (l->filebuf_offset < l->filebuf_sz && Jest__isWhiteSpace(l->filebuf[l->filebuf_offset])) {
+            l->filebuf_offset = Jest__scanWhiteSpace(l->filebuf, l->filebuf_offset, l->filebuf_sz);
+        }
+
+        if (l->filebuf_offset + 1 >= l->filebuf_sz || l->filebuf[l->filebuf_offset] != '/') return;
+
+        const char *body = &l->filebuf[l->filebuf_offset + 2];
+        size_t remaining = l->filebuf_sz - l->filebuf_offset - 2;
+
+        if (l->filebuf[l->filebuf_offset + 1] == '/') { // single line comments
+            const char *newline = (const char *)memchr(body, '\n', remaining);
+            l->filebuf_offset = (newline)? (size_t)(newline - l->filebuf) : l->filebuf_sz;
+        } else if (l->filebuf[l->filebuf_offset + 1] == '*') { // multiline comments
+            const char *star;
+            while ((star = (const char *)memchr(body, '*', remaining))) {
+                remaining -= (size_t)(star - body) + 1;
+                body = star + 1;
+                if (remaining && *body == '/') break;
+            }
+
+            // unterminated comments are left for Jest_lexerStep to reject
+            if (!star) return;
+            l->filebuf_offset = (size_t)(body - l->filebuf) + 1;
+        } else return;
+    }
+}
+
+static bool Jest__hexDigit(char c, uint32_t *out)
+{
+    if (c >= '0' && c <= '9') *out = (uint32_t)(c - '0');
+    else if (c >= 'a' && c <= 'f') *out = (uint32_t)(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F') *out = (uint32_t)(c - 'A' + 10);
+    else return false;
+
+    return true;
+}
+
+static bool Jest__parseHex(const char *buf, size_t offset, size_t end, size_t ndigits, uint32_t *out)
+{
+    if (offset + ndigits > end) return false;
+
+    uint32_t val = 0;
+    for (size_t i = 0; i < ndigits; ++i) {
+        uint32_t digit;
+        if (!Jest__hexDigit(buf[offset + i], &digit)) return false;
+        val = (val << 4) | digit;
+    }
+
+    *out = val;
+    return true;
+}
+
+#ifdef JEST__STRTOD_L
+static Jest__Locale Jest__cLocale;
+
+static void Jest__initCLocale(void)
+{
+    Jest__cLocale = JEST__NEWLOCALE_C();
+}
+#endif // JEST__STRTOD_L
+
+static double Jest__strtodToken(const char *token, size_t len)
+{
+#ifdef JEST__STRTOD_L
+#   ifdef JEST__THREADS
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, Jest__initCLocale);
+#   else
+    if (!Jest__cLocale) Jest__initCLocale();
+#   endif // JEST__THREADS
+    const char *point = ".";
+#else
+    // strtod expects the decimal point of the current locale, which json's '.' is swapped for
+    const char *point = localeconv()->decimal_point;
+    if (!point || !*point) point = ".";
+#endif // JEST__STRTOD_L
+
+    // strtod needs a nul-terminated copy so it can't run past the token
+    const size_t point_len = strlen(point);
+    char small[64];
+    char *tmp = (len + point_len < sizeof(small))? small : (char *)malloc(len + point_len);
+    if (!tmp) return JEST_NAN;
+
+    size_t n = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (token[i] != '.') tmp[n++] = token[i];
+        else {
+            memcpy(&tmp[n], point, point_len);
+            n += point_len;
+        }
+    }
+    tmp[n] = '\0';
+
+#ifdef JEST__STRTOD_L
+    const double ret = (Jest__cLocale)? JEST__STRTOD_L(tmp, NULL, Jest__cLocale) : strtod(tmp, NULL);
+#else
+    const double ret = strtod(tmp, NULL);
+#endif // JEST__STRTOD_L
+    if (tmp != small) free(tmp);
+    return ret;
+}
+
+static size_t Jest__parseNumber(const char *buf, size_t offset, size_t end, double *out)
+{
+    // powers of ten that can be represented exactly as doubles
+    static const double exact_pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const uint64_t max_exact = UINT64_C(1) << 53;
+    size_t i = offset;
+    bool neg = false;
+
+    if (i < end && (buf[i] == '+' || buf[i] == '-')) neg = buf[i++] == '-';
+
+    // unsigned Infinity and NaN are lexed as identifiers, these are the signed ones
+    if (end - i >= 8 && !memcmp(&buf[i], "Infinity", 8)) {
+        *out = (neg)? -JEST_INF : JEST_INF;
+        return i + 8;
+    }
+
+    if (end - i >= 3 && !memcmp(&buf[i], "NaN", 3)) {
+        *out = (neg)? -JEST_NAN : JEST_NAN;
+        return i + 3;
+    }
+
+    uint32_t digit;
+    if (end - i >= 3 && buf[i] == '0' && (buf[i + 1] == 'x' || buf[i + 1] == 'X') && Jest__hexDigit(buf[i + 2], &digit)) {
+        i += 2;
+
+        uint64_t mantissa = 0;
+        bool overflow = false;
+        for (; i < end && Jest__hexDigit(buf[i], &digit); ++i) {
+            if (mantissa >> 60) overflow = true;
+            mantissa = (mantissa << 4) | digit;
+        }
+
+        // converting a 64-bit integer to a double is correctly rounded
+        if (overflow) *out = Jest__strtodToken(&buf[offset], i - offset);
+        else *out = (neg)? -(double)mantissa : (double)mantissa;
+        return i;
+    }
+
+    uint64_t mantissa = 0;
+    int ndigits = 0; // significant digits in mantissa
+    long exp10 = 0;
+    bool truncated = false; // non-zero digits didn't fit into mantissa
+    bool any_digits = false;
+
+    for (; i < end && buf[i] >= '0' && buf[i] <= '9'; ++i) {
+        any_digits = true;
+        if (ndigits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(buf[i] - '0');
+            if (mantissa) ++ndigits;
+        } else {
+            ++exp10;
+            if (buf[i] != '0') truncated = true;
+        }
+    }
+
+    if (i < end && buf[i] == '.') {
+        for (++i; i < end && buf[i] >= '0' && buf[i] <= '9'; ++i) {
+            any_digits = true;
+            if (ndigits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(buf[i] - '0');
+                if (mantissa) ++ndigits;
+                --exp10;
+            } else if (buf[i] != '0') truncated = true;
+        }
+    }
+
+    if (!any_digits) return offset;
+
+    if (i + 1 < end && (buf[i] == 'e' || buf[i] == 'E')) {
+        size_t j = i + 1;
+        bool exp_neg = false;
+        if (buf[j] == '+' || buf[j] == '-') exp_neg = buf[j++] == '-';
+
+        if (j < end && buf[j] >= '0' && buf[j] <= '9') {
+            long exp = 0;
+            for (; j < end && buf[j] >= '0' && buf[j] <= '9'; ++j) {
+                if (exp < 100000) exp = exp * 10 + (buf[j] - '0');
+            }
+
+            exp10 += (exp_neg)? -exp : exp;
+            i = j;
+        }
+    }
+
+    double val;
+    if (!mantissa) {
+        val = 0.0;
+    } else if (truncated) {
+        goto lbl_slow;
+    } else if (!exp10) {
+        val = (double)mantissa;
+    } else if (mantissa <= max_exact && exp10 >= -22 && exp10 <= 22) {
+        // both operands are exact so ieee rounding gives the correctly rounded result (clinger's fast path)
+        val = (exp10 < 0)? (double)mantissa / exact_pow10[-exp10] : (double)mantissa * exact_pow10[exp10];
+    } else if (mantissa <= max_exact && exp10 > 22 && exp10 <= 22 + 15) {
+        // move the excess exponent into the mantissa while it stays exact
+        uint64_t m = mantissa;
+        long e = exp10;
+        for (; e > 22 && m <= max_exact / 10; --e) m *= 10;
+        if (e > 22) goto lbl_slow;
+        val = (double)m * exact_pow10[e];
+    } else {
+        goto lbl_slow;
+    }
+
+    *out = (neg)? -val : val;
+    return i;
+
+lbl_slow:
+    *out = Jest__strtodToken(&buf[offset], i - offset);
+    return i;
+}
+
+static Jest_Error Jest__lexerHandleStr(Jest_Lexer *l)
+{
+    if (!l) return JEST_ERROR_BADPARAM;
+
+    Jest__lexerSkipCommentAndWhiteSpace(l);
+    if (l->filebuf[l->filebuf_offset] != '\'' && l->filebuf[l->filebuf_offset] != '\"') {
+        return JEST_ERROR_BADPARAM;
+    }
+
+    l->type = JEST_LEXEME_STR;
+    const char quot = l->filebuf[l->filebuf_offset++];
+
+    // find the end of the leading run that needs no decoding
+    size_t end = Jest__scanStr(l->filebuf, l->filebuf_offset, l->filebuf_sz, quot);
+    if (end >= l->filebuf_sz) return JEST_ERROR_SYNTAX;
+
+    // strings without escapes don't need to be copied at all
+    if (l->filebuf[end] == quot) {
+        l->strval = &l->filebuf[l->filebuf_offset];
+        l->strval_len = end - l->filebuf_offset;
+        l->filebuf_offset = end + 1;
+        JEST__STAT(++Jest__stats.strings_clean);
+        return JEST_ERROR_NONE;
+    }
+
+    // in situ the decoded string never catches up with the input, so it's written over the raw one
+    char *const insitu = (l->insitu)? (char *)&l->filebuf[l->filebuf_offset] : NULL;
+
+    l->strval_len = 0;
+    char *dst = Jest__lexerStrDst(l, insitu, end - l->filebuf_offset);
+    if (!dst) return JEST_ERROR_NOMEM;
+
+    l->strval_len = end - l->filebuf_offset;
+    if (!insitu) memcpy(dst, &l->filebuf[l->filebuf_offset], l->strval_len);
+    l->filebuf_offset = end;
+
+    while (l->filebuf_offset < l->filebuf_sz && l->filebuf[l->filebuf_offset] != quot) {
+        if (l->filebuf[l->filebuf_offset] == '\\') {
+            if (++l->filebuf_offset >= l->filebuf_sz) return JEST_ERROR_SYNTAX;
+
+            // no escape decodes to more than 4 bytes
+            dst = Jest__lexerStrDst(l, insitu, 4);
+            if (!dst) return JEST_ERROR_NOMEM;
+
+            switch (l->filebuf[l->filebuf_offset]) {
+                case '\n':
+                case '\r':
+                    while (l->filebuf_offset + 1 < l->filebuf_sz && Jest__isWhiteSpace(l->filebuf[l->filebuf_offset + 1])) {
+                        ++l->filebuf_offset;
+                    }
+                    break;
+
+                case '\\': dst[l->strval_len++] = '\\'; break;
+                case '\'': dst[l->strval_len++] = '\''; break;
+                case '\"': dst[l->strval_len++] = '\"'; break;
+                case '/':  dst[l->strval_len++] =  '/'; break;
+                case 'b':  dst[l->strval_len++] = '\b'; break;
+                case 'f':  dst[l->strval_len++] = '\f'; break;
+                case 'n':  dst[l->strval_len++] = '\n'; break;
+                case 'r':  dst[l->strval_len++] = '\r'; break;
+                case 't':  dst[l->strval_len++] = '\t'; break;
+                case 'v':  dst[l->strval_len++] = '\v'; break;
+                case '0':  dst[l->strval_len++] = '\0'; break;
+                case 'u': {
+                    --l->filebuf_offset;
+                    int offset = 6;
+                    uint32_t codepoint = 0;
+                    if (!Jest__parseHex(l->filebuf, l->filebuf_offset + 2, l->filebuf_sz, 4, &codepoint)) return JEST_ERROR_BADCHAR;
+
+                    // if codepoint is a hi surrogate
+                    if (0xd800 <= codepoint && codepoint <= 0xdfbb) {
+                        uint32_t lo = 0;
+                        const size_t next = l->filebuf_offset + 6;
+
+                        if (next + 1 < l->filebuf_sz && l->filebuf[next] == '\\' && l->filebuf[next + 1] == 'u') { // if there is a second unicode char
+                            if (!Jest__parseHex(l->filebuf, next + 2, l->filebuf_sz, 4, &lo)) return JEST_ERROR_BADCHAR;
+
+                            if (0xdc00 <= lo && lo <= 0xdfff) { // check if it's a lo surrogate to match the hi surrogate
+                                offset = 12;
+                                codepoint = ((codepoint - 0xd800) << 10) + ((lo - 0xdc00)) + 0x10000;
+                            } else { // if not set the offset to 6 so that it isn't skipped on the next iteration of the loop
+                                offset =  6;
+                            }
+                        }
+                    }
+
+                    if (codepoint <= 0x7F) {
+                        dst[l->strval_len++] = (char)codepoint;
+                    } else if (codepoint <= 0x7FF) {
+                        dst[l->strval_len++] = (char)(((codepoint >> 6) & 0x1f)  | 0xc0);
+                        dst[l->strval_len++] = (char)(((codepoint)      & 0x3f)  | 0x80);
+                    } else if (codepoint <= 0xFFFF) {
+                        dst[l->strval_len++] = (char)(((codepoint >> 12) & 0x0f) | 0xe0);
+                        dst[l->strval_len++] = (char)(((codepoint >> 6)  & 0x3f) | 0x80);
+                        dst[l->strval_len++] = (char)(((codepoint)       & 0x3f) | 0x80);
+                    } else if (codepoint <= 0x10FFFF) {
+                        dst[l->strval_len++] = (char)(((codepoint >> 18) & 0x07) | 0xf0);
+                        dst[l->strval_len++] = (char)(((codepoint >> 12) & 0x3f) | 0x80);
+                        dst[l->strval_len++] = (char)(((codepoint >> 6)  & 0x3f) | 0x80);
+                        dst[l->strval_len++] = (char)(((codepoint)       & 0x3f) | 0x80);
+                    } else {
+                        return JEST_ERROR_BADCHAR;
+                    }
+
+                    l->filebuf_offset += offset - 1;
+                } break;
+
+                case 'x': {
+                    --l->filebuf_offset;
+                    const int offset = 4;
+                    uint32_t codepoint = 0;
+                    if (!Jest__parseHex(l->filebuf, l->filebuf_offset + 2, l->filebuf_sz, 2, &codepoint)) return JEST_ERROR_BADCHAR;
+
+                    if (codepoint <= 0x7F) {
+                        dst[l->strval_len++] = (char)codepoint;
+                    } else {
+                        dst[l->strval_len++] = (char)(((codepoint >> 6) & 0x1f)  | 0xc0);
+                        dst[l->strval_len++] = (char)(((codepoint)      & 0x3f)  | 0x80);
+                    }
+
+                    l->filebuf_offset += offset - 1;
+                } break;
+                default: dst[l->strval_len++] = l->filebuf[l->filebuf_offset]; break;
+            }
+
+            ++l->filebuf_offset;
+            continue;
+        }
+
+        // copy everything up to the next quote or escape at once
+        end = Jest__scanStr(l->filebuf, l->filebuf_offset, l->filebuf_sz, quot);
+        dst = Jest__lexerStrDst(l, insitu, end - l->filebuf_offset);
+        if (!dst) return JEST_ERROR_NOMEM;
+        memmove(&dst[l->strval_len], &l->filebuf[l->filebuf_offset], end - l->filebuf_offset);
+        l->strval_len += end - l->filebuf_offset;
+        l->filebuf_offset = end;
+    }
+
+    if (l->filebuf_offset >= l->filebuf_sz) return JEST_ERROR_SYNTAX;
+
+    ++l->filebuf_offset;
+    JEST__STAT(++Jest__stats.strings_escaped);
+    return JEST_ERROR_NONE;
+}
+
+static bool Jest__lexerReserve(Jest_Lexer *l, size_t extra)
+{
+    if (l->strbuf && l->strval_len + extra <= l->strbuf_sz) {
+        l->strval = l->strbuf;
+        return true;
+    }
+
+    size_t sz = (l->strbuf_sz > 512)? l->strbuf_sz * 2 : 1024;
+    while (sz < l->strval_len + extra) sz *= 2;
+
+    // a buffer handed to Jest_initLexer isn't ours to realloc, the decoded prefix moves over instead
+    char *strbuf = (char *)((l->strbuf_owned)? realloc(l->strbuf, sz) : malloc(sz));
+    if (!strbuf) return false;
+
+    if (!l->strbuf_owned && l->strval_len) memcpy(strbuf, l->strbuf, l->strval_len);
+
+    l->strbuf = strbuf;
+    l->strbuf_sz = sz;
+    l->strbuf_owned = true;
+    l->strval = l->strbuf;
+    return true;
+}
+
+static char *Jest__lexerStrDst(Jest_Lexer *l, char *insitu, size_t extra)
+{
+    if (insitu) {
+        l->strval = insitu;
+        return insitu;
+    }
+
+    return (Jest__lexerReserve(l, extra))? l->strbuf : NULL;
+}
+
+static void Jest__lexerRewind(Jest_Lexer *l, const char *buf, size_t len)
+{
+    l->filebuf = buf;
+    l->filebuf_sz = len;
+    l->filebuf_offset = 0;
+    Jest_lexerStep(l);
+}
+
+static char *Jest__lexerStrDup(Jest__ParseCtx *ctx, const char *str, size_t len)
+{
+    // anything that isn't in strbuf lives in filebuf
+    if (ctx->zerocopy && ctx->arena && str != ctx->lexer->strbuf) return (char *)str;
+    return Jest__strndup(ctx->arena, str, len);
+}
+
+static Jest_Error Jest__parseVal(Jest_JsonVal *out, Jest__ParseCtx *ctx)
+{
+    if (!out || !ctx) return JEST_ERROR_BADPARAM;
+
+    Jest_Lexer *lexer = ctx->lexer;
+    const size_t max_depth = (lexer->max_depth)? lexer->max_depth : JEST_MAX_DEPTH;
+
+    // open containers live on an explicit stack, so nesting is only limited by max_depth
+    Jest__ParseFrame local[JEST__LOCAL_FRAMES];
+    Jest__ParseFrame *stack = local;
+    size_t depth = 0, cap = JEST__LOCAL_FRAMES;
+
+    Jest_JsonVal val;
+    Jest_Error err = JEST_ERROR_NONE;
+    *out = Jest_jsonNull();
+
+lbl_value:
+    switch (lexer->type) {
+        case JEST_LEXEME_NULL: err = Jest__parseNull(&val, ctx); goto lbl_add;
+        case JEST_LEXEME_BOOL: err = Jest__parseBool(&val, ctx); goto lbl_add;
+        case JEST_LEXEME_NUM:  err = Jest__parseNum(&val, ctx); goto lbl_add;
+        case JEST_LEXEME_STR:  err = Jest__parseStr(&val, ctx); goto lbl_add;
+        case '[':
+        case '{':
+            break;
+
+        default:
+            err = JEST_ERROR_SYNTAX;
+            goto lbl_fail;
+    }
+
+    if (depth >= max_depth) {
+        err = JEST_ERROR_DEPTH;
+        goto lbl_fail;
+    }
+
+    if (depth == cap) {
+        Jest__ParseFrame *grown = (Jest__ParseFrame *)Jest__growStack(stack, local, &cap, sizeof(*stack));
+        if (!grown) {
+            err = JEST_ERROR_NOMEM;
+            goto lbl_fail;
+        }
+
+        stack = grown;
+    }
+
+    stack[depth].val = (lexer->type == '[')? Jest_jsonArray() : Jest_jsonObj();
+    stack[depth].val.flags = (ctx->arena)? JEST_JSONFLAG_ARENA : 0;
+    stack[depth].name = NULL;
+    ++depth;
+    JEST__STAT(Jest__statDepth(depth));
+
+lbl_next:
+    // right after an opening bracket or a comma, which also allows trailing commas
+    Jest_lexerStep(lexer);
+    if (stack[depth - 1].val.type == JEST_JSONTYPE_ARR) {
+        if (lexer->type == ']') goto lbl_close;
+        goto lbl_value;
+    }
+
+    if (lexer->type == '}') goto lbl_close;
+    if (lexer->type != JEST_LEXEME_STR && lexer->type != JEST_LEXEME_IDENT) {
+        err = JEST_ERROR_SYNTAX;
+        goto lbl_fail;
+    }
+
+    // the name has to be copied out before the lexer moves on and overwrites strbuf
+    stack[depth - 1].name_len = (lexer->type == JEST_LEXEME_STR)? lexer->strval_len : lexer->ident_len;
+    const char *name = (lexer->type == JEST_LEXEME_STR)? lexer->strval : &lexer->filebuf[lexer->ident_start];
+    stack[depth - 1].name = (ctx->intern)
+        ?Jest__internKey(ctx->arena, ctx->intern, name, stack[depth - 1].name_len)
+        :Jest__lexerStrDup(ctx, name, stack[depth - 1].name_len);
+
+    if (!stack[depth - 1].name) {
+        err = JEST_ERROR_NOMEM;
+        goto lbl_fail;
+    }
+
+    Jest_lexerStep(lexer);
+    if (lexer->type != ':') {
+        err = JEST_ERROR_SYNTAX;
+        goto lbl_fail;
+    }
+
+    Jest_lexerStep(lexer);
+    goto lbl_value;
+
+lbl_close:
+    Jest_lexerStep(lexer);
+    val = stack[--depth].val;
+
+lbl_add:
+    if (err) goto lbl_fail;
+    if (!depth) {
+        if (stack != local) free(stack);
+        *out = val;
+        return JEST_ERROR_NONE;
+    }
+
+    if (stack[depth - 1].val.type == JEST_JSONTYPE_ARR) {
+        err = Jest__arrayAppend(ctx->arena, &stack[depth - 1].val, &val);
+    } else {
+        // Jest__objAdd takes care of the name even if it fails
+        err = Jest__objAdd(ctx->arena, &stack[depth - 1].val, stack[depth - 1].name, stack[depth - 1].name_len, val);
+        stack[depth - 1].name = NULL;
+    }
+
+    if (err) {
+        Jest_destroyJsonVal(&val);
+        goto lbl_fail;
+    }
+
+    if (lexer->type == ',') goto lbl_next;
+    if (lexer->type == ((stack[depth - 1].val.type == JEST_JSONTYPE_ARR)? ']' : '}')) goto lbl_close;
+    err = JEST_ERROR_SYNTAX;
+
+lbl_fail:
+    while (depth) {
+        --depth;
+        Jest__free(ctx->arena, stack[depth].name);
+        Jest_destroyJsonVal(&stack[depth].val);
+    }
+
+    if (stack != local) free(stack);
+    return err;
+}
+
+static Jest_Error Jest__parseNull(Jest_JsonVal *out, Jest__ParseCtx *ctx)
+{
+    if (!out || !ctx) return JEST_ERROR_BADPARAM;
+    if (ctx->lexer->type != JEST_LEXEME_NULL) return JEST_ERROR_BADPARAM;
+
+    *out = Jest_jsonNull();
+    Jest_lexerStep(ctx->lexer);
+
+    return JEST_ERROR_NONE;
+}
+
+static Jest_Error Jest__parseBool(Jest_JsonVal *out, Jest__ParseCtx *ctx)
+{
+    if (!out || !ctx) return JEST_ERROR_BADPARAM;
+    if (ctx->lexer->type != JEST_LEXEME_BOOL) return JEST_ERROR_BADPARAM;
+
+    *out = Jest_jsonBool(ctx->lexer->boolval);
+    Jest_lexerStep(ctx->lexer);
+
+    return JEST_ERROR_NONE;
+}
+
+static Jest_Error Jest__parseNum(Jest_JsonVal *out, Jest__ParseCtx *ctx)
+{
+    if (!out || !ctx) return JEST_ERROR_BADPARAM;
+    if (ctx->lexer->type != JEST_LEXEME_NUM) return JEST_ERROR_BADPARAM;
+
+    *out = Jest_jsonNumber(ctx->lexer->numval);
+    Jest_lexerStep(ctx->lexer);
+
+    return JEST_ERROR_NONE;
+}
+
+static Jest_Error Jest__parseStr(Jest_JsonVal *out, Jest__ParseCtx *ctx)
+{
+    if (!out || !ctx) return JEST_ERROR_BADPARAM;
+
+    Jest_Lexer *lexer = ctx->lexer;
+    if (lexer->type != JEST_LEXEME_STR) return JEST_ERROR_BADPARAM;
+
+    *out = Jest_jsonNull();
+    char *data = Jest__lexerStrDup(ctx, lexer->strval, lexer->strval_len);
+    if (!data) return JEST_ERROR_NOMEM;
+
+    out->type = JEST_JSONTYPE_STR;
+    out->flags = (ctx->arena)? JEST_JSONFLAG_ARENA : 0;
+    out->v.as_str.len = lexer->strval_len;
+    out->v.as_str.data = data;
+
+    Jest_lexerStep(lexer);
+    return JEST_ERROR_NONE;
+}
+
+typedef struct Jest__DiyFp {
+    uint64_t f;
+    int e;
+} Jest__DiyFp;
+
+static Jest__DiyFp Jest__diyFp(uint64_t f, int e)
+{
+    Jest__DiyFp ret;
+    ret.f = f;
+    ret.e = e;
+    return ret;
+}
+
+static Jest__DiyFp Jest__diyFpMul(Jest__DiyFp x, Jest__DiyFp y)
+{
+    // upper 64 bits of the 128-bit product, rounded
+    const uint64_t m32 = UINT64_C(0xffffffff);
+    const uint64_t a = x.f >> 32, b = x.f & m32, c = y.f >> 32, d = y.f & m32;
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+
+    uint64_t tmp = (bd >> 32) + (ad & m32) + (bc & m32);
+    tmp += UINT64_C(1) << 31;
+
+    return Jest__diyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64);
+}
+
+static Jest__DiyFp Jest__diyFpNormalize(Jest__DiyFp x)
+{
+#ifdef __GNUC__
+    const int shift = __builtin_clzll(x.f);
+#else
+    int shift = 0;
+    while (!((x.f << shift) >> 63)) ++shift;
+#endif // __GNUC__
+    return Jest__diyFp(x.f << shift, x.e - shift);
+}
+
+static Jest__DiyFp Jest__cachedPow10(int e, int *k)
+{
+    // normalized 10^(-348 + 8i), these are the powers grisu needs to bring any double into range
+    static const uint64_t pow10_f[] = {
+        UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76), UINT64_C(0x8b16fb203055ac76),
+        UINT64_C(0xcf42894a5dce35ea), UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df),
+        UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f), UINT64_C(0xbe5691ef416bd60c),
+        UINT64_C(0x8dd01fad907ffc3c), UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+        UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d), UINT64_C(0x823c12795db6ce57),
+        UINT64_C(0xc21094364dfb5637), UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7),
+        UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5), UINT64_C(0xb23867fb2a35b28e),
+        UINT64_C(0x84c8d4dfd2c63f3b), UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+        UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6), UINT64_C(0xf3e2f893dec3f126),
+        UINT64_C(0xb5b5ada8aaff80b8), UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053),
+        UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd), UINT64_C(0xa6dfbd9fb8e5b88f),
+        UINT64_C(0xf8a95fcf88747d94), UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+        UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac), UINT64_C(0xe45c10c42a2b3b06),
+        UINT64_C(0xaa242499697392d3), UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb),
+        UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c), UINT64_C(0x9c40000000000000),
+        UINT64_C(0xe8d4a51000000000), UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+        UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70), UINT64_C(0xd5d238a4abe98068),
+        UINT64_C(0x9f4f2726179a2245), UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8),
+        UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a), UINT64_C(0x924d692ca61be758),
+        UINT64_C(0xda01ee641a708dea), UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+        UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2), UINT64_C(0xc83553c5c8965d3d),
+        UINT64_C(0x952ab45cfa97a0b3), UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25),
+        UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece), UINT64_C(0x88fcf317f22241e2),
+        UINT64_C(0xcc20ce9bd35c78a5), UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+        UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c), UINT64_C(0xbb764c4ca7a44410),
+        UINT64_C(0x8bab8eefb6409c1a), UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129),
+        UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429), UINT64_C(0x80444b5e7aa7cf85),
+        UINT64_C(0xbf21e44003acdd2d), UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+        UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9), UINT64_C(0xaf87023b9bf0ee6b)
+    };
+
+    static const short pow10_e[] = {
+        -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+        -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+        -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+        -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+        56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+        375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+        694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+        1013, 1039, 1066
+    };
+
+    const double dk = (-61 - e) * 0.30102999566398114 + 347; // dk must be positive so it can be truncated with a cast
+    int ik = (int)dk;
+    if (dk - ik > 0.0) ++ik;
+
+    const unsigned idx = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)idx * 8);
+
+    return Jest__diyFp(pow10_f[idx], pow10_e[idx]);
+}
+
+static void Jest__grisuRound(char *buffer, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        --buffer[len - 1];
+        rest += ten_kappa;
+    }
+}
+
+static int Jest__grisu2(double x, char *buffer, int *k)
+{
+    static const uint64_t pow10[] = {
+        UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000),
+        UINT64_C(100000), UINT64_C(1000000), UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000),
+        UINT64_C(10000000000), UINT64_C(100000000000), UINT64_C(1000000000000), UINT64_C(10000000000000),
+        UINT64_C(100000000000000), UINT64_C(1000000000000000), UINT64_C(10000000000000000),
+        UINT64_C(100000000000000000), UINT64_C(1000000000000000000), UINT64_C(10000000000000000000)
+    };
+
+    const uint64_t hidden_bit = UINT64_C(0x0010000000000000);
+
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+
+    const int biased_e = (int)((bits >> 52) & 0x7ff);
+    const uint64_t significand = bits & (hidden_bit - 1);
+    const Jest__DiyFp v = (biased_e)
+        ? Jest__diyFp(significand + hidden_bit, biased_e - 1075)
+        : Jest__diyFp(significand, -1074);
+
+    // the boundaries halfway to the neighbouring doubles, anything between them reads back as x
+    Jest__DiyFp plus = Jest__diyFp((v.f << 1) + 1, v.e - 1);
+    while (!(plus.f & (hidden_bit << 1))) {
+        plus.f <<= 1;
+        --plus.e;
+    }
+    plus.f <<= 10;
+    plus.e -= 10;
+
+    Jest__DiyFp minus = (v.f == hidden_bit)? Jest__diyFp((v.f << 2) - 1, v.e - 2) : Jest__diyFp((v.f << 1) - 1, v.e - 1);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    const Jest__DiyFp c_mk = Jest__cachedPow10(plus.e, k);
+    const Jest__DiyFp w = Jest__diyFpMul(Jest__diyFpNormalize(v), c_mk);
+    Jest__DiyFp wp = Jest__diyFpMul(plus, c_mk);
+    Jest__DiyFp wm = Jest__diyFpMul(minus, c_mk);
+    ++wm.f;
+    --wp.f;
+
+    // generate the shortest digits that stay within (wm, wp)
+    uint64_t delta = wp.f - wm.f;
+    const Jest__DiyFp one = Jest__diyFp(UINT64_C(1) << -wp.e, wp.e);
+    const uint64_t wp_w = wp.f - w.f;
+
+    uint32_t p1 = (uint32_t)(wp.f >> -one.e);
+    uint64_t p2 = wp.f & (one.f - 1);
+
+    int kappa = 1;
+    while (kappa < 10 && p1 >= pow10[kappa]) ++kappa;
+
+    int len = 0;
+    while (kappa > 0) {
+        const uint32_t d = (uint32_t)(p1 / pow10[kappa - 1]);
+        p1 %= (uint32_t)pow10[kappa - 1];
+        if (d || len) buffer[len++] = (char)('0' + d);
+        --kappa;
+
+        const uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta) {
+            *k += kappa;
+            Jest__grisuRound(buffer, len, delta, rest, pow10[kappa] << -one.e, wp_w);
+            return len;
+        }
+    }
+
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+
+        const char d = (char)(p2 >> -one.e);
+        if (d || len) buffer[len++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        --kappa;
+
+        if (p2 < delta) {
+            *k += kappa;
+            Jest__grisuRound(buffer, len, delta, p2, one.f, (-kappa < 20)? wp_w * pow10[-kappa] : 0);
+            return len;
+        }
+    }
+}
+
+static bool Jest__fileWriteFn(void *userdata, const char *data, size_t len)
+{
+    return fwrite(data, 1, len, (FILE *)userdata) == len;
+}
+
+static size_t Jest__writeDouble(char *buffer, double x)
+{
+    size_t len = 0;
+    if (Jest_signbit(x)) buffer[len++] = '-';
+
+    if (Jest_isinf(x)) {
+        memcpy(&buffer[len], "Infinity", 8);
+        return len + 8;
+    }
+
+    if (Jest_isnan(x)) {
+        memcpy(&buffer[len], "NaN", 3);
+        return len + 3;
+    }
+
+    if (x == 0.0) {
+        buffer[len++] = '0';
+        return len;
+    }
+
+    char digits[24];
+    int k;
+    const int ndigits = Jest__grisu2((x < 0)? -x : x, digits, &k);
+
+    // the value is 0.digits * 10^point, laid out like javascript's Number.prototype.toString
+    const int point = ndigits + k;
+    char *out = &buffer[len];
+
+    if (k >= 0 && point <= 21) { // 1234e7 -> 12340000000
+        memcpy(out, digits, (size_t)ndigits);
+        memset(&out[ndigits], '0', (size_t)k);
+        return len + (size_t)point;
+    }
+
+    if (point > 0 && point <= 21) { // 1234e-2 -> 12.34
+        memcpy(out, digits, (size_t)point);
+        out[point] = '.';
+        memcpy(&out[point + 1], &digits[point], (size_t)(ndigits - point));
+        return len + (size_t)ndigits + 1;
+    }
+
+    if (point > -6 && point <= 0) { // 1234e-6 -> 0.001234
+        out[0] = '0';
+        out[1] = '.';
+        memset(&out[2], '0', (size_t)-point);
+        memcpy(&out[2 - point], digits, (size_t)ndigits);
+        return len + 2 + (size_t)(ndigits - point);
+    }
+
+    // 1234e30 -> 1.234e+33
+    size_t i = 0;
+    out[i++] = digits[0];
+    if (ndigits > 1) {
+        out[i++] = '.';
+        memcpy(&out[i], &digits[1], (size_t)(ndigits - 1));
+        i += (size_t)(ndigits - 1);
+    }
+
+    int exp = point - 1;
+    out[i++] = 'e';
+    out[i++] = (exp < 0)? '-' : '+';
+    if (exp < 0) exp = -exp;
+
+    if (exp >= 100) out[i++] = (char)('0' + exp / 100);
+    if (exp >= 10) out[i++] = (char)('0' + exp / 10 % 10);
+    out[i++] = (char)('0' + exp % 10);
+
+    return len + i;
+}
+
+static void Jest__writerPut(Jest__Writer *w, const char *data, size_t len)
+{
+    if (w->err || !len) return;
+
+    if (w->len + len > w->cap) {
+        if (w->write_fn) {
+            if (w->len && !w->write_fn(w->userdata, w->buf, w->len)) {
+                w->err = JEST_ERROR_IO;
+                return;
+            }
+            w->len = 0;
+
+            // chunks that wouldn't fit anyways are passed straight through
+            if (len >= w->cap) {
+                if (!w->write_fn(w->userdata, data, len)) w->err = JEST_ERROR_IO;
+                return;
+            }
+        } else {
+            size_t cap = (w->cap)? w->cap : 256;
+            while (cap < w->len + len + 1) cap *= 2;
+
+            char *buf = (char *)realloc(w->buf, cap);
+            if (!buf) {
+                w->err = JEST_ERROR_NOMEM;
+                return;
+            }
+
+            w->buf = buf;
+            w->cap = cap;
+        }
+    }
+
+    memcpy(&w->buf[w->len], data, len);
+    w->len += len;
+}
+
+static void Jest__writerPutc(Jest__Writer *w, char c)
+{
+    if (w->len < w->cap) w->buf[w->len++] = c;
+    else Jest__writerPut(w, &c, 1);
+}
+
+static void Jest__writerTabs(Jest__Writer *w, int ntabs)
+{
+    static const char tabs[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+    for (; ntabs > 0; ntabs -= (int)sizeof(tabs) - 1) {
+        Jest__writerPut(w, tabs, (ntabs < (int)sizeof(tabs) - 1)? (size_t)ntabs : sizeof(tabs) - 1);
+    }
+}
+
+static void Jest__writeStr(Jest__Writer *w, const char *data, size_t len)
+{
+    const bool escape_unicode = (w->flags & JEST_WRITE_ESCAPE_UNICODE) != 0;
+    char esc[16];
+
+    Jest__writerPutc(w, '"');
+
+    size_t i = 0;
+    while (i < len) {
+        // copy everything that doesn't need escaping at once
+        size_t run = i;
+        while (run < len) {
+            const uint8_t c = (uint8_t)data[run];
+            if (c < 0x20 || c == 0x7f || c == '"' || c == '\\' || c == '\'' || c == '/') break;
+            if (escape_unicode && c >= 0x80) break;
+            ++run;
+        }
+
+        Jest__writerPut(w, &data[i], run - i);
+        i = run;
+        if (i >= len) break;
+
+        switch (data[i]) {
+            case '\n': Jest__writerPut(w, "\\n", 2);  ++i; continue;
+            case '\\': Jest__writerPut(w, "\\\\", 2); ++i; continue;
+            case '\'': Jest__writerPut(w, "\\'", 2);  ++i; continue;
+            case '\"': Jest__writerPut(w, "\\\"", 2); ++i; continue;
+            case '/':  Jest__writerPut(w, "\\/", 2);  ++i; continue;
+            case '\b': Jest__writerPut(w, "\\b", 2);  ++i; continue;
+            case '\f': Jest__writerPut(w, "\\f", 2);  ++i; continue;
+            case '\r': Jest__writerPut(w, "\\r", 2);  ++i; continue;
+            case '\t': Jest__writerPut(w, "\\t", 2);  ++i; continue;
+            case '\v': Jest__writerPut(w, "\\v", 2);  ++i; continue;
+            default: break;
+        }
+
+        uint32_t codepoint = (uint8_t)data[i];
+        size_t seq_len = 1;
+
+        if ((codepoint & 0xe0) == 0xc0) {
+            seq_len = 2;
+            codepoint &= 0x1f;
+        } else if ((codepoint & 0xf0) == 0xe0) {
+            seq_len = 3;
+            codepoint &= 0x0f;
+        } else if ((codepoint & 0xf8) == 0xf0) {
+            seq_len = 4;
+            codepoint &= 0x07;
+        }
+
+        // truncated sequences are escaped a byte at a time
+        if (i + seq_len > len) seq_len = 1;
+        for (size_t j = 1; j < seq_len; ++j) {
+            codepoint = (codepoint << 6) | ((uint8_t)data[i + j] & 0x3f);
+        }
+        if (seq_len == 1) codepoint = (uint8_t)data[i];
+        i += seq_len;
+
+        if (codepoint >= 0x10000) {
+            // break the codepoint into utf-16 surrogate pairs
+            codepoint -= 0x10000;
+            codepoint &= 0xfffff;
+            const uint16_t hi = (uint16_t)((codepoint >> 10) + 0xd800);
+            const uint16_t lo = (uint16_t)((codepoint & 0x3ff) + 0xdc00);
+
+            Jest__writerPut(w, esc, (size_t)sprintf(esc, "\\u%.4" PRIx32 "\\u%.4" PRIx32, (uint32_t)hi, (uint32_t)lo));
+            continue;
+        }
+
+        Jest__writerPut(w, esc, (size_t)sprintf(esc, "\\u%.4" PRIx32, codepoint));
+    }
+
+    Jest__writerPutc(w, '"');
+}
+
+static void Jest__writeJsonVal(Jest__Writer *w, const Jest_JsonVal *val)
+{
+    if (!val || w->err) return;
+
+    JEST__STAT_START(start);
+    const bool pretty = (w->flags & JEST_WRITE_PRETTY) != 0;
+
+    // open containers and how far into them the writer is, the depth doubles as the indentation
+    Jest__WalkFrame local[JEST__LOCAL_FRAMES];
+    Jest__WalkFrame *stack = local;
+    size_t depth = 0, cap = JEST__LOCAL_FRAMES;
+    int starttabs = 0;
+
+lbl_value:
+    if (w->err) goto lbl_done;
+    if (pretty) Jest__writerTabs(w, starttabs);
+
+    switch (val->type) {
+        case JEST_JSONTYPE_NULL: Jest__writerPut(w, "null", 4); break;
+        case JEST_JSONTYPE_BOOL: Jest__writerPut(w, (val->v.as_bool)? "true" : "false", (val->v.as_bool)? 4 : 5); break;
+        case JEST_JSONTYPE_NUM:  goto lbl_write_num;
+        case JEST_JSONTYPE_STR:  Jest__writeStr(w, val->v.as_str.data, val->v.as_str.len); break;
+        case JEST_JSONTYPE_ARR:  goto lbl_open;
+        case JEST_JSONTYPE_OBJ:  goto lbl_open;
+        case JEST_JSONTYPE_ERR:  break;
+    }
+
+    goto lbl_next;
+
+lbl_write_num: {
+        char numbuf[32];
+        Jest__writerPut(w, numbuf, Jest__writeDouble(numbuf, val->v.as_num));
+    } goto lbl_next;
+
+lbl_open:
+    if (depth == cap) {
+        Jest__WalkFrame *grown = (Jest__WalkFrame *)Jest__growStack(stack, local, &cap, sizeof(*stack));
+        if (!grown) {
+            w->err = JEST_ERROR_NOMEM;
+            goto lbl_done;
+        }
+
+        stack = grown;
+    }
+
+    stack[depth].val = val;
+    stack[depth].idx = 0;
+    ++depth;
+    Jest__writerPutc(w, (val->type == JEST_JSONTYPE_ARR)? '[' : '{');
+
+lbl_next:
+    while (depth && !w->err) {
+        Jest__WalkFrame *top = &stack[depth - 1];
+        const Jest_JsonVal *c = top->val;
+        const int midtabs = (int)depth - 1;
+
+        if (c->type == JEST_JSONTYPE_ARR && top->idx < c->v.as_arr.len) {
+            if (top->idx) Jest__writerPutc(w, ',');
+            if (pretty) Jest__writerPutc(w, '\n');
+
+            val = &c->v.as_arr.elems[top->idx++];
+            starttabs = midtabs + 1;
+            goto lbl_value;
+        }
+
+        if (c->type == JEST_JSONTYPE_OBJ && top->idx < c->v.as_obj.nfields) {
+            if (top->idx) Jest__writerPutc(w, ',');
+            if (pretty) {
+                Jest__writerPutc(w, '\n');
+                Jest__writerTabs(w, midtabs + 1);
+            }
+
+            Jest__writeStr(w, c->v.as_obj.field_names[top->idx], c->v.as_obj.fn_lens[top->idx]);
+            Jest__writerPutc(w, ':');
+            if (pretty) Jest__writerPutc(w, ' ');
+
+            val = &c->v.as_obj.field_values[top->idx++];
+            starttabs = 0;
+            goto lbl_value;
+        }
+
+        if (pretty) {
+            Jest__writerPutc(w, '\n');
+            Jest__writerTabs(w, midtabs);
+        }
+
+        Jest__writerPutc(w, (c->type == JEST_JSONTYPE_ARR)? ']' : '}');
+        --depth;
+    }
+
+lbl_done:
+    if (stack != local) free(stack);
+    JEST__STAT(Jest__stats.write_time += Jest__statSince(start));
+}
+
+#endif // JEST_IMPL
@@ -0,0 +1,108 @@
+// unit tests, `make test` builds and runs them and exits with a failure if any check failed
+
+#define JEST_IMPL 1
+#include "test.h"
+
+int test_checks;
+int test_failures;
+
+void test_check(const char *file, int line, bool ok, const char *what)
+{
+    ++test_checks;
+    if (ok) return;
+
+    ++test_failures;
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+}
+
+void test_check_str(const char *file, int line, const char *got, const char *expected)
+{
+    ++test_checks;
+    if (got && expected && !strcmp(got, expected)) return;
+
+    ++test_failures;
+    fprintf(stderr, "%s:%d: expected %s, got %s\n", file, line, (expected)? expected : "(null)", (got)? got : "(null)");
+}
+
+void test_check_json(const char *file, int line, const char *src, const char *expected)
+{
+    Jest_JsonVal val;
+    const Jest_Error err = Jest_parseJsonFromStr(&val, src);
+
+    if (!expected) {
+        test_check(file, line, err != JEST_ERROR_NONE, src);
+        if (!err) Jest_destroyJsonVal(&val);
+        return;
+    }
+
+    if (err) {
+        ++test_checks;
+        ++test_failures;
+        fprintf(stderr, "%s:%d: %s failed to parse with error %d\n", file, line, src, (int)err);
+        return;
+    }
+
+    char *got = test_write(&val);
+    test_check_str(file, line, got, expected);
+
+    free(got);
+    Jest_destroyJsonVal(&val);
+}
+
+char *test_write(const Jest_JsonVal *val)
+{
+    char *out = NULL;
+    if (Jest_writeJsonToBuffer(&out, NULL, val, 0)) return NULL;
+    return out;
+}
+
+const char *test_scratch_file(const void *data, size_t len)
+{
+    static const char path[] = "tests.scratch.json";
+
+    FILE *file = fopen(path, "wb");
+    if (!file) return NULL;
+
+    const bool ok = fwrite(data, 1, len, file) == len;
+    return (fclose(file) || !ok)? NULL : path;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        void (*run)(void);
+    } suites[] = {
+        {"arena", test_arena},
+        {"objects", test_objects},
+        {"strings", test_strings},
+        {"scan", test_scan},
+        {"numbers", test_numbers},
+        {"doubles", test_doubles},
+        {"writer", test_writer},
+        {"sax", test_sax},
+        {"chunks", test_chunks},
+        {"files", test_files},
+        {"paths", test_paths},
+        {"lazy", test_lazy},
+        {"tape", test_tape},
+        {"lines", test_lines},
+        {"parallel", test_parallel},
+        {"depth", test_depth},
+        {"parser", test_parser},
+        {"intern", test_intern},
+        {"insitu", test_insitu},
+        {"lexer", test_lexer},
+        {"stats", test_stats},
+    };
+
+    for (size_t i = 0; i < sizeof(suites) / sizeof(*suites); ++i) {
+        const int failures = test_failures;
+        suites[i].run();
+        printf("%-16s %s\n", suites[i].name, (test_failures == failures)? "ok" : "FAILED");
+    }
+
+    remove("tests.scratch.json");
+    printf("%d checks, %d failed\n", test_checks, test_failures);
+    return test_failures != 0;
+}
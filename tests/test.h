@@ -0,0 +1,69 @@
+#ifndef TEST_H_
+#define TEST_H_ 1
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../jest.h"
+
+extern int test_checks;
+extern int test_failures;
+
+// records a failure along with where it happened and carries on with the rest of the test
+#define CHECK(cond) test_check(__FILE__, __LINE__, (cond) != 0, #cond)
+
+// like CHECK for two nul-terminated strings, printing both when they differ, NULL never matches
+#define CHECK_STR(got, expected) test_check_str(__FILE__, __LINE__, (got), (expected))
+
+// parses src into a value and checks that it writes back as the compact json in expected,
+// a NULL expected means src has to be rejected
+#define CHECK_JSON(src, expected) test_check_json(__FILE__, __LINE__, (src), (expected))
+
+void test_check(const char *file, int line, bool ok, const char *what);
+void test_check_str(const char *file, int line, const char *got, const char *expected);
+void test_check_json(const char *file, int line, const char *src, const char *expected);
+
+// compact json of val in a malloc'd string, NULL if it couldn't be written
+char *test_write(const Jest_JsonVal *val);
+
+// writes len bytes of data to a scratch file in the working directory and returns its path,
+// NULL if it couldn't be written, every call overwrites the file of the one before
+const char *test_scratch_file(const void *data, size_t len);
+
+// records sax events as text like "{ k:a [ n:1 s:x true null ] }", the callback for
+// event number stop_at returns false, 0 never stops
+typedef struct TestEvents {
+    char *text;
+    size_t len, cap;
+    size_t count, stop_at;
+} TestEvents;
+
+extern const Jest_SaxHandler test_events_handler;
+void test_events_init(TestEvents *ev, size_t stop_at);
+void test_events_destroy(TestEvents *ev);
+const char *test_events_text(const TestEvents *ev);
+
+// the suites, one per feature, run in this order by main.c
+void test_arena(void);
+void test_objects(void);
+void test_strings(void);
+void test_scan(void);
+void test_numbers(void);
+void test_doubles(void);
+void test_writer(void);
+void test_sax(void);
+void test_chunks(void);
+void test_files(void);
+void test_paths(void);
+void test_lazy(void);
+void test_tape(void);
+void test_lines(void);
+void test_parallel(void);
+void test_depth(void);
+void test_parser(void);
+void test_intern(void);
+void test_insitu(void);
+void test_lexer(void);
+void test_stats(void);
+
+#endif // !TEST_H_
@@ -0,0 +1,198 @@
+// the arena that documents allocate from, its blocks and how allocations in them grow and get reused
+#include "test.h"
+
+#include <stdint.h>
+
+static bool aligned(const void *ptr)
+{
+    return (uintptr_t)ptr % 16 == 0;
+}
+
+static void allocs(void)
+{
+    Jest_Arena arena;
+    Jest_initArena(&arena, 1024);
+
+    // small allocations follow one another in the same block, each of them aligned
+    char *a = (char *)Jest_arenaAlloc(&arena, 10);
+    char *b = (char *)Jest_arenaAlloc(&arena, 1);
+    char *c = (char *)Jest_arenaAlloc(&arena, 0);
+    CHECK(a && b && c && aligned(a) && aligned(b) && aligned(c));
+    CHECK(b == a + 16 && c == b + 16);
+
+    // large ones get a block of their own and the small ones carry on where they left off
+    char *large = (char *)Jest_arenaAlloc(&arena, 1000);
+    char *d = (char *)Jest_arenaAlloc(&arena, 16);
+    CHECK(large && aligned(large) && d == c + 16);
+
+    // a small allocation that doesn't fit what's left of the block starts a new one
+    char *e = (char *)Jest_arenaAlloc(&arena, 256);
+    char *f = (char *)Jest_arenaAlloc(&arena, 256);
+    char *g = (char *)Jest_arenaAlloc(&arena, 256);
+    char *h = (char *)Jest_arenaAlloc(&arena, 256);
+    CHECK(e == d + 16 && f == e + 256 && g == f + 256 && h && h != g + 256);
+
+    // none of them overlap
+    memset(a, 'a', 10);
+    memset(b, 'b', 1);
+    memset(large, 'l', 1000);
+    memset(d, 'd', 16);
+    memset(e, 'e', 256);
+    memset(h, 'h', 256);
+    CHECK(a[9] == 'a' && b[0] == 'b' && large[0] == 'l' && large[999] == 'l' && d[15] == 'd' && e[255] == 'e' && h[0] == 'h');
+
+    CHECK(Jest_arenaAlloc(NULL, 1) == NULL);
+    Jest_destroyArena(&arena);
+    Jest_arenaReset(NULL);
+    Jest_destroyArena(NULL);
+}
+
+static void resets(void)
+{
+    Jest_Arena arena;
+    Jest_initArena(&arena, 0);
+
+    // after a reset the same allocations get the same memory, the blocks aren't malloc'd again
+    void *small = Jest_arenaAlloc(&arena, 100);
+    void *large = Jest_arenaAlloc(&arena, JEST_ARENA_BLOCK_SIZE / 2);
+    void *larger = Jest_arenaAlloc(&arena, 2 * JEST_ARENA_BLOCK_SIZE);
+    CHECK(small && large && larger);
+
+    for (int i = 0; i < 3; ++i) {
+        Jest_arenaReset(&arena);
+        CHECK(Jest_arenaAlloc(&arena, 100) == small);
+        CHECK(Jest_arenaAlloc(&arena, 2 * JEST_ARENA_BLOCK_SIZE) == larger);
+        CHECK(Jest_arenaAlloc(&arena, JEST_ARENA_BLOCK_SIZE / 2) == large);
+    }
+
+    // a large allocation takes the smallest spare block that fits, whatever order they were freed in
+    Jest_arenaReset(&arena);
+    CHECK(Jest_arenaAlloc(&arena, JEST_ARENA_BLOCK_SIZE / 4 + 16) == large);
+    CHECK(Jest_arenaAlloc(&arena, 100) == small);
+    CHECK(Jest_arenaAlloc(&arena, JEST_ARENA_BLOCK_SIZE + 16) == larger);
+    void *fresh = Jest_arenaAlloc(&arena, JEST_ARENA_BLOCK_SIZE / 2);
+    CHECK(fresh && fresh != small && fresh != large && fresh != larger);
+
+    // and everything, spare or not, is freed with the arena
+    Jest_arenaReset(&arena);
+    CHECK(Jest_arenaAlloc(&arena, 1) == small);
+    Jest_destroyArena(&arena);
+    CHECK(arena.head == NULL && arena.spare == NULL);
+}
+
+// appends to arr until it holds n numbers, NULL if anything went wrong on the way
+static const Jest_JsonVal *append_until(Jest_Document *doc, Jest_JsonVal *arr, size_t n)
+{
+    while (arr->v.as_arr.len < n) {
+        const Jest_JsonVal elem = Jest_jsonNumber((double)arr->v.as_arr.len);
+        if (Jest_docArrayAppend(doc, arr, &elem) != JEST_ERROR_NONE) return NULL;
+    }
+
+    return arr->v.as_arr.elems;
+}
+
+static bool counts_up(const Jest_JsonVal *arr)
+{
+    for (size_t i = 0; i < arr->v.as_arr.len; ++i) {
+        if (arr->v.as_arr.elems[i].type != JEST_JSONTYPE_NUM || arr->v.as_arr.elems[i].v.as_num != (double)i) return false;
+    }
+
+    return true;
+}
+
+static void grows(void)
+{
+    // arrays start at 32 elements and double, with these blocks up to 64 of them count as a small allocation
+    const size_t elem_sz = sizeof(Jest_JsonVal);
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+    doc.arena.block_sz = 256 * elem_sz;
+
+    Jest_JsonVal arr = Jest_jsonArray();
+    arr.flags = JEST_JSONFLAG_ARENA;
+
+    // the last allocation of a block grows in place
+    const Jest_JsonVal *elems = append_until(&doc, &arr, 32);
+    CHECK(elems != NULL && arr.v.as_arr.cap == 32);
+    CHECK(append_until(&doc, &arr, 64) == elems && arr.v.as_arr.cap == 64);
+
+    // until it's too big for one, then it moves to a large block of its own
+    Jest_JsonVal before = Jest_docString(&doc, "before");
+    const Jest_JsonVal *promoted = append_until(&doc, &arr, 128);
+    CHECK(promoted != NULL && promoted != elems && counts_up(&arr));
+    Jest_JsonVal after = Jest_docString(&doc, "after");
+
+    // which itself grows, with other blocks around it in the arena's list
+    void *other = Jest_arenaAlloc(&doc.arena, 128 * elem_sz);
+    CHECK(other != NULL);
+    const Jest_JsonVal *large = append_until(&doc, &arr, 512);
+    CHECK(large != NULL && counts_up(&arr) && arr.v.as_arr.cap == 512);
+    CHECK_STR(before.v.as_str.data, "before");
+    CHECK_STR(after.v.as_str.data, "after");
+
+    // after a reset the spare blocks are handed out again: the array is promoted into the block of other,
+    // then moved into its old large block between the blocks on either side, leaving the block of other
+    // in the spares once more
+    Jest_arenaReset(&doc.arena);
+    arr = Jest_jsonArray();
+    arr.flags = JEST_JSONFLAG_ARENA;
+    CHECK(append_until(&doc, &arr, 64) == elems);
+    void *oldest = Jest_arenaAlloc(&doc.arena, 1024 * elem_sz);
+    CHECK(oldest != NULL);
+    CHECK(append_until(&doc, &arr, 128) == other);
+    Jest_JsonVal between = Jest_docString(&doc, "between");
+    CHECK(append_until(&doc, &arr, 256) == large);
+    CHECK(append_until(&doc, &arr, 512) == large && counts_up(&arr));
+    CHECK_STR(between.v.as_str.data, "between");
+
+    // all of the blocks are still linked up, whichever of them moved
+    Jest_arenaReset(&doc.arena);
+    CHECK(Jest_arenaAlloc(&doc.arena, 128 * elem_sz) == other);
+    CHECK(Jest_arenaAlloc(&doc.arena, 512 * elem_sz) == large);
+    CHECK(Jest_arenaAlloc(&doc.arena, 1024 * elem_sz) == oldest);
+    CHECK(Jest_arenaAlloc(&doc.arena, 1) == (void *)elems);
+    Jest_destroyDocument(&doc);
+}
+
+static void doc_values(void)
+{
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+
+    // strings are copied into the arena
+    char src[] = "copied";
+    Jest_JsonVal str = Jest_docString(&doc, src);
+    src[0] = 'X';
+    CHECK(str.type == JEST_JSONTYPE_STR && (str.flags & JEST_JSONFLAG_ARENA) && str.v.as_str.len == 6);
+    CHECK_STR(str.v.as_str.data, "copied");
+    CHECK(Jest_docString(&doc, "").v.as_str.len == 0);
+    CHECK(Jest_docString(NULL, "x").type == JEST_JSONTYPE_NULL);
+    CHECK(Jest_docString(&doc, NULL).type == JEST_JSONTYPE_NULL);
+
+    // arrays built in the document write out like parsed ones
+    doc.root = Jest_jsonArray();
+    doc.root.flags = JEST_JSONFLAG_ARENA;
+    for (int i = 0; i < 100; ++i) {
+        const Jest_JsonVal elem = (i % 2)? Jest_jsonNumber(i) : Jest_docString(&doc, "s");
+        CHECK(Jest_docArrayAppend(&doc, &doc.root, &elem) == JEST_ERROR_NONE);
+    }
+
+    char *out = test_write(&doc.root);
+    CHECK(out && doc.root.v.as_arr.len == 100 && !strncmp(out, "[\"s\",1,\"s\",3,", 13));
+    free(out);
+
+    const Jest_JsonVal num = Jest_jsonNumber(1);
+    CHECK(Jest_docArrayAppend(NULL, &doc.root, &num) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_docArrayAppend(&doc, NULL, &num) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_docArrayAppend(&doc, &doc.root, &doc.root) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_docArrayAppend(&doc, &str, &num) == JEST_ERROR_BADPARAM);
+    Jest_destroyDocument(&doc);
+}
+
+void test_arena(void)
+{
+    allocs();
+    resets();
+    grows();
+    doc_values();
+}
@@ -0,0 +1,214 @@
+// the chunk parser has to give the same result however its input is split up
+#include "test.h"
+
+static const char *const documents[] = {
+    "{\"a\": [1, 2.5e-3, -0x1F, .5, +7., Infinity, -Infinity], \"b\": {\"c\": null, d: true, e: false}}",
+    "[\"plain\", 'single', \"esc\\\"aped\\\\\", \"\\u00e9\\ud83d\\ude00\\x41\\n\", \"line\\\n    continued\"]",
+    "  // leading comment\n /* block\n comment */ [1, /* inside */ 2, // to the end\n 3] ",
+    "{long_identifier_key: 12345678901234567890123, $x: 'y', _z: [[[[]]]], trueish: 'k', nullify: 0}",
+    "[true, false, null, 1e5, 1E+5, 1e-5, -0, 0.0]",
+    "\"just a string\"",
+    "12345.6789e1",
+    "[ ]",
+    "{}"
+};
+
+static const char *const broken[] = {
+    "[1, 2", "{\"a\": }", "[\"bad \\uZZZZ\"]", "[\"bad \\xZ\"]", "[1 2]", "{a 1}", "[/ 1]", "[1, /* open",
+    "[\"open", "['open\\'", "[tru]", "[1.2.3]", "[-]", "{\"a\": 1,, }", "[@]"
+};
+
+// events and the tree for src fed in pieces of the given lengths, which repeat until it's all in
+static Jest_Error feed(const char *src, const size_t *pieces, size_t npieces, char **events, char **tree)
+{
+    const size_t len = strlen(src);
+    Jest_Error err = JEST_ERROR_NONE, tree_err = JEST_ERROR_NONE;
+
+    TestEvents ev;
+    test_events_init(&ev, 0);
+    Jest_ChunkParser sax;
+    Jest_initChunkParser(&sax, &test_events_handler, &ev);
+
+    Jest_JsonVal val;
+    Jest_ChunkParser json;
+    Jest_initChunkParserJson(&json, &val);
+
+    for (size_t off = 0, i = 0; off < len; ++i) {
+        size_t n = pieces[i % npieces];
+        if (n > len - off) n = len - off;
+
+        if (!err) err = Jest_chunkParserFeed(&sax, &src[off], n);
+        if (!tree_err) tree_err = Jest_chunkParserFeed(&json, &src[off], n);
+        off += n;
+    }
+
+    if (!err) err = Jest_chunkParserFinish(&sax);
+    if (!tree_err) tree_err = Jest_chunkParserFinish(&json);
+
+    *events = (err)? NULL : Jest_strndup(test_events_text(&ev), ev.len);
+    *tree = (tree_err)? NULL : test_write(&val);
+    if (!err && tree_err) err = tree_err;
+
+    Jest_destroyChunkParser(&json);
+    if (!tree_err) Jest_destroyJsonVal(&val);
+    Jest_destroyChunkParser(&sax);
+    test_events_destroy(&ev);
+    return err;
+}
+
+// what the lexer based parsers make of src
+static Jest_Error whole(const char *src, char **events, char **tree)
+{
+    *events = *tree = NULL;
+
+    Jest_JsonVal val;
+    Jest_Error err = Jest_parseJsonFromStr(&val, src);
+    if (err) return err;
+
+    *tree = test_write(&val);
+    Jest_destroyJsonVal(&val);
+
+    TestEvents ev;
+    test_events_init(&ev, 0);
+    Jest_Lexer l;
+    if (Jest_initLexer(&l, NULL, 0, src, strlen(src))) err = Jest_parseSaxLexer(&l, &test_events_handler, &ev);
+    else err = JEST_ERROR_BADLEXER;
+
+    if (!err) *events = Jest_strndup(test_events_text(&ev), ev.len);
+    Jest_destroyLexer(&l);
+    test_events_destroy(&ev);
+    return err;
+}
+
+static void every_split(void)
+{
+    for (size_t d = 0; d < sizeof(documents) / sizeof(*documents); ++d) {
+        const char *src = documents[d];
+        const size_t len = strlen(src);
+
+        char *expected_events, *expected_tree;
+        CHECK(whole(src, &expected_events, &expected_tree) == JEST_ERROR_NONE);
+
+        // in two pieces split at every byte, then one byte at a time and in pieces of 2, 3 and 5
+        int mismatches = 0;
+        for (size_t split = 0; split <= len + 3; ++split) {
+            size_t pieces[3] = {split, len, 0};
+            size_t npieces = 2;
+            if (split == len + 1) pieces[0] = 1, npieces = 1;
+            if (split == len + 2) pieces[0] = 2, pieces[1] = 3, pieces[2] = 5, npieces = 3;
+            if (split == len + 3) pieces[0] = 7, pieces[1] = 1, npieces = 2;
+            if (!pieces[0]) pieces[0] = len;
+
+            char *events, *tree;
+            const Jest_Error err = feed(src, pieces, npieces, &events, &tree);
+            const bool same = !err && events && tree && expected_events && expected_tree
+                && !strcmp(events, expected_events) && !strcmp(tree, expected_tree);
+
+            if (!same && ++mismatches <= 3) {
+                fprintf(stderr, "    split %zu of %s: error %d, got %s\n", split, src, (int)err, (tree)? tree : "(null)");
+            }
+
+            free(events);
+            free(tree);
+        }
+
+        CHECK(mismatches == 0);
+        free(expected_events);
+        free(expected_tree);
+    }
+
+    // the same holds for input the parsers reject
+    for (size_t d = 0; d < sizeof(broken) / sizeof(*broken); ++d) {
+        char *events, *tree;
+        CHECK(whole(broken[d], &events, &tree) != JEST_ERROR_NONE);
+        free(events);
+        free(tree);
+
+        const size_t len = strlen(broken[d]);
+        bool all_rejected = true;
+        for (size_t split = 1; split <= len; ++split) {
+            const size_t pieces[2] = {split, len};
+            if (!feed(broken[d], pieces, 2, &events, &tree)) all_rejected = false;
+            free(events);
+            free(tree);
+        }
+
+        test_check(__FILE__, __LINE__, all_rejected, broken[d]);
+    }
+}
+
+// feeds n chunks of filler after start and returns the error of the last feed
+static Jest_Error feed_filler(Jest_ChunkParser *p, const char *start, char fill, size_t n, size_t *max_len)
+{
+    char chunk[8192];
+    memset(chunk, fill, sizeof(chunk));
+
+    Jest_Error err = Jest_chunkParserFeed(p, start, strlen(start));
+    *max_len = p->len;
+
+    for (size_t i = 0; i < n && !err; ++i) {
+        err = Jest_chunkParserFeed(p, chunk, sizeof(chunk));
+        if (p->len > *max_len) *max_len = p->len;
+    }
+
+    return err;
+}
+
+static void bounded(void)
+{
+    TestEvents ev;
+    Jest_ChunkParser p;
+    size_t max_len;
+
+    // whitespace and comments aren't carried over from one chunk to the next
+    static const char *const fillers[][2] = {
+        {"[1,", " 2]"}, {"[1", "]"}, {"[true", "]"}, {"[1, /*", "*/ 2]"}, {"[1, //", "\n2]"}, {"[\"done\" /* *", "*/]"}
+    };
+
+    for (size_t i = 0; i < sizeof(fillers) / sizeof(*fillers); ++i) {
+        test_events_init(&ev, 0);
+        Jest_initChunkParser(&p, &test_events_handler, &ev);
+
+        CHECK(feed_filler(&p, fillers[i][0], ' ', 1000, &max_len) == JEST_ERROR_NONE);
+        test_check(__FILE__, __LINE__, max_len < 16, fillers[i][0]);
+        CHECK(Jest_chunkParserFeed(&p, fillers[i][1], strlen(fillers[i][1])) == JEST_ERROR_NONE);
+        test_check(__FILE__, __LINE__, Jest_chunkParserFinish(&p) == JEST_ERROR_NONE, fillers[i][0]);
+
+        Jest_destroyChunkParser(&p);
+        test_events_destroy(&ev);
+    }
+
+    // broken escapes fail as soon as they're seen rather than once the string ends
+    static const char *const bad[] = {"[\"bad \\q\", \"\\uZ", "[\"\\u12G", "['\\xZ", "[1, @"};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(*bad); ++i) {
+        test_events_init(&ev, 0);
+        Jest_initChunkParser(&p, &test_events_handler, &ev);
+
+        test_check(__FILE__, __LINE__, feed_filler(&p, bad[i], ' ', 1000, &max_len) != JEST_ERROR_NONE, bad[i]);
+        test_check(__FILE__, __LINE__, max_len < 16, bad[i]);
+
+        Jest_destroyChunkParser(&p);
+        test_events_destroy(&ev);
+    }
+
+    // a string can't be dropped, but the parts that came in already aren't looked at again,
+    // so this finishes in linear time
+    Jest_JsonVal val;
+    Jest_initChunkParserJson(&p, &val);
+    CHECK(feed_filler(&p, "[\"", 'x', 1024, &max_len) == JEST_ERROR_NONE);
+    CHECK(max_len >= 1024 * 8192);
+
+    for (int i = 0; i < 100000; ++i) Jest_chunkParserFeed(&p, "\\\"", 2);
+    CHECK(Jest_chunkParserFeed(&p, "\"]", 2) == JEST_ERROR_NONE);
+    CHECK(Jest_chunkParserFinish(&p) == JEST_ERROR_NONE);
+    CHECK(val.type == JEST_JSONTYPE_ARR && val.v.as_arr.len == 1);
+    CHECK(val.v.as_arr.elems[0].v.as_str.len == 1024 * 8192 + 100000);
+    Jest_destroyChunkParser(&p);
+    Jest_destroyJsonVal(&val);
+}
+
+void test_chunks(void)
+{
+    every_split();
+    bounded();
+}
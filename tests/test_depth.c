@@ -0,0 +1,184 @@
+// nesting limits, which every parser enforces the same way, and nesting far beyond the c stack
+#include "test.h"
+
+// depth arrays with the innermost holding a 1, or objects when obj is set
+static char *make_nested(size_t depth, bool obj)
+{
+    const size_t per = (obj)? 5 : 1; // {"a": and } around every level of an object
+    char *src = (char *)malloc(depth * (per + 1) + 2);
+    if (!src) return NULL;
+
+    size_t n = 0;
+    for (size_t i = 0; i < depth; ++i) {
+        if (obj) {
+            memcpy(&src[n], "{\"a\":", 5);
+            n += 5;
+        } else {
+            src[n++] = '[';
+        }
+    }
+
+    src[n++] = '1';
+    for (size_t i = 0; i < depth; ++i) src[n++] = (obj)? '}' : ']';
+    src[n] = '\0';
+    return src;
+}
+
+static Jest_Error tree_depth(const char *src, size_t max_depth)
+{
+    Jest_Lexer l;
+    if (!Jest_initLexer(&l, NULL, 0, src, strlen(src))) {
+        Jest_destroyLexer(&l);
+        return JEST_ERROR_BADLEXER;
+    }
+
+    l.max_depth = max_depth;
+    Jest_JsonVal val;
+    const Jest_Error err = Jest_parseJsonLexer(&val, &l);
+    if (!err) Jest_destroyJsonVal(&val);
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+static Jest_Error sax_depth(const char *src, size_t max_depth)
+{
+    Jest_Lexer l;
+    if (!Jest_initLexer(&l, NULL, 0, src, strlen(src))) {
+        Jest_destroyLexer(&l);
+        return JEST_ERROR_BADLEXER;
+    }
+
+    TestEvents ev;
+    test_events_init(&ev, 0);
+    l.max_depth = max_depth;
+    const Jest_Error err = Jest_parseSaxLexer(&l, &test_events_handler, &ev);
+    test_events_destroy(&ev);
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+static Jest_Error tape_depth(const char *src, size_t max_depth)
+{
+    Jest_Lexer l;
+    if (!Jest_initLexer(&l, NULL, 0, src, strlen(src))) {
+        Jest_destroyLexer(&l);
+        return JEST_ERROR_BADLEXER;
+    }
+
+    l.max_depth = max_depth;
+    Jest_Tape tape;
+    const Jest_Error err = Jest_parseTapeLexer(&tape, &l);
+    if (!err) Jest_destroyTape(&tape);
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+static Jest_Error chunk_depth(const char *src, size_t max_depth)
+{
+    Jest_JsonVal val;
+    Jest_ChunkParser p;
+    Jest_initChunkParserJson(&p, &val);
+    p.lexer.max_depth = max_depth;
+
+    // a few bytes at a time so the limit has to hold across chunks
+    const size_t len = strlen(src);
+    Jest_Error err = JEST_ERROR_NONE;
+    for (size_t off = 0; !err && off < len; off += 3) err = Jest_chunkParserFeed(&p, &src[off], (len - off < 3)? len - off : 3);
+    if (!err) err = Jest_chunkParserFinish(&p);
+    if (!err) Jest_destroyJsonVal(&val);
+    Jest_destroyChunkParser(&p);
+    return err;
+}
+
+static Jest_Error parser_depth(const char *src, size_t max_depth)
+{
+    Jest_Parser p;
+    Jest_initParser(&p);
+    p.lexer.max_depth = max_depth;
+
+    // twice, the limit outlives a parse
+    Jest_Error err = Jest_parserParse(&p, src, strlen(src));
+    if (!err) err = Jest_parserParse(&p, src, strlen(src));
+    Jest_destroyParser(&p);
+    return err;
+}
+
+typedef Jest_Error (*DepthFn)(const char *src, size_t max_depth);
+
+static void limits(void)
+{
+    static const DepthFn parsers[] = {tree_depth, sax_depth, tape_depth, chunk_depth, parser_depth};
+    static const char *const names[] = {"tree", "sax", "tape", "chunk", "parser"};
+
+    // the limit itself is fine and one more level isn't, in arrays and objects alike
+    static const size_t max_depths[] = {1, 3, 0, JEST_MAX_DEPTH + 50};
+    for (size_t m = 0; m < sizeof(max_depths) / sizeof(*max_depths); ++m) {
+        const size_t limit = (max_depths[m])? max_depths[m] : JEST_MAX_DEPTH;
+
+        for (int obj = 0; obj < 2; ++obj) {
+            char *at = make_nested(limit, obj);
+            char *over = make_nested(limit + 1, obj);
+            CHECK(at && over);
+
+            for (size_t p = 0; at && over && p < sizeof(parsers) / sizeof(*parsers); ++p) {
+                test_check(__FILE__, __LINE__, parsers[p](at, max_depths[m]) == JEST_ERROR_NONE, names[p]);
+                test_check(__FILE__, __LINE__, parsers[p](over, max_depths[m]) == JEST_ERROR_DEPTH, names[p]);
+            }
+
+            free(at);
+            free(over);
+        }
+    }
+
+    // scalars don't count as a level, and siblings don't add up
+    for (size_t p = 0; p < sizeof(parsers) / sizeof(*parsers); ++p) {
+        test_check(__FILE__, __LINE__, parsers[p]("7", 1) == JEST_ERROR_NONE, names[p]);
+        test_check(__FILE__, __LINE__, parsers[p]("[[1], [2], {a: 3}]", 2) == JEST_ERROR_NONE, names[p]);
+        test_check(__FILE__, __LINE__, parsers[p]("[[1], [[2]]]", 2) == JEST_ERROR_DEPTH, names[p]);
+    }
+
+    // the ordinary entry points use the default
+    char *over = make_nested(JEST_MAX_DEPTH + 1, false);
+    if (over) {
+        Jest_JsonVal val;
+        CHECK(Jest_parseJsonFromStr(&val, over) == JEST_ERROR_DEPTH);
+
+        Jest_Document doc;
+        Jest_initDocument(&doc);
+        CHECK(Jest_parseDocumentFromBuf(&doc, over, strlen(over)) == JEST_ERROR_DEPTH);
+        Jest_destroyDocument(&doc);
+        free(over);
+    }
+}
+
+static void deep(void)
+{
+    // far past the default with the limit raised, parsing, writing and destroying don't recurse
+    const size_t depth = 1000000;
+    for (int obj = 0; obj < 2; ++obj) {
+        char *src = make_nested(depth, obj);
+        CHECK(src != NULL);
+        if (!src) continue;
+
+        Jest_Lexer l;
+        CHECK(Jest_initLexer(&l, NULL, 0, src, strlen(src)));
+        l.max_depth = depth;
+
+        Jest_JsonVal val;
+        CHECK(Jest_parseJsonLexer(&val, &l) == JEST_ERROR_NONE);
+        Jest_destroyLexer(&l);
+
+        char *out = test_write(&val);
+        CHECK(out && !strcmp(out, src));
+        free(out);
+
+        Jest_destroyJsonVal(&val);
+        free(src);
+    }
+}
+
+void test_depth(void)
+{
+    limits();
+    deep();
+}
@@ -0,0 +1,105 @@
+// formatting doubles, which has to round-trip and follow javascript's layout
+#include "test.h"
+
+static void check_format(const char *file, int line, double x, const char *expected)
+{
+    char buf[32];
+    test_check_str(file, line, Jest_dblToStr(buf, sizeof(buf), x), expected);
+}
+
+#define CHECK_FORMAT(x, expected) check_format(__FILE__, __LINE__, (x), (expected))
+
+static void layout(void)
+{
+    // plain integers up to 21 digits, exponents from there on
+    CHECK_FORMAT(1e20, "100000000000000000000");
+    CHECK_FORMAT(123456789012345680000.0, "123456789012345680000");
+    CHECK_FORMAT(999999999999999900000.0, "999999999999999900000");
+    CHECK_FORMAT(1e21, "1e+21");
+    CHECK_FORMAT(1.5e21, "1.5e+21");
+    CHECK_FORMAT(-1e21, "-1e+21");
+    CHECK_FORMAT(1.7976931348623157e308, "1.7976931348623157e+308");
+
+    // leading zeros down to 1e-6, exponents below
+    CHECK_FORMAT(1e-6, "0.000001");
+    CHECK_FORMAT(1.25e-6, "0.00000125");
+    CHECK_FORMAT(1e-7, "1e-7");
+    CHECK_FORMAT(1.5e-7, "1.5e-7");
+    CHECK_FORMAT(-9.99e-8, "-9.99e-8");
+    CHECK_FORMAT(5e-324, "5e-324");
+    CHECK_FORMAT(2.2250738585072014e-308, "2.2250738585072014e-308");
+
+    // in between
+    CHECK_FORMAT(0.0, "0");
+    CHECK_FORMAT(-0.0, "-0");
+    CHECK_FORMAT(1.0, "1");
+    CHECK_FORMAT(100.0, "100");
+    CHECK_FORMAT(0.1, "0.1");
+    CHECK_FORMAT(0.3, "0.3");
+    CHECK_FORMAT(0.1 + 0.2, "0.30000000000000004");
+    CHECK_FORMAT(1.0 / 3.0, "0.3333333333333333");
+    CHECK_FORMAT(123.456, "123.456");
+    CHECK_FORMAT(-42.5, "-42.5");
+    CHECK_FORMAT(9007199254740993.0, "9007199254740992");
+
+    CHECK_FORMAT(JEST_INF, "Infinity");
+    CHECK_FORMAT(-JEST_INF, "-Infinity");
+    CHECK_FORMAT(JEST_NAN, "NaN");
+
+    // too small a buffer is refused
+    char small[8];
+    CHECK(Jest_dblToStr(small, sizeof(small), 1.0) == NULL);
+
+    // the writer uses the same layout
+    CHECK_JSON("[1e21, 1e20, 1e-7, 0.000001, -0]", "[1e+21,100000000000000000000,1e-7,0.000001,-0]");
+}
+
+static void random_round_trips(void)
+{
+    uint64_t state = UINT64_C(0x2545f4914f6cdd1d);
+    char buf[32];
+    int failures = 0;
+
+    for (int i = 0; i < 100000; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        double x;
+        if (i & 1) {
+            memcpy(&x, &state, sizeof(x));
+            if (Jest_isnan(x) || Jest_isinf(x)) continue;
+        } else {
+            // around the layout thresholds
+            x = (double)(state >> 11) / (double)(UINT64_C(1) << 53) * ((i & 2)? 1e22 : 1e-5);
+        }
+
+        Jest_dblToStr(buf, sizeof(buf), x);
+
+        // every character has to be used and at most 17 significant digits are ever needed
+        char *end;
+        const double back = strtod(buf, &end);
+        int ndigits = 0;
+        bool leading = true;
+        for (const char *c = buf; *c && *c != 'e'; ++c) {
+            if (*c >= '1' && *c <= '9') leading = false;
+            if (!leading && *c >= '0' && *c <= '9') ++ndigits;
+        }
+
+        const bool exp_layout = strchr(buf, 'e') != NULL;
+        const double mag = (x < 0)? -x : x;
+        const bool ok = *end == '\0' && !memcmp(&back, &x, sizeof(x))
+            && (ndigits <= 17 || (!exp_layout && mag >= 1e17))
+            && exp_layout == (mag != 0 && (mag >= 1e21 || mag < 1e-6));
+
+        if (!ok && ++failures <= 5) fprintf(stderr, "    %.17g formatted as %s\n", x, buf);
+    }
+
+    CHECK(failures == 0);
+}
+
+void test_doubles(void)
+{
+    layout();
+    random_round_trips();
+}
@@ -0,0 +1,249 @@
+// parsing from paths, which reads small files and maps large ones, has to match parsing the same bytes from memory
+#include "test.h"
+
+// a pipe whose reader is interrupted by a signal, which needs threads and posix
+#if !defined(JEST_NO_MMAP) && defined(__unix__) && defined(_POSIX_C_SOURCE)
+#   define TEST_FIFO 1
+#   include <pthread.h>
+#   include <signal.h>
+#   include <sys/stat.h>
+#   include <time.h>
+#endif
+
+// an array of len bytes with some of everything in it
+static char *make_doc(size_t len)
+{
+    char *doc = (char *)malloc(len + 1);
+    if (!doc) return NULL;
+
+    size_t n = 0;
+    doc[n++] = '[';
+    for (int i = 0; n + 64 < len; ++i) {
+        n += (size_t)snprintf(&doc[n], len + 1 - n, "{\"i\": %d, s: 'x\\ty', f: %g, b: [true, null]}, ", i, i * 0.25);
+    }
+
+    while (n < len - 2) doc[n++] = ' ';
+    doc[n++] = '0';
+    doc[n++] = ']';
+    doc[n] = '\0';
+    return doc;
+}
+
+// a lone number padded with whitespace in front to len bytes, so the input ends right where the number does
+static char *make_num(size_t len)
+{
+    char *doc = (char *)malloc(len + 1);
+    if (!doc) return NULL;
+
+    memset(doc, ' ', len);
+    memcpy(&doc[len - 6], "-12e-3", 6);
+    doc[len] = '\0';
+    return doc;
+}
+
+static void check_path(const char *file, int line, const char *src, size_t len)
+{
+    Jest_JsonVal expected;
+    const Jest_Error expected_err = Jest_parseJsonFromBuf(&expected, src, len);
+    char *expected_text = (expected_err)? NULL : test_write(&expected);
+    if (!expected_err) Jest_destroyJsonVal(&expected);
+
+    const char *path = test_scratch_file(src, len);
+    test_check(file, line, path != NULL, "scratch file");
+    if (!path) return;
+
+    Jest_JsonVal val;
+    const Jest_Error err = Jest_parseJsonFileFromPath(&val, path);
+    test_check(file, line, err == expected_err, "error of Jest_parseJsonFileFromPath");
+    if (!err) {
+        char *text = test_write(&val);
+        test_check(file, line, text && expected_text && !strcmp(text, expected_text), "value of Jest_parseJsonFileFromPath");
+        free(text);
+        Jest_destroyJsonVal(&val);
+    }
+
+    // the same through a document, which holds on to the file when its strings point into it
+    for (unsigned flags = 0; flags <= JEST_DOC_ZEROCOPY; ++flags) {
+        Jest_Document doc;
+        Jest_initDocument(&doc);
+        doc.flags = flags;
+
+        test_check(file, line, Jest_parseDocumentFromPath(&doc, path) == expected_err, "error of Jest_parseDocumentFromPath");
+        if (!expected_err) {
+            char *text = test_write(&doc.root);
+            test_check(file, line, text && expected_text && !strcmp(text, expected_text), "value of Jest_parseDocumentFromPath");
+            free(text);
+        }
+
+#ifdef JEST__MMAP
+        const bool mapped = flags && len >= JEST_MMAP_THRESHOLD;
+        test_check(file, line, (doc.source_mapped != 0) == mapped && (!mapped || doc.source_mapped == len), "source_mapped");
+#endif // JEST__MMAP
+
+        Jest_destroyDocument(&doc);
+    }
+
+    free(expected_text);
+}
+
+#define CHECK_PATH(src, len) check_path(__FILE__, __LINE__, (src), (len))
+
+static void sizes(void)
+{
+    // both sides of the threshold and of a page, with a number running up to the very last byte
+    static const size_t lens[] = {
+        7, 4095, 4096, 4097, JEST_MMAP_THRESHOLD - 1, JEST_MMAP_THRESHOLD, JEST_MMAP_THRESHOLD + 1,
+        JEST_MMAP_THRESHOLD + 4096, 4 * JEST_MMAP_THRESHOLD + 123
+    };
+
+    for (size_t i = 0; i < sizeof(lens) / sizeof(*lens); ++i) {
+        char *doc = make_doc(lens[i] + 64);
+        char *num = make_num(lens[i]);
+        CHECK(doc && num);
+
+        if (doc) CHECK_PATH(doc, lens[i] + 64);
+        if (num) CHECK_PATH(num, lens[i]);
+
+        free(doc);
+        free(num);
+    }
+
+    // rejected input is rejected the same way
+    char *broken = make_doc(2 * JEST_MMAP_THRESHOLD);
+    if (broken) {
+        broken[2 * JEST_MMAP_THRESHOLD - 1] = ',';
+        CHECK_PATH(broken, 2 * JEST_MMAP_THRESHOLD);
+        free(broken);
+    }
+}
+
+static void sax_path(void)
+{
+    char *doc = make_doc(JEST_MMAP_THRESHOLD + 100);
+    CHECK(doc != NULL);
+    if (!doc) return;
+
+    // events of the mapped file against those of the lexer over the same bytes
+    TestEvents expected, ev;
+    test_events_init(&expected, 0);
+    test_events_init(&ev, 0);
+
+    Jest_Lexer l;
+    CHECK(Jest_initLexer(&l, NULL, 0, doc, JEST_MMAP_THRESHOLD + 100));
+    CHECK(Jest_parseSaxLexer(&l, &test_events_handler, &expected) == JEST_ERROR_NONE);
+    Jest_destroyLexer(&l);
+
+    const char *path = test_scratch_file(doc, JEST_MMAP_THRESHOLD + 100);
+    CHECK(path && Jest_parseSaxFromPath(path, &test_events_handler, &ev) == JEST_ERROR_NONE);
+    CHECK(expected.count > 1000 && ev.count == expected.count);
+    CHECK_STR(test_events_text(&ev), test_events_text(&expected));
+
+    test_events_destroy(&expected);
+    test_events_destroy(&ev);
+    free(doc);
+}
+
+static void failures(void)
+{
+    Jest_JsonVal val;
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+
+    // missing files and empty ones can't be read
+    CHECK(Jest_parseJsonFileFromPath(&val, "tests.missing.json") == JEST_ERROR_IO);
+    CHECK(Jest_parseDocumentFromPath(&doc, "tests.missing.json") == JEST_ERROR_IO);
+    CHECK(Jest_parseSaxFromPath("tests.missing.json", &test_events_handler, NULL) == JEST_ERROR_IO);
+
+    const char *path = test_scratch_file("", 0);
+    CHECK(path && Jest_parseJsonFileFromPath(&val, path) == JEST_ERROR_IO);
+    CHECK(path && Jest_parseDocumentFromPath(&doc, path) == JEST_ERROR_IO);
+
+    CHECK(Jest_parseJsonFileFromPath(&val, NULL) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_parseDocumentFromPath(NULL, "tests.missing.json") == JEST_ERROR_BADPARAM);
+    Jest_destroyDocument(&doc);
+
+    // reading a whole file gives back exactly what was written
+    char *data = NULL;
+    path = test_scratch_file("[1, 2]", 6);
+    CHECK(path && Jest_readEntireFileFromPath(&data, path) == 6);
+    CHECK(data && !memcmp(data, "[1, 2]", 6));
+    free(data);
+}
+
+#ifdef TEST_FIFO
+
+static const char fifo_path[] = "tests.fifo";
+
+typedef struct FifoWriter {
+    pthread_t reader;
+    bool ok;
+} FifoWriter;
+
+static void ignore_signal(int sig)
+{
+    (void)sig;
+}
+
+static void *write_fifo(void *userdata)
+{
+    FifoWriter *w = (FifoWriter *)userdata;
+    const struct timespec pause = {0, 50 * 1000 * 1000};
+
+    // the reader is left waiting on the rest of the input when the signal comes in
+    FILE *f = fopen(fifo_path, "w");
+    if (!f) return NULL;
+
+    w->ok = fputs("[1, 2, ", f) >= 0 && !fflush(f);
+    nanosleep(&pause, NULL);
+    pthread_kill(w->reader, SIGUSR1);
+    nanosleep(&pause, NULL);
+    w->ok = fputs("3]", f) >= 0 && w->ok;
+
+    fclose(f);
+    return NULL;
+}
+
+static void interrupted(void)
+{
+    remove(fifo_path);
+    CHECK(mkfifo(fifo_path, 0600) == 0);
+
+    // without SA_RESTART the read the signal lands on fails with EINTR, which is no reason to give up on the file
+    struct sigaction sa, old, old_pipe;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = ignore_signal;
+    sigemptyset(&sa.sa_mask);
+    CHECK(sigaction(SIGUSR1, &sa, &old) == 0);
+
+    // and a reader that gave up anyway mustn't take the tests down with it
+    sa.sa_handler = SIG_IGN;
+    CHECK(sigaction(SIGPIPE, &sa, &old_pipe) == 0);
+
+    FifoWriter w = {pthread_self(), false};
+    pthread_t writer;
+    if (!pthread_create(&writer, NULL, write_fifo, &w)) {
+        Jest_Document doc;
+        Jest_initDocument(&doc);
+        CHECK(Jest_parseDocumentFromPath(&doc, fifo_path) == JEST_ERROR_NONE);
+        pthread_join(writer, NULL);
+
+        CHECK(w.ok && doc.root.type == JEST_JSONTYPE_ARR && doc.root.v.as_arr.len == 3);
+        Jest_destroyDocument(&doc);
+    }
+
+    sigaction(SIGUSR1, &old, NULL);
+    sigaction(SIGPIPE, &old_pipe, NULL);
+    remove(fifo_path);
+}
+
+#endif // TEST_FIFO
+
+void test_files(void)
+{
+    sizes();
+    sax_path();
+    failures();
+#ifdef TEST_FIFO
+    interrupted();
+#endif // TEST_FIFO
+}
@@ -0,0 +1,150 @@
+// buffer and in-situ parsing, which have to give the same trees as parsing a nul-terminated copy
+#include "test.h"
+
+#include <stdint.h>
+
+static const char *const documents[] = {
+    "{\"a\": [1, 2.5, \"s\\u00e9\\ud83d\\ude00\"], \"esc\\\"key\\\"\": 'it\\'s', id: \"x\\ty\\\\z\"}",
+    "[\"\\u0041\\x42\\n\", 'line\\\n  continued', \"\", \"plain\", \"\\/\\b\\f\\r\"]",
+    "  /* lead */ {a: {b: {c: [\"deep \\\"quoted\\\"\"]}}} // trail",
+    "\"just a \\\"string\\\"\"",
+    "[true, null, -Infinity, 0x1F, .5]",
+    "{a: 1, a: 'last'}",
+    "[1, {a: 'unterminated}]"
+};
+
+static bool within(const char *str, const char *buf, size_t len)
+{
+    return (uintptr_t)str >= (uintptr_t)buf && (uintptr_t)str <= (uintptr_t)buf + len;
+}
+
+// strings and field names that point into buf, or all of them without buf, with names only when asked
+static size_t strings_in(const Jest_JsonVal *val, const char *buf, size_t len, bool names)
+{
+    size_t n = 0;
+    switch (val->type) {
+    case JEST_JSONTYPE_STR:
+        return !buf || within(val->v.as_str.data, buf, len);
+    case JEST_JSONTYPE_ARR:
+        for (size_t i = 0; i < val->v.as_arr.len; ++i) n += strings_in(&val->v.as_arr.elems[i], buf, len, names);
+        return n;
+    case JEST_JSONTYPE_OBJ:
+        for (size_t i = 0; i < val->v.as_obj.nfields; ++i) {
+            if (names) n += !buf || within(val->v.as_obj.field_names[i], buf, len);
+            n += strings_in(&val->v.as_obj.field_values[i], buf, len, names);
+        }
+        return n;
+    default:
+        return 0;
+    }
+}
+
+static void against_copies(void)
+{
+    for (size_t d = 0; d < sizeof(documents) / sizeof(*documents); ++d) {
+        const char *src = documents[d];
+        const size_t len = strlen(src);
+
+        Jest_JsonVal val;
+        const Jest_Error expected_err = Jest_parseJsonFromStr(&val, src);
+        char *expected = (expected_err)? NULL : test_write(&val);
+        if (!expected_err) Jest_destroyJsonVal(&val);
+
+        for (unsigned flags = 0; flags <= JEST_DOC_INTERN; flags += JEST_DOC_INTERN) {
+            char *buf = (char *)malloc(len);
+            CHECK(buf != NULL);
+            if (!buf) continue;
+
+            memcpy(buf, src, len);
+            Jest_Document doc;
+            Jest_initDocument(&doc);
+            doc.flags = flags;
+
+            // every string is decoded where it was in buf, which needs no nul at the end
+            const Jest_Error err = Jest_parseDocumentInSitu(&doc, buf, len);
+            test_check(__FILE__, __LINE__, err == expected_err, src);
+            if (!err) {
+                char *got = test_write(&doc.root);
+                CHECK_STR(got, expected);
+                free(got);
+                const bool names = !(flags & JEST_DOC_INTERN);
+                CHECK(strings_in(&doc.root, buf, len, names) == strings_in(&doc.root, NULL, 0, names));
+            }
+
+            Jest_destroyDocument(&doc);
+            free(buf);
+        }
+
+        // the same through a parser, again and again into the same buffer
+        Jest_Parser p;
+        Jest_initParser(&p);
+        char *buf = (char *)malloc(len);
+        for (int i = 0; buf && i < 3; ++i) {
+            memcpy(buf, src, len);
+            const Jest_Error err = Jest_parserParseInSitu(&p, buf, len);
+            test_check(__FILE__, __LINE__, err == expected_err, src);
+            if (!err) {
+                char *got = test_write(&p.doc.root);
+                CHECK_STR(got, expected);
+                free(got);
+                CHECK(strings_in(&p.doc.root, buf, len, true) == strings_in(&p.doc.root, NULL, 0, true));
+            }
+        }
+
+        // and an ordinary parse afterwards copies its strings again
+        if (!expected_err && Jest_parserParse(&p, src, len) == JEST_ERROR_NONE) {
+            CHECK(p.doc.flags == 0 && strings_in(&p.doc.root, src, len, true) == 0);
+        }
+
+        free(buf);
+        Jest_destroyParser(&p);
+        free(expected);
+    }
+}
+
+static void buffers(void)
+{
+    // input ends at len whatever comes after it
+    Jest_JsonVal val;
+    CHECK(Jest_parseJsonFromBuf(&val, "12345", 3) == JEST_ERROR_NONE);
+    CHECK(val.type == JEST_JSONTYPE_NUM && val.v.as_num == 123);
+
+    CHECK(Jest_parseJsonFromBuf(&val, "[1, 2]garbage", 6) == JEST_ERROR_NONE);
+    char *out = test_write(&val);
+    CHECK_STR(out, "[1,2]");
+    free(out);
+    Jest_destroyJsonVal(&val);
+
+    CHECK(Jest_parseJsonFromBuf(&val, "\"abc\"", 4) != JEST_ERROR_NONE);
+    CHECK(Jest_parseJsonFromBuf(&val, "[true]", 4) != JEST_ERROR_NONE);
+    CHECK(Jest_parseJsonFromBuf(&val, "tru", 3) != JEST_ERROR_NONE);
+    CHECK(Jest_parseJsonFromBuf(NULL, "1", 1) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_parseJsonFromStr(&val, NULL) == JEST_ERROR_BADPARAM);
+
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+    char bad[] = "1";
+    CHECK(Jest_parseDocumentInSitu(&doc, bad, 0) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_parseDocumentInSitu(&doc, NULL, 1) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_parseDocumentFromBuf(&doc, "{a: 1} ", 6) == JEST_ERROR_NONE);
+    CHECK(doc.root.type == JEST_JSONTYPE_OBJ && doc.root.v.as_obj.nfields == 1);
+    Jest_destroyDocument(&doc);
+
+    // zero-copy only holds for the in-situ parse, the next one into the same document copies its strings
+    char insitu[] = "{name: \"in situ\", list: ['a', 'b']}";
+    const char copied[] = "{name: \"copied\", list: ['c', 'd']}";
+    CHECK(Jest_parseDocumentInSitu(&doc, insitu, sizeof(insitu) - 1) == JEST_ERROR_NONE);
+    CHECK(doc.flags == 0 && strings_in(&doc.root, insitu, sizeof(insitu) - 1, false) == 3);
+    Jest_destroyDocument(&doc);
+
+    CHECK(Jest_parseDocumentFromBuf(&doc, copied, sizeof(copied) - 1) == JEST_ERROR_NONE);
+    CHECK(doc.flags == 0 && strings_in(&doc.root, NULL, 0, true) == 5);
+    CHECK(strings_in(&doc.root, copied, sizeof(copied) - 1, true) == 0);
+    Jest_destroyDocument(&doc);
+}
+
+void test_insitu(void)
+{
+    against_copies();
+    buffers();
+}
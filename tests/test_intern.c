@@ -0,0 +1,144 @@
+// interned field names, where equal names share one copy and different ones never do
+#include "test.h"
+
+static Jest_Error parse_doc(Jest_Document *doc, unsigned flags, const char *src)
+{
+    Jest_initDocument(doc);
+    doc->flags = flags;
+    return Jest_parseDocumentFromBuf(doc, src, strlen(src));
+}
+
+static void shared(void)
+{
+    // the same names spelt differently are still the same name, and a nul makes a different one
+    const char src[] = "[{a: 1, \"b\": 2, \"\\u0061\\u0000\": 3}, {\"\\u0062\": 4, 'a': 5, \"a\\u0000\": 6, c: 7}]";
+    static const unsigned flags[] = {JEST_DOC_INTERN, JEST_DOC_INTERN | JEST_DOC_ZEROCOPY};
+
+    for (size_t f = 0; f < sizeof(flags) / sizeof(*flags); ++f) {
+        Jest_Document doc;
+        CHECK(parse_doc(&doc, flags[f], src) == JEST_ERROR_NONE);
+
+        const Jest_JsonVal *r0 = &doc.root.v.as_arr.elems[0], *r1 = &doc.root.v.as_arr.elems[1];
+        char *const *n0 = r0->v.as_obj.field_names, *const *n1 = r1->v.as_obj.field_names;
+        CHECK(r0->v.as_obj.nfields == 3 && r1->v.as_obj.nfields == 4);
+
+        CHECK(n0[0] == n1[1] && !strcmp(n0[0], "a"));
+        CHECK(n0[1] == n1[0] && !strcmp(n0[1], "b"));
+        CHECK(n0[2] == n1[2] && r0->v.as_obj.fn_lens[2] == 2);
+        CHECK(n0[0] != n0[2] && n0[0] != n1[3]);
+
+        // the zero-copy flag doesn't make names point into the input
+        CHECK(n0[0] != &src[2] && n0[0] != &src[51]);
+
+        // names added later join the ones that were parsed
+        Jest_JsonVal obj = Jest_jsonObj();
+        obj.flags = JEST_JSONFLAG_ARENA;
+        CHECK(Jest_docObjAdd(&doc, &obj, "c", Jest_jsonNumber(8)) == JEST_ERROR_NONE);
+        CHECK(Jest_docObjAdd(&doc, &obj, "new", Jest_jsonNumber(9)) == JEST_ERROR_NONE);
+        CHECK(obj.v.as_obj.field_names[0] == n1[3]);
+        CHECK(Jest_docObjAdd(&doc, &obj, "new", Jest_jsonNumber(10)) == JEST_ERROR_NONE);
+        CHECK(obj.v.as_obj.nfields == 2 && obj.v.as_obj.field_values[1].v.as_num == 10);
+
+        Jest_destroyDocument(&doc);
+    }
+
+    // without the flag every name is a copy of its own
+    Jest_Document doc;
+    CHECK(parse_doc(&doc, 0, src) == JEST_ERROR_NONE);
+    CHECK(doc.root.v.as_arr.elems[0].v.as_obj.field_names[0] != doc.root.v.as_arr.elems[1].v.as_obj.field_names[1]);
+    CHECK(doc.intern == NULL);
+    Jest_destroyDocument(&doc);
+
+    // json lines always intern
+    Jest_JsonLines lines;
+    CHECK(Jest_parseJsonLines(&lines, "{a: 1}\n{\"a\": 2}", 15, 1) == JEST_ERROR_NONE);
+    CHECK(lines.count == 2 && lines.values[0].v.as_obj.field_names[0] == lines.values[1].v.as_obj.field_names[0]);
+    Jest_destroyJsonLines(&lines);
+}
+
+static void many(void)
+{
+    // rows over enough distinct names that the table grows many times, with wide objects among them
+    const int nkeys = 5000, nrows = 4;
+    char *src = (char *)malloc((size_t)nrows * (size_t)nkeys * 16 + 16);
+    CHECK(src != NULL);
+    if (!src) return;
+
+    size_t n = 0;
+    src[n++] = '[';
+    for (int r = 0; r < nrows; ++r) {
+        src[n++] = '{';
+        for (int k = 0; k < nkeys; ++k) n += (size_t)sprintf(&src[n], "k%d: %d,", (k * 7 + r) % nkeys, r);
+        src[n++] = '}';
+        src[n++] = ',';
+    }
+    src[n++] = ']';
+    src[n] = '\0';
+
+    Jest_Document interned, plain;
+    CHECK(parse_doc(&interned, JEST_DOC_INTERN, src) == JEST_ERROR_NONE);
+    CHECK(parse_doc(&plain, 0, src) == JEST_ERROR_NONE);
+
+    // the same tree either way
+    char *a = test_write(&interned.root), *b = test_write(&plain.root);
+    CHECK(a && b && !strcmp(a, b));
+    free(a);
+    free(b);
+
+    // and every name of every row is the one copy that the first row has
+    const Jest_JsonVal *rows = interned.root.v.as_arr.elems;
+    size_t mismatches = 0;
+    char name[16];
+    for (int k = 0; k < nkeys; ++k) {
+        sprintf(name, "k%d", k);
+        const char *first = NULL;
+        for (int r = 0; r < nrows; ++r) {
+            const Jest_JsonVal *row = &rows[r];
+            const char *found = NULL;
+            for (size_t f = 0; f < row->v.as_obj.nfields && !found; ++f) {
+                if (!strcmp(row->v.as_obj.field_names[f], name)) found = row->v.as_obj.field_names[f];
+            }
+
+            if (!found || (first && found != first)) ++mismatches;
+            if (!first) first = found;
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // lookups go through the hash index of the wide rows just the same
+    char accessor[32];
+    sprintf(accessor, "[%d][k%d]", nrows - 1, nkeys - 1);
+    const Jest_JsonVal *last = Jest_jsonIdx(&interned.root, accessor, NULL);
+    CHECK(last && last->type == JEST_JSONTYPE_NUM && last->v.as_num == nrows - 1);
+
+    Jest_destroyDocument(&interned);
+    Jest_destroyDocument(&plain);
+    free(src);
+}
+
+static void reused(void)
+{
+    // a parser drops its names with everything else and interns afresh every time
+    Jest_Parser p;
+    Jest_initParser(&p);
+    p.doc.flags = JEST_DOC_INTERN;
+
+    static const char *const srcs[] = {"[{x: 1, y: 2}, {y: 3, x: 4}]", "[{y: 5}, {z: 6, y: 7}]"};
+    for (size_t i = 0; i < 4; ++i) {
+        const char *src = srcs[i % 2];
+        CHECK(Jest_parserParse(&p, src, strlen(src)) == JEST_ERROR_NONE);
+
+        const Jest_JsonVal *r0 = &p.doc.root.v.as_arr.elems[0], *r1 = &p.doc.root.v.as_arr.elems[1];
+        CHECK(r0->v.as_obj.field_names[0] == r1->v.as_obj.field_names[1]);
+        CHECK(!strcmp(r1->v.as_obj.field_names[1], (i % 2)? "y" : "x"));
+    }
+
+    Jest_destroyParser(&p);
+}
+
+void test_intern(void)
+{
+    shared();
+    many();
+    reused();
+}
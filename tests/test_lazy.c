@@ -0,0 +1,103 @@
+// lazy values, looked up in the raw input without building a tree
+#include "test.h"
+
+static const char *const documents[] = {
+    "{\"a\": [1, {\"b\": \"x\", \"c\": [true, null]}], \"d\": {\"e\": -2.5}, f: 'str'}",
+    "  /* lead */ {a: [\"]}\", '[{', {b: \"\\\"}\"}], // skipped ] }\n d: {e: [[[], {}], 7]}}",
+    "{\"esc\\u0041\": 1, \"a\": {\"b\": 2}, \"a\": [3, {\"b\": 4}], d: 5, d: {e: 6}, f: 7, f: null}",
+    "{a: {b: 1}, a: {c: 2}, d: [{e: 3}, {e: 4}], f: 8,}",
+    "[1, {a: [2]}, 3]",
+    "\"scalar\"",
+    "42"
+};
+
+static const char *const accessors[] = {
+    "[a]", "[a][0]", "[a][1]", "[a][1][b]", "[a][1][c][1]", "[a][b]", "[a][c]", "[d][e]", "[d][e][0][1]", "[d][1][e]",
+    "[f]", "[escA]", "[missing]", "[0]", "[1][a][0]", "[2]", "[3]"
+};
+
+// looking up lazily has to agree with looking up in the parsed tree
+static void against_tree(void)
+{
+    for (size_t d = 0; d < sizeof(documents) / sizeof(*documents); ++d) {
+        const char *src = documents[d];
+
+        Jest_JsonVal root;
+        CHECK(Jest_parseJsonFromStr(&root, src) == JEST_ERROR_NONE);
+
+        Jest_LazyVal lazy_root;
+        CHECK(Jest_lazyRoot(&lazy_root, src, strlen(src)) == JEST_ERROR_NONE);
+        CHECK(lazy_root.type == root.type);
+
+        for (size_t a = 0; a < sizeof(accessors) / sizeof(*accessors); ++a) {
+            Jest_JsonVal *expected = (root.type == JEST_JSONTYPE_OBJ || root.type == JEST_JSONTYPE_ARR)
+                ? Jest_jsonIdx(&root, accessors[a], NULL) : NULL;
+
+            Jest_Path path;
+            CHECK(Jest_compilePath(&path, accessors[a]) == JEST_ERROR_NONE);
+
+            Jest_LazyVal found;
+            const Jest_Error err = Jest_lazyPath(&found, &lazy_root, &path);
+            Jest_destroyPath(&path);
+
+            test_check(__FILE__, __LINE__, (err == JEST_ERROR_NONE) == (expected != NULL), accessors[a]);
+            if (err || !expected) continue;
+
+            Jest_JsonVal decoded;
+            CHECK(found.type == expected->type);
+            CHECK(Jest_lazyDecode(&decoded, &found) == JEST_ERROR_NONE);
+
+            char *want = test_write(expected);
+            char *got = test_write(&decoded);
+            CHECK_STR(got, want);
+            free(want);
+            free(got);
+            Jest_destroyJsonVal(&decoded);
+        }
+
+        Jest_destroyJsonVal(&root);
+    }
+}
+
+static void fields_and_elements(void)
+{
+    const char src[] = "{a: 1, \"a\": {x: 'first'}, b: [10, [20, 21], 30], a: {x: 'last'}}";
+    Jest_LazyVal root, val, inner;
+    CHECK(Jest_lazyRoot(&root, src, sizeof(src) - 1) == JEST_ERROR_NONE);
+
+    // the last of duplicate keys wins, and the range of a container runs over its brackets
+    CHECK(Jest_lazyField(&val, &root, "a") == JEST_ERROR_NONE);
+    CHECK(val.type == JEST_JSONTYPE_OBJ && val.src == src);
+    CHECK(val.end - val.start == 11 && !memcmp(&val.src[val.start], "{x: 'last'}", 11));
+    CHECK(Jest_lazyField(&inner, &val, "x") == JEST_ERROR_NONE);
+    CHECK(inner.type == JEST_JSONTYPE_STR && !memcmp(&inner.src[inner.start], "'last'", 6));
+
+    CHECK(Jest_lazyField(&val, &root, "b") == JEST_ERROR_NONE);
+    CHECK(Jest_lazyIdx(&inner, &val, 1) == JEST_ERROR_NONE);
+    CHECK(inner.type == JEST_JSONTYPE_ARR && inner.end - inner.start == 8);
+    CHECK(Jest_lazyIdx(&inner, &val, 2) == JEST_ERROR_NONE && inner.type == JEST_JSONTYPE_NUM);
+    CHECK(Jest_lazyIdx(&inner, &val, 3) == JEST_ERROR_BADPARAM);
+
+    // keys only go on objects and indices only on arrays
+    CHECK(Jest_lazyField(&inner, &val, "a") == JEST_ERROR_BADPARAM);
+    CHECK(Jest_lazyIdx(&inner, &root, 0) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_lazyField(&inner, &root, "c") == JEST_ERROR_BADPARAM);
+    CHECK(Jest_lazyField(NULL, &root, "a") == JEST_ERROR_BADPARAM);
+    CHECK(Jest_lazyRoot(&root, src, 0) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_lazyRoot(&root, "   ", 3) == JEST_ERROR_SYNTAX);
+
+    // broken input shows up once a lookup walks over it, even after the field was found
+    const char broken[] = "{a: 1, b: [1, 2 c: 3}";
+    CHECK(Jest_lazyRoot(&root, broken, sizeof(broken) - 1) == JEST_ERROR_NONE);
+    CHECK(Jest_lazyField(&val, &root, "a") != JEST_ERROR_NONE);
+
+    const char unclosed[] = "{a: 1, b: {c: 2}";
+    CHECK(Jest_lazyRoot(&root, unclosed, sizeof(unclosed) - 1) == JEST_ERROR_NONE);
+    CHECK(Jest_lazyField(&val, &root, "a") == JEST_ERROR_SYNTAX);
+}
+
+void test_lazy(void)
+{
+    against_tree();
+    fields_and_elements();
+}
@@ -0,0 +1,126 @@
+// the lexer on every byte value, which it has to classify the same way whatever the locale, and its keywords
+#include "test.h"
+
+#include <locale.h>
+
+static bool is_space(unsigned c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool is_ident(unsigned c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+// the lexeme type the lexer starts on for the len bytes at buf, JEST_LEXEME_ERR when it can't
+static Jest_LexemeType first_lexeme(const char *buf, size_t len)
+{
+    Jest_Lexer l;
+    const bool ok = Jest_initLexer(&l, NULL, 0, buf, len);
+    const Jest_LexemeType type = (ok)? l.type : JEST_LEXEME_ERR;
+    Jest_destroyLexer(&l);
+    return type;
+}
+
+static size_t class_mismatches(void)
+{
+    size_t mismatches = 0;
+    for (unsigned c = 0; c < 256; ++c) {
+        const char byte = (char)c;
+
+        // what a token can start with
+        Jest_LexemeType expected = JEST_LEXEME_ERR; // whitespace alone is no token either
+        if (strchr("{}[]:,", byte) && c) expected = (Jest_LexemeType)c;
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$') expected = JEST_LEXEME_IDENT;
+        else if (c >= '0' && c <= '9') expected = JEST_LEXEME_NUM;
+        if (first_lexeme(&byte, 1) != expected) ++mismatches;
+
+        char num[2] = {byte, '1'};
+        const bool starts_num = (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || is_space(c);
+        if ((first_lexeme(num, 2) == JEST_LEXEME_NUM) != starts_num) ++mismatches;
+
+        // what may follow a keyword, and what carries on an identifier used as a key
+        char arr[] = "[true ]", obj[] = "{a : 1}";
+        arr[5] = byte;
+        obj[2] = byte;
+
+        Jest_JsonVal val;
+        const bool ends_keyword = is_space(c) || c == ',' || c == ']';
+        if ((Jest_parseJsonFromBuf(&val, arr, 7) == JEST_ERROR_NONE) != ends_keyword) ++mismatches;
+        else if (ends_keyword) Jest_destroyJsonVal(&val);
+
+        const bool key = is_ident(c) || is_space(c);
+        if ((Jest_parseJsonFromBuf(&val, obj, 7) == JEST_ERROR_NONE) != key) ++mismatches;
+        else if (key) {
+            const size_t key_len = (is_ident(c))? 2 : 1;
+            if (val.v.as_obj.fn_lens[0] != key_len || val.v.as_obj.field_names[0][1] != ((key_len == 2)? byte : '\0')) ++mismatches;
+            Jest_destroyJsonVal(&val);
+        }
+    }
+
+    return mismatches;
+}
+
+static void classes(void)
+{
+    CHECK(class_mismatches() == 0);
+
+    // bytes past ascii are nothing outside strings and kept as they are inside them
+    CHECK_JSON("[\"\xc3\xa9\xff\x80\"]", "[\"\xc3\xa9\xff\x80\"]");
+    CHECK_JSON("{\"\xe2\x82\xac\": 1}", "{\"\xe2\x82\xac\":1}");
+    CHECK_JSON("[\xc3\xa9]", NULL);
+    CHECK_JSON("{a\xc3\xa9: 1}", NULL);
+    CHECK_JSON("[1\xa0]", NULL);
+
+    // the same under other locales, where ctype would have said otherwise
+    static const char *const locales[] = {"C.UTF-8", "en_US.UTF-8", "de_DE.ISO-8859-1", "en_US.ISO-8859-1"};
+    for (size_t i = 0; i < sizeof(locales) / sizeof(*locales); ++i) {
+        if (!setlocale(LC_ALL, locales[i])) continue;
+        test_check(__FILE__, __LINE__, class_mismatches() == 0, locales[i]);
+    }
+    setlocale(LC_ALL, "C");
+}
+
+static void keywords(void)
+{
+    // whole keywords only, neither a prefix nor anything longer
+    CHECK_JSON("[true, false, null, Infinity, -Infinity]", "[true,false,null,Infinity,-Infinity]");
+    static const char *const not_keywords[] = {
+        "t", "tr", "tru", "trueX", "true_", "true1", "f", "fals", "falsey", "n", "nu", "nul", "nullify", "null$",
+        "N", "Na", "NaNa", "I", "Infinit", "Infinityy", "True", "NULL", "FALSE", "infinity", "nan", "-trueX", "-Infinit"
+    };
+
+    for (size_t i = 0; i < sizeof(not_keywords) / sizeof(*not_keywords); ++i) {
+        Jest_JsonVal val;
+        const Jest_Error err = Jest_parseJsonFromStr(&val, not_keywords[i]);
+        test_check(__FILE__, __LINE__, err != JEST_ERROR_NONE, not_keywords[i]);
+        if (!err) Jest_destroyJsonVal(&val);
+
+        // the lexer sees an identifier that runs to the end of each of them
+        const char *ident = (not_keywords[i][0] == '-')? &not_keywords[i][1] : not_keywords[i];
+        Jest_Lexer l;
+        const bool ok = Jest_initLexer(&l, NULL, 0, ident, strlen(ident));
+        test_check(__FILE__, __LINE__, ok && l.type == JEST_LEXEME_IDENT && l.ident_len == strlen(ident), ident);
+        Jest_destroyLexer(&l);
+    }
+
+    Jest_JsonVal val;
+    CHECK(Jest_parseJsonFromStr(&val, "NaN") == JEST_ERROR_NONE);
+    CHECK(val.type == JEST_JSONTYPE_NUM && val.v.as_num != val.v.as_num);
+
+    // such identifiers are fine as keys, while the keywords themselves aren't
+    CHECK_JSON("{trueX: 1, nullify: 2, falsey: 3, t: 4, nu: 5, Infinit: 6, NaNa: 7}",
+        "{\"trueX\":1,\"nullify\":2,\"falsey\":3,\"t\":4,\"nu\":5,\"Infinit\":6,\"NaNa\":7}");
+    CHECK_JSON("{true: 1}", NULL);
+    CHECK_JSON("{null: 1}", NULL);
+    CHECK_JSON("{false: 1}", NULL);
+    CHECK_JSON("{Infinity: 1}", NULL);
+    CHECK_JSON("{NaN: 1}", NULL);
+}
+
+void test_lexer(void)
+{
+    classes();
+    keywords();
+}
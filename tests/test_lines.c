@@ -0,0 +1,143 @@
+// json lines, which have to come out the same and in the same order however many threads parse them
+#include "test.h"
+
+typedef struct Lines {
+    char *text; // the input
+    size_t len;
+    char **expected; // compact json of every record, NULL for records that fail
+    size_t count;
+} Lines;
+
+static void lines_add(Lines *l, const char *line, const char *expected, bool record)
+{
+    l->len += (size_t)sprintf(&l->text[l->len], "%s\n", line);
+    if (record) l->expected[l->count++] = (expected)? Jest_strndup(expected, strlen(expected)) : NULL;
+}
+
+// enough lines for every thread to get some, with blank lines, comments and broken records in between
+static bool lines_make(Lines *l, size_t nlines)
+{
+    l->text = (char *)malloc(nlines * 96);
+    l->expected = (char **)malloc(nlines * sizeof(*l->expected));
+    l->len = l->count = 0;
+    if (!l->text || !l->expected) return false;
+
+    char line[96], expected[96];
+    for (size_t i = 0; i < nlines; ++i) {
+        if (i % 7 == 3) lines_add(l, (i % 2)? "" : "   \t\r", NULL, false);
+        else if (i % 11 == 5) lines_add(l, "  // just a comment", NULL, false);
+        else if (i % 13 == 6) lines_add(l, "{\"i\": }", NULL, true);
+        else if (i % 17 == 8) lines_add(l, "[1] [2]", NULL, true);
+        else if (i % 19 == 9) lines_add(l, "'a \\u0041 \\\"string\\\"' /* and a comment */\r", "\"a A \\\"string\\\"\"", true);
+        else if (i % 23 == 10) lines_add(l, "-12.5", "-12.5", true);
+        else {
+            snprintf(line, sizeof(line), "{\"i\": %zu, s: 'x\\n%zu', \"a\": [%zu, true, null, {}]}", i, i % 100, i % 7);
+            snprintf(expected, sizeof(expected), "{\"i\":%zu,\"s\":\"x\\n%zu\",\"a\":[%zu,true,null,{}]}", i, i % 100, i % 7);
+            lines_add(l, line, expected, true);
+        }
+    }
+
+    return true;
+}
+
+static void lines_destroy(Lines *l)
+{
+    if (l->expected) for (size_t i = 0; i < l->count; ++i) free(l->expected[i]);
+    free(l->expected);
+    free(l->text);
+}
+
+// counts the records that don't match what was generated
+static size_t record_mismatches(const Lines *l, size_t idx, const Jest_JsonVal *val, Jest_Error err)
+{
+    if (idx >= l->count) return 1;
+    if (!l->expected[idx]) return !err && val->type == JEST_JSONTYPE_NULL;
+    if (err) return 1;
+
+    char *out = test_write(val);
+    const bool same = out && !strcmp(out, l->expected[idx]);
+    free(out);
+    return !same;
+}
+
+typedef struct Received {
+    const Lines *lines;
+    size_t next, mismatches;
+    size_t stop_at; // index to return false at, (size_t)-1 for never
+} Received;
+
+static bool on_line(void *userdata, size_t idx, const Jest_JsonVal *val, Jest_Error err)
+{
+    Received *r = (Received *)userdata;
+    if (idx != r->next++) ++r->mismatches;
+    r->mismatches += record_mismatches(r->lines, idx, val, err);
+    return idx != r->stop_at;
+}
+
+static void against_generated(void)
+{
+    Lines l;
+    CHECK(lines_make(&l, 30000));
+    CHECK(l.len > 16 * JEST_PARALLEL_MIN_SLICE);
+
+    static const unsigned threads[] = {1, 2, 3, 4, 8, 0};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(*threads); ++t) {
+        Jest_JsonLines lines;
+        CHECK(Jest_parseJsonLines(&lines, l.text, l.len, threads[t]) == JEST_ERROR_NONE);
+        CHECK(lines.count == l.count);
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < lines.count; ++i) mismatches += record_mismatches(&l, i, &lines.values[i], lines.errors[i]);
+        CHECK(mismatches == 0);
+        Jest_destroyJsonLines(&lines);
+
+        Received r = {&l, 0, 0, (size_t)-1};
+        CHECK(Jest_parseJsonLinesCallback(l.text, l.len, threads[t], on_line, &r) == JEST_ERROR_NONE);
+        CHECK(r.next == l.count && r.mismatches == 0);
+    }
+
+    // stopping early
+    Received r = {&l, 0, 0, 100};
+    CHECK(Jest_parseJsonLinesCallback(l.text, l.len, 4, on_line, &r) == JEST_ERROR_ABORTED);
+    CHECK(r.next == 101 && r.mismatches == 0);
+
+    // and from a file
+    const char *path = test_scratch_file(l.text, l.len);
+    Received from_file = {&l, 0, 0, (size_t)-1};
+    CHECK(path && Jest_parseJsonLinesFromPath(path, 3, on_line, &from_file) == JEST_ERROR_NONE);
+    CHECK(from_file.next == l.count && from_file.mismatches == 0);
+
+    lines_destroy(&l);
+}
+
+static void edges(void)
+{
+    Jest_JsonLines lines;
+
+    // the last line doesn't need a newline, and nothing but blank lines is no records
+    CHECK(Jest_parseJsonLines(&lines, "1\n\n[2]", 6, 2) == JEST_ERROR_NONE);
+    CHECK(lines.count == 2 && lines.values[1].type == JEST_JSONTYPE_ARR);
+    Jest_destroyJsonLines(&lines);
+
+    CHECK(Jest_parseJsonLines(&lines, "\n \n// x\n", 7, 2) == JEST_ERROR_NONE);
+    CHECK(lines.count == 0);
+    Jest_destroyJsonLines(&lines);
+
+    CHECK(Jest_parseJsonLines(&lines, "", 0, 2) == JEST_ERROR_NONE);
+    CHECK(lines.count == 0);
+    Jest_destroyJsonLines(&lines);
+
+    // a record can't span lines
+    CHECK(Jest_parseJsonLines(&lines, "[1,\n2]", 6, 1) == JEST_ERROR_NONE);
+    CHECK(lines.count == 2 && lines.errors[0] != JEST_ERROR_NONE && lines.errors[1] != JEST_ERROR_NONE);
+    Jest_destroyJsonLines(&lines);
+
+    CHECK(Jest_parseJsonLines(NULL, "1", 1, 1) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_parseJsonLinesCallback("1", 1, 1, NULL, NULL) == JEST_ERROR_BADPARAM);
+}
+
+void test_lines(void)
+{
+    against_generated();
+    edges();
+}
@@ -0,0 +1,189 @@
+// the number parser has to give the same bits as strtod on everything json5 allows
+#include "test.h"
+
+#include <locale.h>
+
+static bool same_bits(double a, double b)
+{
+    return !memcmp(&a, &b, sizeof(a));
+}
+
+// lexes src as a single number
+static bool lex_num(const char *src, double *out)
+{
+    Jest_Lexer l;
+    const bool ok = Jest_initLexer(&l, NULL, 0, src, strlen(src)) && l.type == JEST_LEXEME_NUM;
+    *out = l.numval;
+
+    // the whole input has to be the number
+    const bool rest = ok && !Jest_lexerStep(&l) && l.type == JEST_LEXEME_EOF;
+    Jest_destroyLexer(&l);
+    return rest;
+}
+
+static void check_strtod(const char *file, int line, const char *src)
+{
+    double got = 0;
+    const bool ok = lex_num(src, &got);
+    const double expected = strtod(src, NULL);
+
+    test_check(file, line, ok && same_bits(got, expected), src);
+    if (ok && !same_bits(got, expected)) fprintf(stderr, "    got %.17g, expected %.17g\n", got, expected);
+}
+
+#define CHECK_STRTOD(src) check_strtod(__FILE__, __LINE__, (src))
+
+static void boundaries(void)
+{
+    // subnormals and underflow
+    CHECK_STRTOD("4.9e-324");
+    CHECK_STRTOD("4.9406564584124654e-324");
+    CHECK_STRTOD("2.4703282292062328e-324");
+    CHECK_STRTOD("2.4703282292062327e-324");
+    CHECK_STRTOD("2e-324");
+    CHECK_STRTOD("2.2250738585072011e-308");
+    CHECK_STRTOD("2.2250738585072014e-308");
+    CHECK_STRTOD("1e-400");
+    CHECK_STRTOD("-1e-400");
+
+    // overflow
+    CHECK_STRTOD("1.7976931348623157e308");
+    CHECK_STRTOD("1.7976931348623158e308");
+    CHECK_STRTOD("1.7976931348623159e308");
+    CHECK_STRTOD("1e400");
+    CHECK_STRTOD("-1e400");
+    CHECK_STRTOD("1e99999999999999999999");
+    CHECK_STRTOD("0e99999999999999999999");
+    CHECK_STRTOD("1e-99999999999999999999");
+
+    // mantissas around 19 digits, where digits stop fitting into 64 bits
+    CHECK_STRTOD("1234567890123456789");
+    CHECK_STRTOD("12345678901234567890");
+    CHECK_STRTOD("12345678901234567891");
+    CHECK_STRTOD("18446744073709551615");
+    CHECK_STRTOD("18446744073709551616");
+    CHECK_STRTOD("123456789012345678901234567890");
+    CHECK_STRTOD("0.1234567890123456789012345");
+    CHECK_STRTOD("1234567890.123456789012345e-10");
+    CHECK_STRTOD("100000000000000000000000000000000000001e-20");
+    CHECK_STRTOD("0.000000000000000000000000000000000000001234567890123456789012");
+
+    // ties that only the digits past the 19th decide
+    CHECK_STRTOD("9007199254740993");
+    CHECK_STRTOD("9007199254740993.00000000000000000001");
+    CHECK_STRTOD("9007199254740992.99999999999999999999");
+    CHECK_STRTOD("2.00000000000000011102230246251565404236316680908203125");
+    CHECK_STRTOD("2.00000000000000011102230246251565404236316680908203124");
+
+    // the fast paths and their edges
+    CHECK_STRTOD("1e22");
+    CHECK_STRTOD("1e23");
+    CHECK_STRTOD("123e30");
+    CHECK_STRTOD("9007199254740991e22");
+    CHECK_STRTOD("9007199254740992e-22");
+    CHECK_STRTOD("0.1");
+    CHECK_STRTOD("0.3");
+    CHECK_STRTOD("-0.0");
+    CHECK_STRTOD("0");
+    CHECK_STRTOD("1E+2");
+    CHECK_STRTOD("1e-0");
+
+    // json5 forms
+    CHECK_STRTOD(".5");
+    CHECK_STRTOD("5.");
+    CHECK_STRTOD("+1.5");
+    CHECK_STRTOD("-.25e1");
+}
+
+static void hex(void)
+{
+    double val;
+    CHECK(lex_num("0x10", &val) && val == 16);
+    CHECK(lex_num("0XfF", &val) && val == 255);
+    CHECK(lex_num("-0x1", &val) && val == -1);
+    CHECK(lex_num("+0xA", &val) && val == 10);
+    CHECK(lex_num("0x1FFFFFFFFFFFFF", &val) && val == 9007199254740991.0);
+
+    // more than 64 bits and the rounding that goes with it
+    CHECK_STRTOD("0xFFFFFFFFFFFFFFFF");
+    CHECK_STRTOD("0x20000000000001");
+    CHECK_STRTOD("0x1FFFFFFFFFFFFFFFFFFFF");
+    CHECK_STRTOD("-0x10000000000000000000000000");
+
+    CHECK_JSON("[0x]", NULL);
+    CHECK_JSON("[0xg]", NULL);
+    CHECK_JSON("[0x1, 0x2]", "[1,2]");
+}
+
+static void special(void)
+{
+    double val;
+    CHECK(lex_num("+Infinity", &val) && Jest_isinf(val) && val > 0);
+    CHECK(lex_num("-Infinity", &val) && Jest_isinf(val) && val < 0);
+    CHECK(lex_num("-NaN", &val) && Jest_isnan(val));
+
+    CHECK_JSON("[Infinity, -Infinity, NaN]", "[Infinity,-Infinity,NaN]");
+    CHECK_JSON("[1.5.5]", NULL);
+    CHECK_JSON("[1e]", NULL);
+    CHECK_JSON("[-]", NULL);
+    CHECK_JSON("[.]", NULL);
+    CHECK_JSON("[1x]", NULL);
+}
+
+static void random_round_trips(void)
+{
+    uint64_t state = UINT64_C(0x9e3779b97f4a7c15);
+    char buf[64];
+    int mismatches = 0;
+
+    for (int i = 0; i < 20000; ++i) {
+        // xorshift over the raw bits, so every exponent shows up
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        double x;
+        memcpy(&x, &state, sizeof(x));
+        if (Jest_isnan(x) || Jest_isinf(x)) continue;
+
+        snprintf(buf, sizeof(buf), (i & 1)? "%.17g" : "%.16e", x);
+
+        double got;
+        if (!lex_num(buf, &got) || !same_bits(got, strtod(buf, NULL))) {
+            if (++mismatches <= 5) fprintf(stderr, "    %s lexed as %.17g\n", buf, got);
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+static void locales(void)
+{
+    // what goes through strtod is read the same under a locale whose decimal point is a comma
+    static const char *const srcs[] = {
+        "0.30000000000000004", "12345678901234567890.5", "-1.7976931348623157e308", "2.4703282292062328e-324", "0x1fffffffffffffffff"
+    };
+    double expected[sizeof(srcs) / sizeof(*srcs)];
+    for (size_t i = 0; i < sizeof(srcs) / sizeof(*srcs); ++i) CHECK(lex_num(srcs[i], &expected[i]));
+
+    static const char *const comma_locales[] = {"de_DE.UTF-8", "fr_FR.UTF-8", "ru_RU.UTF-8", "de_DE", "fr_FR", "German_Germany.1252"};
+    for (size_t l = 0; l < sizeof(comma_locales) / sizeof(*comma_locales); ++l) {
+        if (!setlocale(LC_NUMERIC, comma_locales[l]) || !strcmp(localeconv()->decimal_point, ".")) continue;
+
+        for (size_t i = 0; i < sizeof(srcs) / sizeof(*srcs); ++i) {
+            double got = 0;
+            test_check(__FILE__, __LINE__, lex_num(srcs[i], &got) && same_bits(got, expected[i]), comma_locales[l]);
+        }
+    }
+
+    setlocale(LC_NUMERIC, "C");
+}
+
+void test_numbers(void)
+{
+    boundaries();
+    hex();
+    special();
+    random_round_trips();
+    locales();
+}
@@ -0,0 +1,111 @@
+// field lookups through the hash index and what happens to duplicate keys
+#include "test.h"
+
+static double field_num(Jest_JsonVal *obj, const char *accessor)
+{
+    Jest_JsonVal *field = Jest_jsonIdx(obj, accessor, NULL);
+    return (field && field->type == JEST_JSONTYPE_NUM)? field->v.as_num : -1;
+}
+
+static void index_growth(void)
+{
+    Jest_JsonVal obj = Jest_jsonObj();
+    char name[32], accessor[40];
+
+    // lookups have to keep working below the threshold, when the index is built and every time it grows
+    for (int i = 0; i < 200; ++i) {
+        snprintf(name, sizeof(name), "field%d", i);
+        CHECK(Jest_jsonObjAdd(&obj, name, Jest_jsonNumber(i)) == JEST_ERROR_NONE);
+
+        CHECK((obj.v.as_obj.index != NULL) == (obj.v.as_obj.nfields >= JEST_OBJ_INDEX_THRESHOLD));
+        for (int j = 0; j <= i; j += (i < 40)? 1 : 17) {
+            snprintf(accessor, sizeof(accessor), "[field%d]", j);
+            CHECK(field_num(&obj, accessor) == j);
+        }
+    }
+
+    CHECK(obj.v.as_obj.nfields == 200);
+    CHECK(Jest_jsonIdx(&obj, "[field200]", NULL) == NULL);
+    CHECK(Jest_jsonIdx(&obj, "[field]", NULL) == NULL);
+    CHECK(Jest_jsonIdx(&obj, "['']", NULL) == NULL);
+
+    Jest_destroyJsonVal(&obj);
+}
+
+static void duplicate_adds(void)
+{
+    // small objects are scanned linearly
+    Jest_JsonVal obj = Jest_jsonObj();
+    Jest_jsonObjAdd(&obj, "a", Jest_jsonNumber(1));
+    Jest_jsonObjAdd(&obj, "b", Jest_jsonNumber(2));
+    CHECK(Jest_jsonObjAdd(&obj, "a", Jest_jsonString("replaced")) == JEST_ERROR_NONE);
+
+    char *out = test_write(&obj);
+    CHECK_STR(out, "{\"a\":\"replaced\",\"b\":2}");
+    free(out);
+    Jest_destroyJsonVal(&obj);
+
+    // indexed objects replace in place as well, without growing
+    obj = Jest_jsonObj();
+    char name[32];
+    for (int i = 0; i < 40; ++i) {
+        snprintf(name, sizeof(name), "k%d", i);
+        Jest_jsonObjAdd(&obj, name, Jest_jsonNumber(i));
+    }
+
+    CHECK(obj.v.as_obj.index != NULL);
+    CHECK(Jest_jsonObjAdd(&obj, "k7", Jest_jsonNumber(700)) == JEST_ERROR_NONE);
+    CHECK(Jest_jsonObjAdd(&obj, "k39", Jest_jsonNumber(3900)) == JEST_ERROR_NONE);
+    CHECK(obj.v.as_obj.nfields == 40);
+    CHECK(field_num(&obj, "[k7]") == 700);
+    CHECK(field_num(&obj, "[k39]") == 3900);
+    CHECK(field_num(&obj, "[k8]") == 8);
+    CHECK(obj.v.as_obj.field_values[7].v.as_num == 700);
+
+    Jest_destroyJsonVal(&obj);
+}
+
+static void parsed_duplicates(void)
+{
+    // the last value wins and keeps the position of the first
+    CHECK_JSON("{\"a\": 1, \"a\": 2}", "{\"a\":2}");
+    CHECK_JSON("{a: 1, b: 2, a: 3}", "{\"a\":3,\"b\":2}");
+    CHECK_JSON("{\"a\": {\"x\": 1}, \"a\": [2]}", "{\"a\":[2]}");
+
+    char src[1024] = "{";
+    size_t len = 1;
+    for (int i = 0; i < 30; ++i) len += (size_t)snprintf(&src[len], sizeof(src) - len, "\"f%d\": %d, ", i, i);
+    snprintf(&src[len], sizeof(src) - len, "\"f3\": \"last\"}");
+
+    Jest_JsonVal val;
+    CHECK(Jest_parseJsonFromStr(&val, src) == JEST_ERROR_NONE);
+    CHECK(val.v.as_obj.nfields == 30);
+
+    Jest_JsonVal *f3 = Jest_jsonIdx(&val, "[f3]", NULL);
+    CHECK(f3 && f3->type == JEST_JSONTYPE_STR && !strcmp(f3->v.as_str.data, "last"));
+    CHECK(field_num(&val, "[f29]") == 29);
+    Jest_destroyJsonVal(&val);
+
+    // objects in a document's arena get the same index
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+    CHECK(Jest_parseDocumentFromBuf(&doc, src, strlen(src)) == JEST_ERROR_NONE);
+    CHECK(doc.root.v.as_obj.nfields == 30);
+    CHECK(doc.root.v.as_obj.index != NULL);
+
+    CHECK(Jest_docObjAdd(&doc, &doc.root, "f10", Jest_jsonNumber(-10)) == JEST_ERROR_NONE);
+    CHECK(Jest_docObjAdd(&doc, &doc.root, "new", Jest_jsonNumber(30)) == JEST_ERROR_NONE);
+    CHECK(doc.root.v.as_obj.nfields == 31);
+    CHECK(field_num(&doc.root, "[f10]") == -10);
+    CHECK(field_num(&doc.root, "[new]") == 30);
+    CHECK(field_num(&doc.root, "[f0]") == 0);
+
+    Jest_destroyDocument(&doc);
+}
+
+void test_objects(void)
+{
+    index_growth();
+    duplicate_adds();
+    parsed_duplicates();
+}
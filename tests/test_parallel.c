@@ -0,0 +1,189 @@
+// documents cut up across threads, which have to come out the same as when parsed on one
+#include "test.h"
+
+// a top level array of about len bytes whose elements hide brackets and commas in strings and comments
+static char *make_array(size_t len)
+{
+    char *doc = (char *)malloc(len + 256);
+    if (!doc) return NULL;
+
+    size_t n = (size_t)sprintf(doc, " // leading ] comment\n[");
+    for (int i = 0; n < len; ++i) {
+        switch (i % 6) {
+        case 0: n += (size_t)sprintf(&doc[n], "{\"i\": %d, s: \"],[\\\"]\", a: [[%d], []]},\n", i, i % 10); break;
+        case 1: n += (size_t)sprintf(&doc[n], "'it\\'s [not', /* ] , [ */ %d.5,\n", i); break;
+        case 2: n += (size_t)sprintf(&doc[n], "[[[{x: '\\u005d'}]]], // ],[\n"); break;
+        case 3: n += (size_t)sprintf(&doc[n], "true, null, -Infinity, 0x1F, "); break;
+        case 4: n += (size_t)sprintf(&doc[n], "\"\\\\\", \"\\\\\\\"]\",\n"); break;
+        default: n += (size_t)sprintf(&doc[n], "{}, {nested: {deeper: [1, {b: false}]}},\n"); break;
+        }
+    }
+
+    n += (size_t)sprintf(&doc[n], "\"last\",] /* trailing */ \n");
+    return doc;
+}
+
+static Jest_Error check_parallel(const char *file, int line, const char *src, size_t len, unsigned flags)
+{
+    Jest_Document serial;
+    Jest_initDocument(&serial);
+    serial.flags = flags;
+    const Jest_Error expected_err = Jest_parseDocumentFromBuf(&serial, src, len);
+    char *expected = (expected_err)? NULL : test_write(&serial.root);
+    Jest_destroyDocument(&serial);
+
+    static const unsigned threads[] = {2, 3, 4, 7, 0};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(*threads); ++t) {
+        Jest_Document doc;
+        Jest_initDocument(&doc);
+        doc.flags = flags;
+
+        const Jest_Error err = Jest_parseDocumentParallel(&doc, src, len, threads[t]);
+        test_check(file, line, (err == JEST_ERROR_NONE) == (expected_err == JEST_ERROR_NONE), "error of Jest_parseDocumentParallel");
+        if (!err && !expected_err) {
+            char *got = test_write(&doc.root);
+            test_check(file, line, got && expected && !strcmp(got, expected), "value of Jest_parseDocumentParallel");
+            free(got);
+        }
+
+        Jest_destroyDocument(&doc);
+    }
+
+    free(expected);
+    return expected_err;
+}
+
+#define CHECK_PARALLEL(src, len, flags) check_parallel(__FILE__, __LINE__, (src), (len), (flags))
+
+static void arrays(void)
+{
+    const size_t len = 16 * JEST_PARALLEL_MIN_SLICE;
+    char *doc = make_array(len);
+    CHECK(doc != NULL);
+    if (!doc) return;
+
+    const size_t doc_len = strlen(doc);
+    CHECK(CHECK_PARALLEL(doc, doc_len, 0) == JEST_ERROR_NONE);
+    CHECK_PARALLEL(doc, doc_len, JEST_DOC_ZEROCOPY);
+    CHECK_PARALLEL(doc, doc_len, JEST_DOC_INTERN);
+
+    // the elements are all there and in order
+    Jest_Document parallel;
+    Jest_initDocument(&parallel);
+    CHECK(Jest_parseDocumentParallel(&parallel, doc, doc_len, 4) == JEST_ERROR_NONE);
+    CHECK(parallel.root.type == JEST_JSONTYPE_ARR && parallel.root.v.as_arr.len > 10000);
+    const Jest_JsonVal *first = Jest_jsonIdx(&parallel.root, "[0][i]", NULL);
+    CHECK(first && first->type == JEST_JSONTYPE_NUM && first->v.as_num == 0);
+    const Jest_JsonVal *last = &parallel.root.v.as_arr.elems[parallel.root.v.as_arr.len - 1];
+    CHECK(last->type == JEST_JSONTYPE_STR && !strcmp(last->v.as_str.data, "last"));
+    Jest_destroyDocument(&parallel);
+
+    // interned names are one copy across all the slices, which names added later share as well
+    Jest_initDocument(&parallel);
+    parallel.flags = JEST_DOC_INTERN;
+    CHECK(Jest_parseDocumentParallel(&parallel, doc, doc_len, 4) == JEST_ERROR_NONE);
+    const Jest_JsonVal *elems = parallel.root.v.as_arr.elems;
+    size_t last_obj = parallel.root.v.as_arr.len - 1;
+    while (last_obj && !(elems[last_obj].type == JEST_JSONTYPE_OBJ && elems[last_obj].v.as_obj.nfields == 3)) --last_obj;
+    CHECK(last_obj > parallel.root.v.as_arr.len / 2 && parallel.intern != NULL);
+    CHECK(elems[0].v.as_obj.field_names[0] == elems[last_obj].v.as_obj.field_names[0]);
+    CHECK(elems[0].v.as_obj.field_names[2] == elems[last_obj].v.as_obj.field_names[2]);
+
+    Jest_JsonVal added = Jest_jsonObj();
+    added.flags = JEST_JSONFLAG_ARENA;
+    CHECK(Jest_docObjAdd(&parallel, &added, "s", Jest_jsonNumber(1)) == JEST_ERROR_NONE);
+    CHECK(added.v.as_obj.field_names[0] == elems[last_obj].v.as_obj.field_names[1]);
+    Jest_destroyDocument(&parallel);
+
+    // broken elements anywhere in the array and a missing end fail like they do on one thread
+    static const double where[] = {0.1, 0.5, 0.99};
+    for (size_t w = 0; w < sizeof(where) / sizeof(*where); ++w) {
+        char *broken = (char *)malloc(doc_len + 1);
+        CHECK(broken != NULL);
+        if (!broken) continue;
+
+        memcpy(broken, doc, doc_len + 1);
+        char *comma = strstr(&broken[(size_t)(where[w] * (double)doc_len)], ", ");
+        CHECK(comma != NULL);
+        if (comma) {
+            comma[1] = ':';
+            CHECK(CHECK_PARALLEL(broken, doc_len, 0) != JEST_ERROR_NONE);
+        }
+
+        free(broken);
+    }
+
+    char *unclosed = make_array(len);
+    if (unclosed) {
+        char *bracket = strrchr(unclosed, ']');
+        *bracket = ' ';
+        CHECK(CHECK_PARALLEL(unclosed, strlen(unclosed), 0) != JEST_ERROR_NONE);
+        free(unclosed);
+    }
+
+    // nor does a brace close it, which the scan that cuts it up can't tell from a bracket
+    char *brace = make_array(len);
+    if (brace) {
+        *strrchr(brace, ']') = '}';
+        CHECK(CHECK_PARALLEL(brace, strlen(brace), 0) == JEST_ERROR_SYNTAX);
+        free(brace);
+    }
+
+    // whatever follows the array is left alone on any number of threads
+    char *trailing = make_array(len);
+    if (trailing) {
+        const size_t trailing_len = strlen(trailing);
+        trailing[trailing_len - 1] = '1';
+        CHECK_PARALLEL(trailing, trailing_len, 0);
+        free(trailing);
+    }
+
+    // slices with no elements in them at all
+    char *sparse = (char *)malloc(len + 8);
+    if (sparse) {
+        memset(sparse, ' ', len + 8);
+        sparse[0] = '[';
+        memcpy(&sparse[len], "1, 2]", 5);
+        CHECK(CHECK_PARALLEL(sparse, len + 8, 0) == JEST_ERROR_NONE);
+        free(sparse);
+    }
+
+    free(doc);
+}
+
+static void fallbacks(void)
+{
+    // anything but a large top level array goes through the ordinary parser
+    char *doc = make_array(4 * JEST_PARALLEL_MIN_SLICE);
+    CHECK(doc != NULL);
+    if (!doc) return;
+
+    char *bracket = strchr(doc, '[');
+    char *obj = (char *)malloc(strlen(doc) + 8);
+    if (obj) {
+        const size_t prefix = (size_t)(bracket - doc);
+        memcpy(obj, doc, prefix);
+        const size_t n = prefix + (size_t)sprintf(&obj[prefix], "{a: %s}", bracket);
+        CHECK(CHECK_PARALLEL(obj, n, 0) == JEST_ERROR_NONE);
+        free(obj);
+    }
+
+    CHECK_PARALLEL("[1, [2, 3], {a: 4}]", 19, 0);
+    CHECK_PARALLEL("  []  ", 6, 0);
+    CHECK_PARALLEL("\"str\"", 5, 0);
+    CHECK_PARALLEL("// only a comment", 17, 0);
+
+    Jest_Document d;
+    Jest_initDocument(&d);
+    CHECK(Jest_parseDocumentParallel(&d, "[]", 0, 4) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_parseDocumentParallel(NULL, "[]", 2, 4) == JEST_ERROR_BADPARAM);
+    Jest_destroyDocument(&d);
+
+    free(doc);
+}
+
+void test_parallel(void)
+{
+    arrays();
+    fallbacks();
+}
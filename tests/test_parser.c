@@ -0,0 +1,89 @@
+// reusable parsers, whose results have to match fresh parses while their memory is recycled
+#include "test.h"
+
+static const char *const documents[] = {
+    "{\"a\": [1, 2.5, \"s\\u00e9\"], b: {c: null, d: [true, false, [], {}]}, e: 'esc\\taped'}",
+    "[[[[1]], [[2, [3]]]], {a: {b: {c: {}}}}, 1e300, -Infinity, \"\"]",
+    "{a: 1, b: 2, a: {x: 3}, b: [4]}",
+    "\"just a string\"",
+    "[1, {a: }]", // broken in the middle of the stream
+    "-12.5",
+    "{}"
+};
+
+static void sequence(void)
+{
+    for (unsigned flags = 0; flags <= (JEST_DOC_ZEROCOPY | JEST_DOC_INTERN); ++flags) {
+        Jest_Parser p;
+        Jest_initParser(&p);
+        p.doc.flags = flags;
+
+        // every document in turn and then again, each one on its own
+        for (size_t round = 0; round < 2; ++round) {
+            for (size_t d = 0; d < sizeof(documents) / sizeof(*documents); ++d) {
+                Jest_JsonVal fresh;
+                const Jest_Error expected_err = Jest_parseJsonFromStr(&fresh, documents[d]);
+                char *expected = (expected_err)? NULL : test_write(&fresh);
+                if (!expected_err) Jest_destroyJsonVal(&fresh);
+
+                const Jest_Error err = Jest_parserParse(&p, documents[d], strlen(documents[d]));
+                test_check(__FILE__, __LINE__, err == expected_err, documents[d]);
+                if (err) {
+                    CHECK(p.doc.root.type == JEST_JSONTYPE_NULL);
+                } else {
+                    char *got = test_write(&p.doc.root);
+                    CHECK_STR(got, expected);
+                    free(got);
+                }
+
+                free(expected);
+            }
+        }
+
+        Jest_destroyParser(&p);
+    }
+}
+
+static void recycling(void)
+{
+    // long enough that the escaped strings outgrow the lexer's first string buffer
+    char src[4096];
+    size_t n = (size_t)sprintf(src, "{\"k\": [");
+    for (int i = 0; i < 40; ++i) n += (size_t)sprintf(&src[n], "\"%d \\\"escaped\\\" %064d\", ", i, i);
+    sprintf(&src[n], "0], \"last\": {\"x\": 1}}");
+
+    Jest_Parser p;
+    Jest_initParser(&p);
+    CHECK(Jest_parserParse(&p, src, strlen(src)) == JEST_ERROR_NONE);
+    CHECK(Jest_parserParse(&p, src, strlen(src)) == JEST_ERROR_NONE);
+
+    // once warmed up, the same input is built in the same memory as the time before
+    const char *strbuf = p.lexer.strbuf;
+    const Jest_JsonVal *fields = p.doc.root.v.as_obj.field_values;
+    const Jest_JsonVal *inner = Jest_jsonIdx(&p.doc.root, "[k]", NULL)->v.as_arr.elems;
+
+    for (int i = 0; i < 3; ++i) {
+        CHECK(Jest_parserParse(&p, src, strlen(src)) == JEST_ERROR_NONE);
+        CHECK(p.lexer.strbuf == strbuf && p.lexer.strbuf_owned);
+        CHECK(p.doc.root.v.as_obj.field_values == fields);
+        CHECK(Jest_jsonIdx(&p.doc.root, "[k]", NULL)->v.as_arr.elems == inner);
+    }
+
+    const Jest_JsonVal *x = Jest_jsonIdx(&p.doc.root, "[last][x]", NULL);
+    CHECK(x && x->type == JEST_JSONTYPE_NUM && x->v.as_num == 1);
+
+    CHECK(Jest_parserParse(&p, src, 0) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_parserParse(&p, NULL, 1) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_parserParse(NULL, src, 1) == JEST_ERROR_BADPARAM);
+    Jest_destroyParser(&p);
+
+    // destroying a parser that never parsed anything is fine
+    Jest_initParser(&p);
+    Jest_destroyParser(&p);
+}
+
+void test_parser(void)
+{
+    sequence();
+    recycling();
+}
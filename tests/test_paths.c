@@ -0,0 +1,264 @@
+// resolving accessors, one at a time with Jest_jsonIdx, compiled with Jest_compilePath and in sets
+#include "test.h"
+
+static const char sample[] =
+    "{a: [10, {b: 'x', 'c d': [true, null]}], \"esc\\u0041\": 1, trueX: 2, nullify: 3, \"\": 4, '0': 5}";
+
+// the accessor resolved against sample written out, or the error it failed with
+static void check_idx(const char *file, int line, const char *accessor, const char *expected, Jest_Error expected_err)
+{
+    Jest_JsonVal root;
+    if (Jest_parseJsonFromStr(&root, sample)) {
+        test_check(file, line, false, "sample");
+        return;
+    }
+
+    Jest_Error err = JEST_ERROR_SYNTAX;
+    const Jest_JsonVal *found = Jest_jsonIdx(&root, accessor, &err);
+    if (expected) {
+        char *out = (found)? test_write(found) : NULL;
+        test_check_str(file, line, (out)? out : "(null)", expected);
+        test_check(file, line, err == JEST_ERROR_NONE, accessor);
+        free(out);
+    } else test_check(file, line, !found && err == expected_err, accessor);
+
+    // a compiled path gives the same, over and over
+    Jest_Path path;
+    const Jest_Error compile_err = Jest_compilePath(&path, accessor);
+    if (!compile_err) {
+        for (int i = 0; i < 2; ++i) test_check(file, line, Jest_pathResolve(&path, &root, NULL) == found, accessor);
+    } else test_check(file, line, !expected && compile_err == expected_err && !path.steps && !path.nsteps, accessor);
+    Jest_destroyPath(&path);
+
+    Jest_destroyJsonVal(&root);
+}
+
+#define CHECK_IDX(accessor, expected) check_idx(__FILE__, __LINE__, (accessor), (expected), JEST_ERROR_NONE)
+#define CHECK_IDX_ERR(accessor, err) check_idx(__FILE__, __LINE__, (accessor), NULL, (err))
+
+static void lookups(void)
+{
+    CHECK_IDX("[a]", "[10,{\"b\":\"x\",\"c d\":[true,null]}]");
+    CHECK_IDX("[a][0]", "10");
+    CHECK_IDX("['a'][1][b]", "\"x\"");
+    CHECK_IDX("[\"a\"][1]['c d'][1]", "null");
+    CHECK_IDX("  [ a ] [ 1 ]  [ 'c d' ] [ 0 ] ", "true");
+    CHECK_IDX("[escA]", "1");
+    CHECK_IDX("['esc\\u0041']", "1");
+    CHECK_IDX("['']", "4");
+    CHECK_IDX("['0']", "5");
+    CHECK_IDX_ERR("[0x0]", JEST_ERROR_BADPARAM);
+
+    // identifiers that only start like keywords are keys like any other
+    CHECK_IDX("[trueX]", "2");
+    CHECK_IDX("[nullify]", "3");
+
+    // missing values, and keys and indices on the wrong kind of container
+    CHECK_IDX_ERR("[b]", JEST_ERROR_BADPARAM);
+    CHECK_IDX_ERR("[a][2]", JEST_ERROR_BADPARAM);
+    CHECK_IDX_ERR("[a][1][0]", JEST_ERROR_BADPARAM);
+    CHECK_IDX_ERR("[a][x]", JEST_ERROR_BADPARAM);
+    CHECK_IDX_ERR("[0]", JEST_ERROR_BADPARAM);
+    CHECK_IDX_ERR("[a][0][0]", JEST_ERROR_BADPARAM);
+}
+
+static void rejected(void)
+{
+    // nothing the lexer can start on
+    CHECK_IDX_ERR("", JEST_ERROR_BADLEXER);
+    CHECK_IDX_ERR("   ", JEST_ERROR_BADLEXER);
+    CHECK_IDX_ERR("@", JEST_ERROR_BADLEXER);
+
+    // keywords aren't keys, the parser never makes a field out of them either
+    CHECK_IDX_ERR("[true]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[false]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[null]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[a][null]", JEST_ERROR_SYNTAX);
+
+    CHECK_IDX_ERR("a", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[a", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[a]]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[a][", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[[a]]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[a b]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[-1]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[1.5]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[NaN]", JEST_ERROR_SYNTAX);
+    CHECK_IDX_ERR("[Infinity]", JEST_ERROR_SYNTAX);
+
+    // only containers can be looked into
+    Jest_JsonVal num = Jest_jsonNumber(1);
+    Jest_Error err = JEST_ERROR_NONE;
+    CHECK(Jest_jsonIdx(&num, "[0]", &err) == NULL && err == JEST_ERROR_BADPARAM);
+    CHECK(Jest_jsonIdx(NULL, "[0]", &err) == NULL && err == JEST_ERROR_BADPARAM);
+    CHECK(Jest_jsonIdx(&num, NULL, NULL) == NULL);
+
+    Jest_Path path;
+    CHECK(Jest_compilePath(&path, NULL) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_compilePath(NULL, "[a]") == JEST_ERROR_BADPARAM);
+    CHECK(Jest_pathResolve(NULL, &num, &err) == NULL && err == JEST_ERROR_BADPARAM);
+}
+
+static void compiled(void)
+{
+    Jest_Path path;
+    CHECK(Jest_compilePath(&path, "[list][2]['k\\ty'][name]") == JEST_ERROR_NONE);
+    CHECK(path.nsteps == 4);
+    CHECK(path.steps[0].key_len == 4 && !memcmp(path.steps[0].key, "list", 4));
+    CHECK(!path.steps[1].key && path.steps[1].idx == 2);
+    CHECK(path.steps[2].key_len == 3 && !memcmp(path.steps[2].key, "k\ty", 3));
+
+    // the same path against different roots, built and parsed, small objects and indexed ones
+    Jest_JsonVal inner = Jest_jsonObj();
+    char name[16];
+    for (int i = 0; i < JEST_OBJ_INDEX_THRESHOLD * 2; ++i) {
+        snprintf(name, sizeof(name), "pad%d", i);
+        Jest_jsonObjAdd(&inner, name, Jest_jsonNumber(i));
+    }
+    Jest_jsonObjAdd(&inner, "name", Jest_jsonString("built"));
+    CHECK(inner.v.as_obj.index != NULL);
+
+    Jest_JsonVal wrapper = Jest_jsonObj();
+    Jest_jsonObjAdd(&wrapper, "k\ty", inner);
+    Jest_JsonVal list = Jest_jsonArray();
+    Jest_JsonVal null = Jest_jsonNull();
+    Jest_jsonArrayAppend(&list, &null);
+    Jest_jsonArrayAppend(&list, &null);
+    Jest_jsonArrayAppend(&list, &wrapper);
+    Jest_JsonVal built = Jest_jsonObj();
+    Jest_jsonObjAdd(&built, "list", list);
+
+    Jest_JsonVal parsed;
+    CHECK(Jest_parseJsonFromStr(&parsed, "{list: [0, 1, {'k\\ty': {name: 'parsed'}}]}") == JEST_ERROR_NONE);
+
+    const Jest_JsonVal *found = Jest_pathResolve(&path, &built, NULL);
+    CHECK(found && found->type == JEST_JSONTYPE_STR && !strcmp(found->v.as_str.data, "built"));
+    found = Jest_pathResolve(&path, &parsed, NULL);
+    CHECK(found && found->type == JEST_JSONTYPE_STR && !strcmp(found->v.as_str.data, "parsed"));
+
+    Jest_destroyJsonVal(&built);
+    Jest_destroyJsonVal(&parsed);
+    Jest_destroyPath(&path);
+    CHECK(!path.steps && !path.keys && !path.nsteps);
+}
+
+static const char *const set_accessors[] = {
+    "[a]", "[a][0]", "[a][1][b]", "[a][1]['c d']", "[a][1]['c d'][1]", "[x][y][z]", "[k]", "[k][0]", "[a][1]"
+};
+
+#define NSET (sizeof(set_accessors) / sizeof(*set_accessors))
+
+// extracting straight from src has to give what resolving each accessor against the parsed tree does
+static void check_set(const char *file, int line, const Jest_PathSet *set, const char *src)
+{
+    Jest_JsonVal root;
+    if (Jest_parseJsonFromStr(&root, src)) {
+        test_check(file, line, false, src);
+        return;
+    }
+
+    Jest_JsonVal *resolved[NSET];
+    Jest_pathSetResolve(set, &root, resolved);
+
+    Jest_JsonVal extracted[NSET];
+    Jest_Lexer l;
+    test_check(file, line, Jest_initLexer(&l, NULL, 0, src, strlen(src)), src);
+    test_check(file, line, Jest_pathSetExtract(set, &l, extracted) == JEST_ERROR_NONE, src);
+    Jest_destroyLexer(&l);
+
+    for (size_t i = 0; i < NSET; ++i) {
+        test_check(file, line, resolved[i] == Jest_jsonIdx(&root, set_accessors[i], NULL), set_accessors[i]);
+
+        char *expected = (resolved[i])? test_write(resolved[i]) : NULL;
+        char *got = (extracted[i].type != JEST_JSONTYPE_ERR)? test_write(&extracted[i]) : NULL;
+        test_check_str(file, line, (got)? got : "(missing)", (expected)? expected : "(missing)");
+
+        free(expected);
+        free(got);
+        Jest_destroyJsonVal(&extracted[i]);
+    }
+
+    Jest_destroyJsonVal(&root);
+}
+
+#define CHECK_SET(set, src) check_set(__FILE__, __LINE__, (set), (src))
+
+static void path_sets(void)
+{
+    Jest_PathSet set;
+    CHECK(Jest_compilePathSet(&set, set_accessors, NSET) == JEST_ERROR_NONE);
+    CHECK(set.npaths == NSET);
+
+    CHECK_SET(&set, sample);
+    CHECK_SET(&set, "{x: {y: {z: [1, {q: 2}]}}, k: 'str', a: 5}");
+    CHECK_SET(&set, "[1, 2]");
+    CHECK_SET(&set, "{}");
+
+    // the last of duplicate keys wins, along with everything under it, like it does in the tree
+    CHECK_SET(&set, "{a: [1, {b: 2, 'c d': [3, 4]}], a: [5, {b: 6}]}");
+    CHECK_SET(&set, "{a: [1, {b: 2}], a: 'gone'}");
+    CHECK_SET(&set, "{a: [1, {b: 2, b: 3, 'c d': [4, 5], 'c d': []}], k: [6], k: 7}");
+    CHECK_SET(&set, "{a: [0, {b: 1}], x: {y: {z: 2}}, a: [3, {b: 4}], x: {y: {}}, x: {y: {z: 5}}}");
+    CHECK_SET(&set, "{k: [0], a: 1, k: null, a: [2, {'c d': [3, 4]}, 5], a: [6, {'c d': 7}]}");
+
+    // bad input fails every path
+    Jest_JsonVal out[NSET];
+    Jest_Lexer l;
+    CHECK(Jest_initLexer(&l, NULL, 0, "{a: [1, {b: 2}], k: [}", 22));
+    CHECK(Jest_pathSetExtract(&set, &l, out) == JEST_ERROR_SYNTAX);
+    for (size_t i = 0; i < NSET; ++i) CHECK(out[i].type == JEST_JSONTYPE_ERR && out[i].v.as_err == JEST_ERROR_SYNTAX);
+    Jest_destroyLexer(&l);
+
+    Jest_destroyPathSet(&set);
+
+    // one bad accessor fails the whole set
+    const char *const bad[] = {"[a]", "[true]"};
+    CHECK(Jest_compilePathSet(&set, bad, 2) == JEST_ERROR_SYNTAX);
+    CHECK(!set.paths && !set.nodes);
+    CHECK(Jest_compilePathSet(NULL, bad, 2) == JEST_ERROR_BADPARAM);
+}
+
+static void deep_copies(void)
+{
+    // values below the end of another path are copied out of its tree, however deep they are
+    const size_t depth = 1000000;
+    char *src = (char *)malloc(2 * depth + 1);
+    CHECK(src != NULL);
+    if (!src) return;
+
+    memset(src, '[', depth);
+    memset(&src[depth], ']', depth);
+    src[2 * depth] = '\0';
+
+    Jest_PathSet set;
+    const char *const accessors[] = {"[0]", "[0][0][0]"};
+    CHECK(Jest_compilePathSet(&set, accessors, 2) == JEST_ERROR_NONE);
+
+    Jest_Lexer l;
+    Jest_JsonVal out[2];
+    CHECK(Jest_initLexer(&l, NULL, 0, src, 2 * depth));
+    l.max_depth = 2 * depth;
+    CHECK(Jest_pathSetExtract(&set, &l, out) == JEST_ERROR_NONE);
+    Jest_destroyLexer(&l);
+
+    // count the levels of the copy
+    for (size_t i = 0; i < 2; ++i) {
+        size_t levels = 0;
+        for (const Jest_JsonVal *v = &out[i]; v->type == JEST_JSONTYPE_ARR && v->v.as_arr.len; v = &v->v.as_arr.elems[0]) ++levels;
+        CHECK(levels == depth - 2 - 2 * i);
+        Jest_destroyJsonVal(&out[i]);
+    }
+
+    Jest_destroyPathSet(&set);
+    free(src);
+}
+
+void test_paths(void)
+{
+    lookups();
+    rejected();
+    compiled();
+    path_sets();
+    deep_copies();
+}
@@ -0,0 +1,201 @@
+// events of the sax parser, their order and how parsing stops
+#include "test.h"
+
+static void events_put(TestEvents *ev, const char *prefix, const char *str, size_t len)
+{
+    const size_t prefix_len = strlen(prefix);
+    const size_t need = ev->len + prefix_len + len + 2;
+
+    if (need > ev->cap) {
+        size_t cap = (ev->cap)? ev->cap : 64;
+        while (cap < need) cap *= 2;
+
+        char *text = (char *)realloc(ev->text, cap);
+        if (!text) return;
+
+        ev->text = text;
+        ev->cap = cap;
+    }
+
+    if (ev->len) ev->text[ev->len++] = ' ';
+    memcpy(&ev->text[ev->len], prefix, prefix_len);
+    memcpy(&ev->text[ev->len + prefix_len], str, len);
+    ev->len += prefix_len + len;
+    ev->text[ev->len] = '\0';
+}
+
+static bool events_add(TestEvents *ev, const char *prefix, const char *str, size_t len)
+{
+    events_put(ev, prefix, str, len);
+    return ++ev->count != ev->stop_at;
+}
+
+static bool on_begin_obj(void *userdata) { return events_add((TestEvents *)userdata, "{", "", 0); }
+static bool on_end_obj(void *userdata) { return events_add((TestEvents *)userdata, "}", "", 0); }
+static bool on_begin_arr(void *userdata) { return events_add((TestEvents *)userdata, "[", "", 0); }
+static bool on_end_arr(void *userdata) { return events_add((TestEvents *)userdata, "]", "", 0); }
+static bool on_null(void *userdata) { return events_add((TestEvents *)userdata, "null", "", 0); }
+
+static bool on_key(void *userdata, const char *str, size_t len)
+{
+    return events_add((TestEvents *)userdata, "k:", str, len);
+}
+
+static bool on_str(void *userdata, const char *str, size_t len)
+{
+    return events_add((TestEvents *)userdata, "s:", str, len);
+}
+
+static bool on_num(void *userdata, double val)
+{
+    char buf[32];
+    return events_add((TestEvents *)userdata, "n:", buf, strlen(Jest_dblToStr(buf, sizeof(buf), val)));
+}
+
+static bool on_boolean(void *userdata, bool val)
+{
+    return events_add((TestEvents *)userdata, (val)? "true" : "false", "", 0);
+}
+
+const Jest_SaxHandler test_events_handler = {
+    on_begin_obj, on_end_obj, on_begin_arr, on_end_arr, on_key, on_str, on_num, on_boolean, on_null
+};
+
+void test_events_init(TestEvents *ev, size_t stop_at)
+{
+    memset(ev, 0, sizeof(*ev));
+    ev->stop_at = stop_at;
+}
+
+void test_events_destroy(TestEvents *ev)
+{
+    free(ev->text);
+    memset(ev, 0, sizeof(*ev));
+}
+
+const char *test_events_text(const TestEvents *ev)
+{
+    return (ev->text)? ev->text : "";
+}
+
+// events of src through the lexer based parser
+static Jest_Error sax(const char *src, TestEvents *ev)
+{
+    Jest_Lexer l;
+    if (!Jest_initLexer(&l, NULL, 0, src, strlen(src))) {
+        Jest_destroyLexer(&l);
+        return JEST_ERROR_BADLEXER;
+    }
+
+    const Jest_Error err = Jest_parseSaxLexer(&l, &test_events_handler, ev);
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+static void check_events(const char *file, int line, const char *src, const char *expected)
+{
+    TestEvents ev;
+    test_events_init(&ev, 0);
+
+    const Jest_Error err = sax(src, &ev);
+    if (expected) test_check_str(file, line, (err)? "(error)" : test_events_text(&ev), expected);
+    else test_check(file, line, err != JEST_ERROR_NONE, src);
+
+    test_events_destroy(&ev);
+}
+
+#define CHECK_EVENTS(src, expected) check_events(__FILE__, __LINE__, (src), (expected))
+
+static void event_order(void)
+{
+    CHECK_EVENTS("1", "n:1");
+    CHECK_EVENTS("'s'", "s:s");
+    CHECK_EVENTS("[]", "[ ]");
+    CHECK_EVENTS("{}", "{ }");
+    CHECK_EVENTS("[1, [true, false], null, {}]", "[ n:1 [ true false ] null { } ]");
+    CHECK_EVENTS(
+        "{\"a\": {b: [\"x\\ty\", -0.5, Infinity]}, 'c': [[[]]], d: {}}",
+        "{ k:a { k:b [ s:x\ty n:-0.5 n:Infinity ] } k:c [ [ [ ] ] ] k:d { } }"
+    );
+
+    // json5 leniency goes through as well
+    CHECK_EVENTS("[1, 2,]", "[ n:1 n:2 ]");
+    CHECK_EVENTS("{a: 1,} // trailing", "{ k:a n:1 }");
+}
+
+static void agrees_with_tree(void)
+{
+    // the event parser accepts exactly what the tree parser accepts
+    static const char *const inputs[] = {
+        "[1 2]", "[1,,2]", "[,]", "{a 1}", "{a: }", "{: 1}", "{a: 1 b: 2}", "{1: 2}", "[}", "{]",
+        "[[]", "[]]", "{\"a\": [}", "[1,]", "{a: 1,}", "[\"\\q\"]", "['a\"]", "[tru]", "[nul]",
+        "{true: 1}", "{null: 2}",
+        "{'a': 1, \"b\": [null, true, {c: []}]}", "[-Infinity, NaN, 0x1f, .5]"
+    };
+
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(*inputs); ++i) {
+        Jest_JsonVal val;
+        const Jest_Error tree_err = Jest_parseJsonFromStr(&val, inputs[i]);
+        if (!tree_err) Jest_destroyJsonVal(&val);
+
+        TestEvents ev;
+        test_events_init(&ev, 0);
+        const Jest_Error sax_err = sax(inputs[i], &ev);
+        test_check(__FILE__, __LINE__, (tree_err == JEST_ERROR_NONE) == (sax_err == JEST_ERROR_NONE), inputs[i]);
+        test_events_destroy(&ev);
+    }
+}
+
+static void stopping(void)
+{
+    // returning false stops right after that event
+    for (size_t stop_at = 1; stop_at <= 6; ++stop_at) {
+        TestEvents ev;
+        test_events_init(&ev, stop_at);
+        CHECK(sax("[1, {a: null}, 2]", &ev) == JEST_ERROR_ABORTED);
+        CHECK(ev.count == stop_at);
+        test_events_destroy(&ev);
+    }
+
+    // callbacks that aren't there are skipped
+    Jest_SaxHandler only_nums;
+    memset(&only_nums, 0, sizeof(only_nums));
+    only_nums.num = test_events_handler.num;
+
+    TestEvents ev;
+    test_events_init(&ev, 0);
+    Jest_Lexer l;
+    CHECK(Jest_initLexer(&l, NULL, 0, "{a: [1, 'x', 2]}", 16));
+    CHECK(Jest_parseSaxLexer(&l, &only_nums, &ev) == JEST_ERROR_NONE);
+    CHECK_STR(test_events_text(&ev), "n:1 n:2");
+    Jest_destroyLexer(&l);
+    test_events_destroy(&ev);
+
+    CHECK(Jest_parseSaxLexer(NULL, &only_nums, NULL) == JEST_ERROR_BADPARAM);
+}
+
+static void from_file(void)
+{
+    FILE *file = tmpfile();
+    CHECK(file != NULL);
+    if (!file) return;
+
+    fputs("{\"list\": [1, \"two\", [3]], \"flag\": false}", file);
+    rewind(file);
+
+    TestEvents ev;
+    test_events_init(&ev, 0);
+    CHECK(Jest_parseSaxFile(file, &test_events_handler, &ev) == JEST_ERROR_NONE);
+    CHECK_STR(test_events_text(&ev), "{ k:list [ n:1 s:two [ n:3 ] ] k:flag false }");
+    test_events_destroy(&ev);
+
+    fclose(file);
+}
+
+void test_sax(void)
+{
+    event_order();
+    agrees_with_tree();
+    stopping();
+    from_file();
+}
@@ -0,0 +1,141 @@
+// whitespace, string and container scanning, at every length around the 16 and 32 byte blocks of the simd kernels
+#include "test.h"
+
+static bool str_equals(const Jest_JsonVal *val, const char *expected, size_t len)
+{
+    return val->type == JEST_JSONTYPE_STR && val->v.as_str.len == len && !memcmp(val->v.as_str.data, expected, len);
+}
+
+static void whitespace_runs(void)
+{
+    static const char spaces[] = " \t\n\v\f\r";
+    char src[256];
+    Jest_JsonVal val;
+
+    for (size_t n = 0; n < 100; ++n) {
+        // whitespace on both sides of an element
+        size_t len = 0;
+        src[len++] = '[';
+        for (size_t i = 0; i < n; ++i) src[len++] = spaces[(i * 7 + n) % 6];
+        src[len++] = '7';
+        for (size_t i = 0; i < n; ++i) src[len++] = spaces[(i * 5 + n) % 6];
+        src[len] = ']';
+
+        CHECK(Jest_parseJsonFromBuf(&val, src, len + 1) == JEST_ERROR_NONE);
+        CHECK(val.type == JEST_JSONTYPE_ARR && val.v.as_arr.len == 1 && val.v.as_arr.elems[0].v.as_num == 7);
+        Jest_destroyJsonVal(&val);
+
+        // the bytes next to the whitespace range, high bytes look negative to signed compares
+        static const char not_spaces[] = {'\b', '\x0e', '\x1f', '!', '\x80', '\xa0', '\xff'};
+        for (size_t k = 0; k < sizeof(not_spaces); ++k) {
+            src[len] = not_spaces[k];
+            src[len + 1] = ']';
+            CHECK(Jest_parseJsonFromBuf(&val, src, len + 2) == JEST_ERROR_SYNTAX);
+        }
+    }
+
+    // comments break the runs up
+    CHECK_JSON("  // comment\n\t /* block */  [ 1 ,\n\n 2 ] //", "[1,2]");
+}
+
+static void string_bodies(void)
+{
+    char src[160], expected[160];
+    Jest_JsonVal val;
+
+    for (size_t n = 0; n < 100; ++n) {
+        // plain bytes, including utf-8 and the other quote
+        src[0] = '"';
+        for (size_t i = 0; i < n; ++i) expected[i] = "ab'\xc3\xa9 ~\x7f"[i % 8];
+        memcpy(&src[1], expected, n);
+        src[n + 1] = '"';
+        CHECK(Jest_parseJsonFromBuf(&val, src, n + 2) == JEST_ERROR_NONE);
+        CHECK(str_equals(&val, expected, n));
+        Jest_destroyJsonVal(&val);
+
+        // the closing quote missing at every length
+        CHECK(Jest_parseJsonFromBuf(&val, src, n + 1) != JEST_ERROR_NONE);
+
+        // an escape at every position of the string
+        for (size_t k = 0; k <= n; k += (n < 40)? 1 : 9) {
+            size_t len = 0;
+            src[len++] = '\'';
+            for (size_t i = 0; i < k; ++i) src[len++] = 'x';
+            src[len++] = '\\';
+            src[len++] = '\'';
+            for (size_t i = k; i < n; ++i) src[len++] = 'y';
+            src[len++] = '\'';
+
+            memset(expected, 'x', k);
+            expected[k] = '\'';
+            memset(&expected[k + 1], 'y', n - k);
+
+            CHECK(Jest_parseJsonFromBuf(&val, src, len) == JEST_ERROR_NONE);
+            CHECK(str_equals(&val, expected, n + 1));
+            Jest_destroyJsonVal(&val);
+        }
+    }
+
+    // escaped backslashes right before the closing quote
+    CHECK_JSON("\"\\\\\"", "\"\\\\\"");
+    CHECK_JSON("\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\\\\"", "\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\\\\"");
+    CHECK_JSON("\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\\\\\\"\"", "\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\\\\\\"\"");
+}
+
+static void container_skips(void)
+{
+    // bytes next to the ones the container scan stops at, bit 5 and all, which it has to pass over
+    static const char filler[] = "Z\\^z|~\x80\xdb\x0c+-.;0 ";
+    char src[192];
+
+    for (size_t n = 0; n < 100; ++n) {
+        size_t len = (size_t)sprintf(src, "{a: [");
+        for (size_t i = 0; i < n; ++i) src[len++] = filler[(i * 5 + n) % (sizeof(filler) - 1)];
+        len += (size_t)sprintf(&src[len], "'],}' /* [ */ {x: [1]}]");
+        const size_t a_end = len;
+        len += (size_t)sprintf(&src[len], ", b: 7}");
+
+        Jest_LazyVal root, a, b;
+        CHECK(Jest_lazyRoot(&root, src, len) == JEST_ERROR_NONE && root.end == len);
+        CHECK(Jest_lazyField(&a, &root, "a") == JEST_ERROR_NONE && a.type == JEST_JSONTYPE_ARR && a.end == a_end);
+        CHECK(Jest_lazyField(&b, &root, "b") == JEST_ERROR_NONE && b.type == JEST_JSONTYPE_NUM);
+
+        // without its closing bracket the array runs on to the end and takes b with it
+        src[a_end - 1] = ' ';
+        CHECK(Jest_lazyRoot(&root, src, len) == JEST_ERROR_NONE);
+        CHECK(Jest_lazyField(&b, &root, "b") != JEST_ERROR_NONE);
+    }
+}
+
+static void json_lines_threads(void)
+{
+    // the kernels are used from several threads at once here
+    size_t len = 0, cap = (size_t)1 << 20;
+    char *buf = (char *)malloc(cap);
+    CHECK(buf != NULL);
+    if (!buf) return;
+
+    while (len + 64 < cap) len += (size_t)snprintf(&buf[len], cap - len, "   {\"k\": \"some \\\"string\\\"\", \"n\": [1,  2]}\n");
+
+    Jest_JsonLines lines;
+    CHECK(Jest_parseJsonLines(&lines, buf, len, 4) == JEST_ERROR_NONE);
+    CHECK(lines.count > 1000);
+
+    bool all_equal = true;
+    for (size_t i = 0; i < lines.count; ++i) {
+        Jest_JsonVal *k = Jest_jsonIdx(&lines.values[i], "[k]", NULL);
+        all_equal = all_equal && k && str_equals(k, "some \"string\"", 13);
+    }
+
+    CHECK(all_equal);
+    Jest_destroyJsonLines(&lines);
+    free(buf);
+}
+
+void test_scan(void)
+{
+    whitespace_runs();
+    string_bodies();
+    container_skips();
+    json_lines_threads();
+}
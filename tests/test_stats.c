@@ -0,0 +1,222 @@
+// parse statistics, counted per thread with what worker threads counted added on, built with JEST_STATS
+#include "test.h"
+
+#ifdef JEST_STATS
+
+static Jest_Stats stats_of(const char *src)
+{
+    Jest_resetStats();
+    Jest_JsonVal val;
+    if (!Jest_parseJsonFromStr(&val, src)) Jest_destroyJsonVal(&val);
+
+    Jest_Stats out;
+    Jest_getStats(&out);
+    return out;
+}
+
+static void counts(void)
+{
+    Jest_Stats s;
+    Jest_resetStats();
+    Jest_getStats(&s);
+    CHECK(s.tokens_punct == 0 && s.tokens_str == 0 && s.allocs == 0 && s.max_depth == 0 && s.parse_time == 0);
+    Jest_getStats(NULL);
+
+    // every lexeme of the input exactly once, keys included
+    s = stats_of("{\"a\": [1, \"x\\n\", true, null, 2.5, NaN], b: 'plain', c: {d: false, e: [[]]}}");
+    CHECK(s.tokens_punct == 23);
+    CHECK(s.tokens_str == 3 && s.strings_clean == 2 && s.strings_escaped == 1);
+    CHECK(s.tokens_ident == 4);
+    CHECK(s.tokens_num == 3 && s.tokens_bool == 2 && s.tokens_null == 1);
+    CHECK(s.max_depth == 4);
+    CHECK(s.allocs > 0 && s.alloc_bytes > 0 && s.parse_time > 0);
+
+    // counts add up until they're reset
+    Jest_JsonVal val;
+    CHECK(Jest_parseJsonFromStr(&val, "[1, 2]") == JEST_ERROR_NONE);
+    Jest_destroyJsonVal(&val);
+    Jest_Stats more;
+    Jest_getStats(&more);
+    CHECK(more.tokens_num == s.tokens_num + 2 && more.tokens_punct == s.tokens_punct + 3 && more.max_depth == 4);
+
+    // arrays and objects grow geometrically, not once per element
+    char src[8192];
+    size_t n = 0;
+    src[n++] = '[';
+    for (int i = 0; i < 1000; ++i) n += (size_t)sprintf(&src[n], "%d,", i % 10);
+    src[n++] = ']';
+    src[n] = '\0';
+
+    s = stats_of(src);
+    CHECK(s.tokens_num == 1000 && s.array_grows > 0 && s.array_grows < 20 && s.obj_grows == 0);
+
+    // writing is timed and nothing else is counted for it
+    CHECK(Jest_parseJsonFromStr(&val, src) == JEST_ERROR_NONE);
+    Jest_resetStats();
+    char *out = test_write(&val);
+    Jest_getStats(&s);
+    CHECK(out && s.tokens_num == 0 && s.write_time >= 0);
+    free(out);
+    Jest_destroyJsonVal(&val);
+}
+
+static void threads(void)
+{
+    // what worker threads counted ends up on the calling thread, the same as parsing on one thread
+    const size_t nlines = 40000;
+    char *src = (char *)malloc(nlines * 48);
+    CHECK(src != NULL);
+    if (!src) return;
+
+    size_t n = 0;
+    for (size_t i = 0; i < nlines; ++i) n += (size_t)sprintf(&src[n], "{\"i\": %zu, s: \"a\\tb\", t: [true, null]}\n", i);
+
+    Jest_Stats serial, parallel;
+    Jest_JsonLines lines;
+
+    Jest_resetStats();
+    CHECK(Jest_parseJsonLines(&lines, src, n, 1) == JEST_ERROR_NONE);
+    Jest_getStats(&serial);
+    Jest_destroyJsonLines(&lines);
+
+    Jest_resetStats();
+    CHECK(Jest_parseJsonLines(&lines, src, n, 4) == JEST_ERROR_NONE);
+    Jest_getStats(&parallel);
+    Jest_destroyJsonLines(&lines);
+
+    CHECK(serial.tokens_num == nlines && serial.strings_escaped == nlines && serial.max_depth == 2);
+    CHECK(parallel.tokens_punct == serial.tokens_punct && parallel.tokens_str == serial.tokens_str);
+    CHECK(parallel.tokens_num == serial.tokens_num && parallel.tokens_ident == serial.tokens_ident);
+    CHECK(parallel.tokens_bool == serial.tokens_bool && parallel.tokens_null == serial.tokens_null);
+    CHECK(parallel.strings_clean == serial.strings_clean && parallel.strings_escaped == serial.strings_escaped);
+    CHECK(parallel.max_depth == serial.max_depth);
+
+    free(src);
+}
+
+static void check_timed(const char *file, int line, const char *what)
+{
+    Jest_Stats s;
+    Jest_getStats(&s);
+    test_check(file, line, s.parse_time > 0 && s.parse_time < 60, what);
+    Jest_resetStats();
+}
+
+#define CHECK_TIMED(what) check_timed(__FILE__, __LINE__, (what))
+
+static bool count_line(void *userdata, size_t idx, const Jest_JsonVal *val, Jest_Error err)
+{
+    (void)idx;
+    (void)val;
+    (void)err;
+    ++*(size_t *)userdata;
+    return true;
+}
+
+static void times(void)
+{
+    // every way of parsing is timed, on the worker threads as well
+    const size_t nrecords = 8000;
+    char *arr = (char *)malloc(nrecords * 48 + 2), *lines = (char *)malloc(nrecords * 48);
+    CHECK(arr != NULL && lines != NULL);
+    if (!arr || !lines) {
+        free(arr);
+        free(lines);
+        return;
+    }
+
+    size_t arr_len = 0, lines_len = 0;
+    arr[arr_len++] = '[';
+    for (size_t i = 0; i < nrecords; ++i) {
+        const int n = sprintf(&lines[lines_len], "{\"i\": %zu, s: \"a\\tb\", t: [true, null]}\n", i);
+        memcpy(&arr[arr_len], &lines[lines_len], (size_t)n - 1);
+        arr_len += (size_t)n - 1;
+        arr[arr_len++] = (i + 1 < nrecords)? ',' : ']';
+        lines_len += (size_t)n;
+    }
+
+    Jest_resetStats();
+    Jest_JsonVal val;
+    CHECK(Jest_parseJsonFromBuf(&val, arr, arr_len) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_parseJsonFromBuf");
+    Jest_destroyJsonVal(&val);
+
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+    CHECK(Jest_parseDocumentFromBuf(&doc, arr, arr_len) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_parseDocumentFromBuf");
+    Jest_destroyDocument(&doc);
+
+    CHECK(Jest_parseDocumentParallel(&doc, arr, arr_len, 4) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_parseDocumentParallel");
+    Jest_destroyDocument(&doc);
+
+    Jest_JsonLines records;
+    CHECK(Jest_parseJsonLines(&records, lines, lines_len, 4) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_parseJsonLines");
+    Jest_destroyJsonLines(&records);
+
+    size_t nlines = 0;
+    CHECK(Jest_parseJsonLinesCallback(lines, lines_len, 4, count_line, &nlines) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_parseJsonLinesCallback");
+    CHECK(nlines == nrecords);
+
+    Jest_Lexer l;
+    TestEvents ev;
+    test_events_init(&ev, 0);
+    CHECK(Jest_initLexer(&l, NULL, 0, arr, arr_len));
+    Jest_resetStats();
+    CHECK(Jest_parseSaxLexer(&l, &test_events_handler, &ev) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_parseSaxLexer");
+    Jest_destroyLexer(&l);
+    test_events_destroy(&ev);
+
+    Jest_Tape tape;
+    CHECK(Jest_initLexer(&l, NULL, 0, arr, arr_len));
+    Jest_resetStats();
+    CHECK(Jest_parseTapeLexer(&tape, &l) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_parseTapeLexer");
+    Jest_destroyLexer(&l);
+    Jest_destroyTape(&tape);
+
+    Jest_ChunkParser chunks;
+    CHECK(Jest_initChunkParserJson(&chunks, &val) == JEST_ERROR_NONE);
+    for (size_t off = 0; off < arr_len; off += 4096) {
+        CHECK(Jest_chunkParserFeed(&chunks, &arr[off], (arr_len - off < 4096)? arr_len - off : 4096) == JEST_ERROR_NONE);
+    }
+    CHECK(Jest_chunkParserFinish(&chunks) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_chunkParserFeed");
+    Jest_destroyChunkParser(&chunks);
+    Jest_destroyJsonVal(&val);
+
+    char accessor[32];
+    sprintf(accessor, "[%zu][s]", nrecords - 1);
+    const char *const accessors[] = {accessor};
+    Jest_PathSet set;
+    CHECK(Jest_compilePathSet(&set, accessors, 1) == JEST_ERROR_NONE);
+    CHECK(Jest_initLexer(&l, NULL, 0, arr, arr_len));
+    Jest_resetStats();
+    CHECK(Jest_pathSetExtract(&set, &l, &val) == JEST_ERROR_NONE);
+    CHECK_TIMED("Jest_pathSetExtract");
+    Jest_destroyJsonVal(&val);
+    Jest_destroyLexer(&l);
+    Jest_destroyPathSet(&set);
+
+    free(arr);
+    free(lines);
+}
+
+void test_stats(void)
+{
+    counts();
+    threads();
+    times();
+}
+
+#else
+
+void test_stats(void)
+{
+}
+
+#endif // JEST_STATS
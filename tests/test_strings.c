@@ -0,0 +1,218 @@
+// zero-copy string views into the source and where decoded strings end up
+#include "test.h"
+
+static bool points_into(const char *p, const char *buf, size_t len)
+{
+    return p >= buf && p < buf + len;
+}
+
+static void lexer_views(void)
+{
+    const char src[] = "\"plain\" \"esc\\taped\" ''";
+    Jest_Lexer l;
+    // the first token is lexed right away, strings without escapes are used straight from the input
+    CHECK(Jest_initLexer(&l, NULL, 0, src, sizeof(src) - 1) && l.type == JEST_LEXEME_STR);
+    CHECK(l.strval == &src[1]);
+    CHECK(l.strval_len == 5);
+
+    // escaped ones are decoded into the string buffer
+    CHECK(Jest_lexerStep(&l) && l.type == JEST_LEXEME_STR);
+    CHECK(!points_into(l.strval, src, sizeof(src)));
+    CHECK(l.strval == l.strbuf);
+    CHECK(l.strval_len == 8 && !memcmp(l.strval, "esc\taped", 8));
+
+    CHECK(Jest_lexerStep(&l) && l.type == JEST_LEXEME_STR);
+    CHECK(l.strval_len == 0);
+
+    CHECK(!Jest_lexerStep(&l) && l.type == JEST_LEXEME_EOF);
+    Jest_destroyLexer(&l);
+}
+
+static void document_views(void)
+{
+    // no nul after the last string, so reading past the stored lengths would show
+    char src[] = "{\"name\": \"value\", \"esc\\u0041\": \"a\\nb\", list: [\"x\", \"yz\"]}";
+    const size_t len = sizeof(src) - 1;
+
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+    doc.flags = JEST_DOC_ZEROCOPY;
+    CHECK(Jest_parseDocumentFromBuf(&doc, src, len) == JEST_ERROR_NONE);
+
+    const Jest_JsonVal *root = &doc.root;
+    CHECK(root->type == JEST_JSONTYPE_OBJ && root->v.as_obj.nfields == 3);
+
+    // field names and values without escapes are views
+    CHECK(root->v.as_obj.field_names[0] == &src[2]);
+    CHECK(root->v.as_obj.fn_lens[0] == 4);
+    CHECK(root->v.as_obj.field_values[0].v.as_str.data == &src[10]);
+    CHECK(root->v.as_obj.field_values[0].v.as_str.len == 5);
+
+    // escaped ones are copies
+    CHECK(!points_into(root->v.as_obj.field_names[1], src, len));
+    CHECK(root->v.as_obj.fn_lens[1] == 4 && !memcmp(root->v.as_obj.field_names[1], "escA", 4));
+    const Jest_JsonVal *esc = &root->v.as_obj.field_values[1];
+    CHECK(!points_into(esc->v.as_str.data, src, len));
+    CHECK(esc->v.as_str.len == 3 && !memcmp(esc->v.as_str.data, "a\nb", 3));
+
+    // unquoted keys are views as well
+    CHECK(points_into(root->v.as_obj.field_names[2], src, len));
+    CHECK(root->v.as_obj.fn_lens[2] == 4 && !memcmp(root->v.as_obj.field_names[2], "list", 4));
+
+    const Jest_JsonVal *list = &root->v.as_obj.field_values[2];
+    CHECK(list->v.as_arr.len == 2);
+    CHECK(points_into(list->v.as_arr.elems[1].v.as_str.data, src, len));
+    CHECK(list->v.as_arr.elems[1].v.as_str.len == 2);
+
+    // lookups go by the stored lengths too
+    Jest_JsonVal *found = Jest_jsonIdx(&doc.root, "[name]", NULL);
+    CHECK(found && found->v.as_str.len == 5 && !memcmp(found->v.as_str.data, "value", 5));
+
+    Jest_destroyDocument(&doc);
+
+    // without the flag everything is copied into the arena
+    Jest_initDocument(&doc);
+    CHECK(Jest_parseDocumentFromBuf(&doc, src, len) == JEST_ERROR_NONE);
+    CHECK(!points_into(doc.root.v.as_obj.field_names[0], src, len));
+    CHECK(!points_into(doc.root.v.as_obj.field_values[0].v.as_str.data, src, len));
+    Jest_destroyDocument(&doc);
+}
+
+static void document_file_source(void)
+{
+    FILE *file = tmpfile();
+    CHECK(file != NULL);
+    if (!file) return;
+
+    fputs("[\"kept\", \"alive\"]", file);
+    rewind(file);
+
+    // the document holds on to what it read so the views stay valid after the file is gone
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+    doc.flags = JEST_DOC_ZEROCOPY;
+    CHECK(Jest_parseDocumentFile(&doc, file) == JEST_ERROR_NONE);
+    fclose(file);
+
+    CHECK(doc.source != NULL);
+    CHECK(doc.root.v.as_arr.len == 2);
+    CHECK(points_into(doc.root.v.as_arr.elems[0].v.as_str.data, doc.source, 17));
+
+    char *out = test_write(&doc.root);
+    CHECK_STR(out, "[\"kept\",\"alive\"]");
+    free(out);
+
+    Jest_destroyDocument(&doc);
+}
+
+static void unterminated(void)
+{
+    CHECK_JSON("\"abc", NULL);
+    CHECK_JSON("[\"abc", NULL);
+    CHECK_JSON("{\"abc", NULL);
+    CHECK_JSON("\"abc\\", NULL);
+    CHECK_JSON("\"abc\\\"", NULL);
+    CHECK_JSON("'abc\"", NULL);
+
+    // the same input cut short right before the closing quote has to fail in every mode
+    const char src[] = "[\"abc\"]";
+    Jest_Document doc;
+    Jest_initDocument(&doc);
+    doc.flags = JEST_DOC_ZEROCOPY;
+    CHECK(Jest_parseDocumentFromBuf(&doc, src, 5) == JEST_ERROR_SYNTAX);
+    Jest_destroyDocument(&doc);
+
+    Jest_JsonVal val;
+    CHECK(Jest_parseJsonFromBuf(&val, src, 5) == JEST_ERROR_SYNTAX);
+    CHECK(Jest_parseJsonFromBuf(&val, src, 7) == JEST_ERROR_NONE);
+    Jest_destroyJsonVal(&val);
+}
+
+// a string of n escapes each decoding to a different character, as json and as the expected result
+static void make_escaped(char *src, char *expected, size_t n)
+{
+    static const char *const escapes[] = {"\\n", "\\u0041", "\\\"", "b", "\\ud83d\\ude00", "\\x7e", "\\u00e9"};
+    static const char *const decoded[] = {"\n", "A", "\"", "b", "\xf0\x9f\x98\x80", "~", "\xc3\xa9"};
+
+    *src++ = '"';
+    for (size_t i = 0; i < n; ++i) {
+        const size_t k = (i * 5 + i / 3) % 7;
+        src += strlen(strcpy(src, escapes[k]));
+        expected += strlen(strcpy(expected, decoded[k]));
+    }
+
+    strcpy(src, "\"");
+}
+
+static void strbuf_growth(void)
+{
+    // sizes on both sides of where the buffer starts out and doubles
+    static const size_t counts[] = {1, 100, 255, 256, 257, 511, 1023, 1024, 1025, 4096, 100000};
+    char *src = (char *)malloc(100000 * 12 + 3);
+    char *expected = (char *)malloc(100000 * 4 + 1);
+    CHECK(src && expected);
+    if (!src || !expected) {
+        free(src);
+        free(expected);
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(*counts); ++i) {
+        make_escaped(src, expected, counts[i]);
+        const size_t expected_len = strlen(expected);
+
+        Jest_JsonVal val;
+        CHECK(Jest_parseJsonFromStr(&val, src) == JEST_ERROR_NONE);
+        CHECK(val.type == JEST_JSONTYPE_STR && val.v.as_str.len == expected_len);
+        CHECK(!memcmp(val.v.as_str.data, expected, expected_len));
+        Jest_destroyJsonVal(&val);
+
+        // a buffer handed in by the caller is used as long as strings fit and left alone once they don't
+        char small[64];
+        memset(small, '#', sizeof(small));
+        Jest_Lexer l;
+        CHECK(Jest_initLexer(&l, small, sizeof(small), src, strlen(src)) && l.type == JEST_LEXEME_STR);
+        CHECK(l.strval_len == expected_len && !memcmp(l.strval, expected, expected_len));
+        CHECK(l.strbuf_owned == (expected_len > sizeof(small)));
+        CHECK(l.strbuf_owned || l.strbuf == small);
+        if (l.strbuf_owned) CHECK(l.strbuf != small && l.strbuf_sz >= expected_len && small[sizeof(small) - 1] == '#');
+        Jest_destroyLexer(&l);
+        CHECK(!l.strbuf && !l.strbuf_owned);
+    }
+
+    // the grown buffer is kept for the strings after it, short or long, keys or values
+    make_escaped(src, expected, 3000);
+    const size_t long_len = strlen(src);
+    memmove(&src[1], src, long_len + 1);
+    src[0] = '{';
+    strcpy(&src[long_len + 1], ": ['\\t', ");
+    make_escaped(&src[strlen(src)], expected, 5000);
+    strcat(src, "]}");
+
+    Jest_JsonVal val;
+    CHECK(Jest_parseJsonFromStr(&val, src) == JEST_ERROR_NONE);
+    CHECK(val.type == JEST_JSONTYPE_OBJ && val.v.as_obj.nfields == 1);
+
+    if (val.type == JEST_JSONTYPE_OBJ && val.v.as_obj.nfields == 1) {
+        const Jest_JsonVal *arr = &val.v.as_obj.field_values[0];
+        CHECK(arr->v.as_arr.len == 2 && arr->v.as_arr.elems[0].v.as_str.len == 1);
+        CHECK(arr->v.as_arr.elems[1].v.as_str.len == strlen(expected));
+        CHECK(!memcmp(arr->v.as_arr.elems[1].v.as_str.data, expected, strlen(expected)));
+
+        make_escaped(src, expected, 3000);
+        CHECK_STR(val.v.as_obj.field_names[0], expected);
+        Jest_destroyJsonVal(&val);
+    }
+
+    free(src);
+    free(expected);
+}
+
+void test_strings(void)
+{
+    lexer_views();
+    document_views();
+    document_file_source();
+    unterminated();
+    strbuf_growth();
+}
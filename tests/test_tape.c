@@ -0,0 +1,154 @@
+// tapes, built from the lexer and from trees, and turned back into trees
+#include "test.h"
+
+static const char *const documents[] = {
+    "{\"a\": [1, 2.5, -0, \"s\\u00e9\"], \"b\": {\"c\": null, \"d\": [true, false, [], {}]}, \"\": 'empty key'}",
+    "[[[[1]], [[2, [3]]]], {a: {b: {c: {}}}}, 1e300, -Infinity, \"\"]",
+    "{a: 1, b: 2, a: {x: 3}, b: [4]}",
+    "\"just a string\"",
+    "-12.5",
+    "null",
+    "[]",
+    "{}"
+};
+
+static Jest_Error tape_from_str(Jest_Tape *tape, const char *src, size_t max_depth)
+{
+    Jest_Lexer l;
+    if (!Jest_initLexer(&l, NULL, 0, src, strlen(src))) {
+        Jest_destroyLexer(&l);
+        return JEST_ERROR_BADLEXER;
+    }
+
+    l.max_depth = max_depth;
+    const Jest_Error err = Jest_parseTapeLexer(tape, &l);
+    Jest_destroyLexer(&l);
+    return err;
+}
+
+// what tape holds at pos written out as compact json
+static char *tape_write(const Jest_Tape *tape, size_t pos)
+{
+    Jest_JsonVal val;
+    if (Jest_tapeToJsonVal(&val, tape, pos)) return NULL;
+
+    char *out = test_write(&val);
+    Jest_destroyJsonVal(&val);
+    return out;
+}
+
+static void round_trips(void)
+{
+    for (size_t d = 0; d < sizeof(documents) / sizeof(*documents); ++d) {
+        Jest_JsonVal tree;
+        CHECK(Jest_parseJsonFromStr(&tree, documents[d]) == JEST_ERROR_NONE);
+        char *expected = test_write(&tree);
+
+        // from the lexer and from the tree, both back to the same tree
+        Jest_Tape lexed, built;
+        CHECK(tape_from_str(&lexed, documents[d], 0) == JEST_ERROR_NONE);
+        CHECK(Jest_tapeFromJsonVal(&built, &tree) == JEST_ERROR_NONE);
+
+        char *from_lexed = tape_write(&lexed, 0);
+        char *from_built = tape_write(&built, 0);
+        CHECK_STR(from_lexed, expected);
+        CHECK_STR(from_built, expected);
+
+        // the whole value takes up the whole tape
+        CHECK(Jest_tapeSkip(&lexed, 0) == lexed.len);
+        CHECK(Jest_tapeSkip(&built, 0) == built.len);
+        CHECK(Jest_tapeType(&lexed, 0) == tree.type);
+
+        free(expected);
+        free(from_lexed);
+        free(from_built);
+        Jest_destroyTape(&lexed);
+        Jest_destroyTape(&built);
+        Jest_destroyJsonVal(&tree);
+    }
+}
+
+static void access(void)
+{
+    Jest_Tape tape;
+    CHECK(tape_from_str(&tape, "{a: [10, {b: 'x'}, [], 30], c: 'y', a2: {}, c: 'z'}", 0) == JEST_ERROR_NONE);
+
+    // duplicate keys stay on the tape and the last one wins
+    CHECK(Jest_tapeCount(&tape, 0) == 4);
+    const size_t c = Jest_tapeField(&tape, 0, "c");
+    size_t len = 0;
+    CHECK(c != (size_t)-1 && Jest_tapeType(&tape, c) == JEST_JSONTYPE_STR);
+    CHECK(!strcmp(Jest_tapeStr(&tape, c, &len), "z") && len == 1);
+    CHECK(Jest_tapeField(&tape, 0, "missing") == (size_t)-1);
+
+    // values in the middle of the tape convert on their own
+    const size_t a = Jest_tapeField(&tape, 0, "a");
+    CHECK(Jest_tapeCount(&tape, a) == 4);
+    char *out = tape_write(&tape, a);
+    CHECK_STR(out, "[10,{\"b\":\"x\"},[],30]");
+    free(out);
+
+    Jest_TapeIter it;
+    double sum = 0;
+    size_t n = 0;
+    for (bool more = Jest_tapeIterBegin(&it, &tape, a); more; more = Jest_tapeIterNext(&it), ++n) {
+        if (Jest_tapeType(&tape, it.pos) == JEST_JSONTYPE_NUM) sum += Jest_tapeNum(&tape, it.pos);
+    }
+    CHECK(n == 4 && sum == 40);
+
+    const size_t a2 = Jest_tapeField(&tape, 0, "a2");
+    CHECK(!Jest_tapeIterBegin(&it, &tape, a2));
+    out = tape_write(&tape, a2);
+    CHECK_STR(out, "{}");
+    free(out);
+
+    Jest_JsonVal val;
+    CHECK(Jest_tapeToJsonVal(&val, &tape, tape.len) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_tapeToJsonVal(&val, &tape, Jest_tapeSkip(&tape, 0) - 1) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_tapeToJsonVal(NULL, &tape, 0) == JEST_ERROR_BADPARAM);
+    Jest_destroyTape(&tape);
+
+    // broken input leaves no tape behind
+    CHECK(tape_from_str(&tape, "[1, {a: }]", 0) != JEST_ERROR_NONE);
+    CHECK(!tape.entries && !tape.strs);
+}
+
+static void deep(void)
+{
+    // converting either way walks an explicit stack, so depth is only limited by memory
+    const size_t depth = 2000000;
+    char *src = (char *)malloc(2 * depth + 2);
+    CHECK(src != NULL);
+    if (!src) return;
+
+    memset(src, '[', depth);
+    src[depth] = '7';
+    memset(&src[depth + 1], ']', depth);
+    src[2 * depth + 1] = '\0';
+
+    Jest_Tape tape, again;
+    CHECK(tape_from_str(&tape, src, 2 * depth) == JEST_ERROR_NONE);
+
+    Jest_JsonVal val;
+    CHECK(Jest_tapeToJsonVal(&val, &tape, 0) == JEST_ERROR_NONE);
+
+    size_t levels = 0;
+    const Jest_JsonVal *v = &val;
+    for (; v->type == JEST_JSONTYPE_ARR && v->v.as_arr.len == 1; v = &v->v.as_arr.elems[0]) ++levels;
+    CHECK(levels == depth && v->type == JEST_JSONTYPE_NUM && v->v.as_num == 7);
+
+    CHECK(Jest_tapeFromJsonVal(&again, &val) == JEST_ERROR_NONE);
+    CHECK(again.len == tape.len && !memcmp(again.entries, tape.entries, sizeof(*tape.entries) * tape.len));
+
+    Jest_destroyTape(&again);
+    Jest_destroyTape(&tape);
+    Jest_destroyJsonVal(&val);
+    free(src);
+}
+
+void test_tape(void)
+{
+    round_trips();
+    access();
+    deep();
+}
@@ -0,0 +1,157 @@
+// compact and pretty output of the buffered writer, and the chunks it hands to callbacks
+#include "test.h"
+
+static const char sample[] = "{\"a\": [1, {}, [], \"x\\u00e9\\n\\u0001\\\"\"], b: {c: null, d: true}, \"\": -2.5e-7}";
+
+static char *write_sample(unsigned flags, size_t *len)
+{
+    Jest_JsonVal val;
+    if (Jest_parseJsonFromStr(&val, sample)) return NULL;
+
+    char *out = NULL;
+    if (Jest_writeJsonToBuffer(&out, len, &val, flags)) out = NULL;
+
+    Jest_destroyJsonVal(&val);
+    return out;
+}
+
+static void compact(void)
+{
+    size_t len = 0;
+    char *out = write_sample(0, &len);
+    CHECK_STR(out, "{\"a\":[1,{},[],\"x\xc3\xa9\\n\\u0001\\\"\"],\"b\":{\"c\":null,\"d\":true},\"\":-2.5e-7}");
+    CHECK(out && len == strlen(out));
+    free(out);
+
+    out = write_sample(JEST_WRITE_ESCAPE_UNICODE, &len);
+    CHECK_STR(out, "{\"a\":[1,{},[],\"x\\u00e9\\n\\u0001\\\"\"],\"b\":{\"c\":null,\"d\":true},\"\":-2.5e-7}");
+    free(out);
+
+    // the escapes are the ones Jest_printJsonVal has always written
+    CHECK_JSON("\"\\b\\f\\t\\r\\v\\u001f\\u007f/'\"", "\"\\b\\f\\t\\r\\v\\u001f\\u007f\\/\\'\"");
+    CHECK_JSON("[[[[]]], {a: {b: {}}}]", "[[[[]]],{\"a\":{\"b\":{}}}]");
+    CHECK_JSON("'single \"quoted\"'", "\"single \\\"quoted\\\"\"");
+
+    // characters outside the basic plane become surrogate pairs when escaped
+    Jest_JsonVal val = Jest_jsonString("\xf0\x9f\x98\x80 \xe2\x82\xac");
+    char *escaped = NULL;
+    CHECK(Jest_writeJsonToBuffer(&escaped, NULL, &val, JEST_WRITE_ESCAPE_UNICODE) == JEST_ERROR_NONE);
+    CHECK_STR(escaped, "\"\\ud83d\\ude00 \\u20ac\"");
+    free(escaped);
+    Jest_destroyJsonVal(&val);
+
+    // scalars on their own
+    val = Jest_jsonNumber(3);
+    char *num = test_write(&val);
+    CHECK_STR(num, "3");
+    free(num);
+
+    CHECK(Jest_writeJsonToBuffer(NULL, NULL, &val, 0) == JEST_ERROR_BADPARAM);
+    CHECK(Jest_writeJsonToBuffer(&num, NULL, NULL, 0) == JEST_ERROR_BADPARAM);
+}
+
+static void pretty(void)
+{
+    size_t len = 0;
+    char *out = write_sample(JEST_WRITE_PRETTY, &len);
+    CHECK_STR(out,
+        "{\n"
+        "\t\"a\": [\n"
+        "\t\t1,\n"
+        "\t\t{\n"
+        "\t\t},\n"
+        "\t\t[\n"
+        "\t\t],\n"
+        "\t\t\"x\xc3\xa9\\n\\u0001\\\"\"\n"
+        "\t],\n"
+        "\t\"b\": {\n"
+        "\t\t\"c\": null,\n"
+        "\t\t\"d\": true\n"
+        "\t},\n"
+        "\t\"\": -2.5e-7\n"
+        "}"
+    );
+
+    // Jest_printJsonVal writes the very same
+    FILE *file = tmpfile();
+    CHECK(file != NULL);
+    if (out && file) {
+        Jest_JsonVal val;
+        CHECK(Jest_parseJsonFromStr(&val, sample) == JEST_ERROR_NONE);
+        Jest_printJsonVal(file, &val, false);
+        Jest_destroyJsonVal(&val);
+
+        char *printed = NULL;
+        rewind(file);
+        const size_t printed_len = Jest_readEntireFile(&printed, file);
+        CHECK(printed_len == len && printed && !memcmp(printed, out, len));
+        free(printed);
+    }
+
+    if (file) fclose(file);
+    free(out);
+}
+
+typedef struct Chunks {
+    char *data;
+    size_t len;
+    size_t ncalls, max_chunk;
+    size_t stop_after; // calls before returning false, 0 for never
+} Chunks;
+
+static bool collect(void *userdata, const char *data, size_t len)
+{
+    Chunks *c = (Chunks *)userdata;
+    ++c->ncalls;
+    if (len > c->max_chunk) c->max_chunk = len;
+
+    char *grown = (char *)realloc(c->data, c->len + len);
+    if (!grown) return false;
+
+    memcpy(&grown[c->len], data, len);
+    c->data = grown;
+    c->len += len;
+
+    return !c->stop_after || c->ncalls < c->stop_after;
+}
+
+static void callbacks(void)
+{
+    // enough output for a good number of chunks
+    Jest_JsonVal arr = Jest_jsonArray();
+    char name[32];
+    for (int i = 0; i < 5000; ++i) {
+        snprintf(name, sizeof(name), "element \"%d\"", i);
+        Jest_JsonVal str = Jest_jsonString(name);
+        Jest_jsonArrayAppend(&arr, &str);
+    }
+
+    for (unsigned flags = 0; flags <= JEST_WRITE_PRETTY; ++flags) {
+        char *expected = NULL;
+        size_t expected_len = 0;
+        CHECK(Jest_writeJsonToBuffer(&expected, &expected_len, &arr, flags) == JEST_ERROR_NONE);
+
+        Chunks c = {NULL, 0, 0, 0, 0};
+        CHECK(Jest_writeJsonToCallback(collect, &c, &arr, flags) == JEST_ERROR_NONE);
+        CHECK(c.len == expected_len && expected && c.data && !memcmp(c.data, expected, c.len));
+        CHECK(c.ncalls > 1 && c.max_chunk <= JEST_WRITE_CHUNK_SIZE);
+
+        free(c.data);
+        free(expected);
+    }
+
+    // returning false stops the writer right there
+    Chunks c = {NULL, 0, 0, 0, 2};
+    CHECK(Jest_writeJsonToCallback(collect, &c, &arr, 0) == JEST_ERROR_IO);
+    CHECK(c.ncalls == 2);
+    free(c.data);
+
+    Jest_destroyJsonVal(&arr);
+}
+
+void test_writer(void)
+{
+    compact();
+    pretty();
+    callbacks();
+}